@@ -1,10 +1,14 @@
 #include <cstdio>
 #include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <thread>
 
 #include <core/SURPASSenvironment.hh>
 #include <core/data/basic/Vec3.hh>
 #include <core/data/io/ss2_io.hh>
 #include <core/data/io/Pdb.hh>
+#include <core/data/io/DataTable.hh>
 #include <core/data/sequence/SecondaryStructure.hh>
 #include <core/data/structural/Structure.hh>
 
@@ -12,9 +16,8 @@
 #include <simulations/evaluators/cartesian/CM.hh>
 #include <simulations/evaluators/cartesian/RgSquare.hh>
 #include <simulations/evaluators/cartesian/CrmsdEvaluator.hh>
+#include <simulations/evaluators/cartesian/TMScoreEvaluator.hh>
 #include <simulations/forcefields/surpass/surpass_force_field_factory.hh>
-#include <simulations/movers/PerturbResidue.hh>
-#include <simulations/movers/PerturbChainFragment.hh>
 #include <simulations/evaluators/Timer.hh>
 #include <simulations/evaluators/Evaluator.hh>
 #include <simulations/evaluators/EchoEvaluator.hh>
@@ -30,19 +33,39 @@
 #include <simulations/observers/ObserveMoversAcceptance.hh>
 #include <simulations/observers/TriggerLowEnergy.hh>
 #include <simulations/representations/surpass_utils.hh>
+#include <simulations/representations/SurpassInputCache.hh>
 
+#include <utils/io_utils.hh>
 #include <utils/string_utils.hh>
+#include <utils/PerfCounters.hh>
 #include <utils/LogManager.hh>
 #include <utils/options/Option.hh>
 #include <utils/options/OptionParser.hh>
 #include <utils/options/output_options.hh>
 #include <utils/options/input_options.hh>
 #include <utils/options/sampling_options.hh>
+#include <utils/options/scoring_options.hh>
 #include <utils/options/sampling_from_cmdline.hh>
 #include <simulations/forcefields/ForceFieldConfig.hh>
 #include <simulations/observers/ObserveReplicaFlow.hh>
+#include <simulations/observers/ObserveReservoir.hh>
 #include <simulations/observers/surpass/ObserveTopologyMatrix.hh>
+#include <simulations/observers/surpass/ObserveLowEnergyArchive.hh>
 #include <simulations/observers/cartesian/EndVectorObserver.hh>
+#include <simulations/evaluators/cv/RgCV.hh>
+#include <simulations/evaluators/cv/CrmsdCV.hh>
+#include <simulations/evaluators/cv/HBondCountCV.hh>
+#include <simulations/evaluators/cv/NativeContactsCV.hh>
+#include <simulations/forcefields/MetadynamicsBias.hh>
+#include <simulations/observers/ObserveMetadynamics.hh>
+#include <simulations/observers/TriggerEveryN.hh>
+#include <simulations/forcefields/CVBiasEnergy.hh>
+#include <simulations/sampling/UmbrellaSampling.hh>
+#include <simulations/sampling/AnnealingPortfolio.hh>
+#include <simulations/sampling/LockstepReplicaMC.hh>
+#include <simulations/sampling/SurpassChainGrowth.hh>
+#include <simulations/sampling/NestedSampling.hh>
+#include <simulations/api/SurpassSimulation.hh>
 
 std::string pymol_style = R"(STYL  show spheres
 show lines
@@ -54,44 +77,123 @@ utils::Logger logs("surpass");
 
 using core::data::basic::Vec3;
 
+/** @brief Creates movers for a system with the move ranges requested from the command line.
+ *
+ * The movers are set up by SurpassSimulation::create_movers(), as in annealing and REMC runs
+ * @param which_replica - index of the replica; replica \f$ i \f$ uses the \f$ i \f$-th of the given ranges (cyclically)
+ */
 simulations::movers::MoversSet_SP create_movers(simulations::systems::ResidueChain<Vec3> &rc,
         std::shared_ptr<simulations::forcefields::TotalEnergyByResidue> en, core::index2 which_replica) {
 
   using namespace utils::options;
-  using namespace simulations::movers;
-  using namespace simulations::systems::surpass;
-
-  MoversSet_SP moves = std::make_shared<MoversSet>();
 
   std::vector<core::real> move_ranges;
   if (random_jump_range.was_used()) option_value<core::real>(random_jump_range, move_ranges);
   else move_ranges.push_back(0.5);
 
-  std::shared_ptr<PerturbResidue<Vec3>> perturb = std::make_shared<PerturbResidue<Vec3>>(rc, *en);
-  perturb->max_move_range(move_ranges[which_replica % move_ranges.size()]);
-  moves->add_mover(perturb, rc.n_atoms);
+  std::vector<core::real> fragment_ranges;
+  core::index2 fragment_length = 0;
+  if (random_n_jump_len.was_used()) {
+    fragment_length = option_value<core::index2>(random_n_jump_len);
+    if (random_n_jump_range.was_used()) option_value<core::real>(random_n_jump_range, fragment_ranges);
+  }
+  if (fragment_ranges.empty()) fragment_ranges.push_back(0.5);
+
+  return simulations::api::SurpassSimulation::create_movers(rc, *en, move_ranges[which_replica % move_ranges.size()],
+    fragment_length, fragment_ranges[which_replica % fragment_ranges.size()]);
+}
+
+/// Sets the ranges of moves of a simulation as requested from the command line
+void moves_from_cmdline(simulations::api::SurpassSimulation &simulation) {
+
+  using namespace utils::options;
+
+  std::vector<core::real> move_ranges;
+  if (random_jump_range.was_used()) option_value<core::real>(random_jump_range, move_ranges);
+  else move_ranges.push_back(0.5);
+  simulation.move_ranges(move_ranges);
 
-  move_ranges.clear();
   if (random_n_jump_len.was_used()) {
-    core::index2 n = option_value<core::index2>(random_n_jump_len);
+    move_ranges.clear();
     if (random_n_jump_range.was_used()) option_value<core::real>(random_n_jump_range, move_ranges);
-    else move_ranges.push_back(0.5);
-    std::shared_ptr<PerturbChainFragment<Vec3>> perturb_n = std::make_shared<PerturbChainFragment<Vec3>>(rc, n, *en);
-    perturb_n->max_move_range(move_ranges[which_replica % move_ranges.size()]);
-    moves->add_mover(perturb_n, rc.n_atoms / n);
+    simulation.fragment_moves(option_value<core::index2>(random_n_jump_len), move_ranges);
   }
+}
+
+/// Defines a surrogate energy for delayed-acceptance MC as requested from the command line
+void surrogate_from_cmdline(simulations::forcefields::TotalEnergyByResidue &en) {
+
+  using namespace utils::options;
 
-  return moves;
+  if (!surrogate_terms.was_used()) return;
+  std::vector<std::string> names;
+  en.surrogate(option_value<std::string>(surrogate_terms, names));
+}
+
+/// Turns on adaptation of the mover mix if requested from the command line
+void adaptive_movers_from_cmdline(simulations::movers::MoversSet &movers) {
+
+  using namespace utils::options;
+
+  if (adaptive_movers.was_used()) movers.adaptive_mix(option_value<core::index4>(adaptive_movers));
+}
+
+/// Reports how many full energy evaluations have been avoided thanks to the surrogate energy
+void report_screening(const simulations::forcefields::TotalEnergyByResidue &en, const std::string &which) {
+
+  if (en.count_screened() == 0) return;
+  logs << utils::LogLevel::INFO << utils::string_format(
+    "delayed acceptance%s: %d moves screened, %d passed to the full evaluation, %.1f%% of full evaluations saved\n",
+    which.c_str(), int(en.count_screened()), int(en.count_passed()),
+    100.0 * (en.count_screened() - en.count_passed()) / en.count_screened());
+}
+
+/** @brief Grows starting models in the SURPASS representation with the chain-growth sampler.
+ *
+ * The lowest-energy unique models are written to perm_models.pdb
+ * @param ss2_aa - secondary structure of the modelled chain
+ * @param n_models - the number of models requested
+ * @param scoring_cfg - force field used to grow and score the chains
+ */
+std::vector<core::data::structural::Structure_SP> grown_structures(core::data::sequence::SecondaryStructure_SP ss2_aa,
+    core::index2 n_models, const simulations::forcefields::ForceFieldConfig &scoring_cfg) {
+
+  using namespace utils::options; // --- All the options are in this namespace
+
+  // --- A straight CA chain defines atoms of the grown model; its coordinates are not used
+  std::vector<Vec3> ca;
+  for (core::index4 i = 0; i < ss2_aa->length(); ++i) ca.emplace_back(3.8 * i, 0.0, 0.0);
+  core::data::structural::Structure_SP ca_chain = simulations::api::SurpassSimulation::structure_from_ca(ca, *ss2_aa);
+
+  simulations::sampling::SurpassChainGrowth perm(simulations::representations::surpass_representation(*ca_chain),
+    ss2_aa, scoring_cfg.str(), option_value<core::index2>(n_threads, 0));
+  perm.temperature(option_value<core::real>(perm_temperature, 1.0));
+  perm.run(option_value<core::index4>(perm_tours), n_models);
+  perm.write_pdb("perm_models.pdb");
+  std::vector<core::data::structural::Structure_SP> structures = perm.structures();
+  if (structures.empty()) {
+    logs << utils::LogLevel::CRITICAL << "The chain-growth sampler could not complete any chain\n";
+    utils::exit_OK_with_message("The chain-growth sampler could not complete any chain\n");
+  }
+  return structures;
 }
 
 std::vector<core::data::structural::Structure_SP> starting_structures(
-  core::data::sequence::SecondaryStructure_SP ss2_aa, core::index2 n_replicas = 1) {
+  core::data::sequence::SecondaryStructure_SP ss2_aa, const simulations::forcefields::ForceFieldConfig &scoring_cfg,
+  core::index2 n_replicas = 1) {
 
   using namespace utils::options; // --- All the options are in this namespace
   using namespace core::data::structural;
 
   std::vector<Structure_SP> structures;
-  if (input_pdb.was_used()) {
+  if (perm_tours.was_used()) {
+    // --- Grown models are already in SURPASS representation
+    structures = grown_structures(ss2_aa, n_replicas, scoring_cfg);
+  } else if (input_pdb.was_used() && input_cache.was_used()) {
+    // --- Structures from the cache are already in SURPASS representation
+    simulations::representations::SurpassInputCache cache(option_value<std::string>(input_cache));
+    structures = cache.surpass_structures(option_value<std::string>(input_pdb), *ss2_aa);
+  } else if (input_pdb.was_used()) {
     core::data::io::Pdb reader(option_value<std::string>(input_pdb), core::data::io::is_not_alternative, true);
     reader.create_structures(structures);
   } else {
@@ -116,6 +218,21 @@ std::vector<core::data::structural::Structure_SP> starting_structures(
   return structures;
 }
 
+/** @brief Native structure in SURPASS representation, used to define native contacts.
+ *
+ * @param fallback - structure returned when no native structure was given with -in:pdb:native
+ */
+core::data::structural::Structure_SP native_surpass_structure(core::data::structural::Structure_SP fallback) {
+
+  using namespace utils::options; // --- All the options are in this namespace
+
+  if (!input_pdb_native.was_used()) return fallback;
+  core::data::io::Pdb native_reader(option_value<std::string>(input_pdb_native), core::data::io::is_not_alternative, true);
+  core::data::structural::Structure_SP native = native_reader.create_structure(0);
+  if (simulations::representations::is_surpass_model(*native)) return native;
+  return simulations::representations::surpass_representation(*native);
+}
+
 void run_annealing(core::data::structural::Structure_SP starting_structure, const simulations::forcefields::ForceFieldConfig & scoring_cfg) {
 
   using namespace simulations::forcefields;
@@ -131,33 +248,55 @@ void run_annealing(core::data::structural::Structure_SP starting_structure, cons
   const core::index4 n_outer_cycles = option_value<core::index2>(mc_outer_cycles, 200);
   const core::index4 cycle_size = option_value<core::index2>(mc_cycle_factor, 10);
 
-  // --- Create the system to be sampled
+  // --- Create the system, its energy, movers and the sampler
   std::string input_ss2_file = option_value<std::string>(input_ss2);
   core::data::sequence::SecondaryStructure_SP ss2_aa = core::data::io::read_ss2(input_ss2_file, "");
-  std::shared_ptr<SurpassModel<Vec3>> rc = std::make_shared<SurpassModel<Vec3>>(*starting_structure);
-
-  // ---------- Prepare the scoring function ----------
-  std::shared_ptr<TotalEnergyByResidue> en = create_surpass_energy<Vec3>(*rc, ss2_aa, scoring_cfg.str());
-
-  // ---------- Movers definition ----------
-  core::real move_range = (!random_jump_range.was_used()) ? 0.5 : option_value<core::real>(random_jump_range);
-  logs << utils::LogLevel::INFO << "jump range: " << move_range << "\n";
-  simulations::movers::MoversSet_SP movers = create_movers(*rc, en, move_range);
-
-  // ---------- Create the sampler
-  std::vector<core::real> temperatures = utils::options::annealing_temperatures_from_cmdline();
-  auto sampler = simulations::sampling::SimulatedAnnealing(movers, temperatures);
-  sampler.cycles(n_inner_cycles,n_outer_cycles, cycle_size);
+  simulations::api::SurpassSimulation simulation({starting_structure}, ss2_aa, scoring_cfg.str());
+  simulation.cycles(n_inner_cycles, n_outer_cycles, cycle_size);
+  moves_from_cmdline(simulation);
+  if (annealing_adaptive.was_used()) {
+    if (!end_temperature.was_used()) {
+      logs << utils::LogLevel::CRITICAL << "Adaptive annealing requires -sample:t_end\n";
+      utils::exit_OK_with_message("Adaptive annealing requires -sample:t_end\n");
+    }
+    try {
+      simulation.adaptive_annealing(option_value<core::real>(begin_temperature, 1.0),
+                                    option_value<core::real>(end_temperature), option_value<core::real>(annealing_adaptive));
+    } catch (const std::invalid_argument &e) {
+      logs << utils::LogLevel::CRITICAL << e.what();
+      utils::exit_OK_with_message(e.what());
+    }
+  } else if (annealing_schedule.was_used()) {
+    core::data::io::DataTable schedule(option_value<std::string>(annealing_schedule));
+    std::vector<core::real> temperatures;
+    std::vector<core::index4> outer_cycles;
+    for (const core::data::io::TableRow &row : schedule) {
+      temperatures.push_back(row.get<core::real>(0));
+      outer_cycles.push_back(row.get<core::index4>(1));
+    }
+    simulation.annealing(temperatures, outer_cycles);
+  } else simulation.annealing(utils::options::annealing_temperatures_from_cmdline());
+  std::shared_ptr<SurpassModel<Vec3>> rc = simulation.system(0);
+  std::shared_ptr<TotalEnergyByResidue> en = simulation.energy_function(0);
+  simulations::movers::MoversSet_SP movers = simulation.movers(0);
+  simulations::sampling::IsothermalMC &sampler = *simulation.sampler(0);
+  surrogate_from_cmdline(*en);
+  adaptive_movers_from_cmdline(*movers);
 
 //  auto start = std::chrono::high_resolution_clock::now();
   logs << utils::LogLevel::INFO << "Initial energy: " << en->calculate() << "\n";
   std::string out_pdb_fname = option_value<std::string>(output_pdb, "tra.pdb");
   auto tra = std::make_shared<simulations::observers::cartesian::PdbObserver<Vec3>>(*rc, *starting_structure, out_pdb_fname);
 
-  std::shared_ptr<simulations::observers::cartesian::PdbObserver<Vec3>> min_tra = nullptr;
+  simulations::observers::ObserverInterface_SP min_tra = nullptr;
+  std::shared_ptr<simulations::observers::ObserveLowEnergyArchive<Vec3>> min_archive = nullptr;
   if(output_pdb_min.was_used()){
     std::string fname = option_value<std::string>(output_pdb_min);
-    min_tra = std::make_shared<simulations::observers::cartesian::PdbObserver<Vec3>>(*rc, *starting_structure, fname);
+    if (output_pdb_min_archive.was_used()) {
+      min_archive = std::make_shared<simulations::observers::ObserveLowEnergyArchive<Vec3>>(*rc, *starting_structure,
+        *en, fname, option_value<core::real>(output_pdb_min_archive));
+      min_tra = min_archive;
+    } else min_tra = std::make_shared<simulations::observers::cartesian::PdbObserver<Vec3>>(*rc, *starting_structure, fname);
     core::real fraction = option_value<core::real>(output_pdb_min_fraction,0.1);
     core::real max_en = option_value<core::real>(output_pdb_min_value,en->calculate());
     std::shared_ptr<simulations::observers::TriggerLowEnergy> low_en_trigger =
@@ -178,6 +317,13 @@ void run_annealing(core::data::structural::Structure_SP starting_structure, cons
     rms = std::make_shared<simulations::evaluators::cartesian::CrmsdEvaluator<Vec3>>(native_structure, *rc);
   } else rms = std::make_shared<simulations::evaluators::cartesian::CrmsdEvaluator<Vec3>>(starting_structure, *rc);
   stats->add_evaluator(rms);
+  if (input_pdb_native.was_used()) { // --- quality columns only when the native structure is really known
+    core::data::structural::Structure_SP native_surpass = native_surpass_structure(starting_structure);
+    stats->add_evaluator(std::make_shared<simulations::evaluators::cv::NativeContactsCV<Vec3>>(*native_surpass, *rc));
+    auto tm_score = std::make_shared<simulations::evaluators::cartesian::TMScoreEvaluator<Vec3>>(native_surpass, *rc);
+    stats->add_evaluator(tm_score);
+    stats->add_evaluator(std::make_shared<simulations::evaluators::cartesian::GdtTsEvaluator<Vec3>>(tm_score));
+  }
   stats->observe_header();
   stats->observe();
 
@@ -193,12 +339,13 @@ void run_annealing(core::data::structural::Structure_SP starting_structure, cons
     = std::make_shared<simulations::observers::cartesian::EndVectorObserver<Vec3>>(*rc,"r_end.dat");
 
   // --- Create H-bond topology map observer
+  auto topologies = std::make_shared<simulations::observers::TopologyRegistry>();
   for(core::index2 ien=0;ien<en->count_components(); ++ien) {
     std::shared_ptr<SurpassHydrogenBond<Vec3>> hb_en
       = std::dynamic_pointer_cast<SurpassHydrogenBond<Vec3>>(en->get_component(ien));
     if(hb_en!= nullptr) {
-      std::shared_ptr<ObserveTopologyMatrix<Vec3>> obs_topo
-        = std::make_shared<ObserveTopologyMatrix<Vec3>>(hb_en, "topology.dat");
+      std::shared_ptr<ObserveTopologyMatrix<Vec3>> obs_topo = std::make_shared<ObserveTopologyMatrix<Vec3>>(hb_en,
+        "topology.dat", topologies, [&sampler]() { return sampler.temperature(); });
       sampler.outer_cycle_observer(obs_topo);
     }
   }
@@ -210,7 +357,31 @@ void run_annealing(core::data::structural::Structure_SP starting_structure, cons
   sampler.outer_cycle_observer(r_end);
   sampler.outer_cycle_observer(tra);
   if (min_tra != nullptr) sampler.outer_cycle_observer(min_tra);
-  sampler.run();
+  if (output_pymol.was_used()) { // --- live view: rate-limited, so it may be called after every inner cycle
+    const std::string where = option_value<std::string>(output_pymol);
+    const size_t colon = where.find(':');
+    const size_t port = (colon == std::string::npos) ? 65000 : std::stoi(where.substr(colon + 1));
+    auto pymol = std::make_shared<simulations::observers::cartesian::PymolObserver<Vec3>>(*rc, *starting_structure,
+      where.substr(0, colon), port, option_value<double>(output_pymol_fps, 10.0));
+    pymol->observe(pymol_style);
+    sampler.inner_cycle_observer(pymol);
+  }
+
+  std::shared_ptr<utils::PerfCounters> perf = nullptr;
+  if (output_perf.was_used()) {
+    perf = std::make_shared<utils::PerfCounters>();
+    en->profile(perf);
+    sampler.profile(perf);
+  }
+  simulation.run();
+  report_screening(*en, "");
+  if (min_archive) min_archive->finalize();
+  if (simulation.adaptive_annealer()) simulation.adaptive_annealer()->write_schedule(*utils::out_stream("annealing_schedule.dat"));
+  if (perf) perf->write(*utils::out_stream("perf.dat"));
+  if (topologies->count_topologies() > 0) {
+    topologies->write_populations(*utils::out_stream("topology_populations.dat"));
+    topologies->write_transitions(*utils::out_stream("topology_transitions.dat"));
+  }
 
 //  tra.finalize();
   simulations::observers::cartesian::write_pdb_conformation(*rc, *starting_structure, "final.pdb");
@@ -236,33 +407,39 @@ void run_replicas(std::vector<core::data::structural::Structure_SP> & starting_s
   std::string input_ss2_file = option_value<std::string>(input_ss2);
   core::data::sequence::SecondaryStructure_SP ss2_aa = core::data::io::read_ss2(input_ss2_file, "");
 
-  std::vector<std::shared_ptr<SurpassModel<Vec3>>> systems;
-  std::vector<simulations::sampling::IsothermalMC_SP> replica_samplers;
-  std::vector<CalculateEnergyBase_SP> energies;
+  std::vector<std::shared_ptr<utils::PerfCounters>> perf; // --- one per replica, filled only when -out:perf is used
+
+  // --- In DEMUX mode output files are named by replica index rather than by temperature
+  const simulations::sampling::ReplicaExchangeObservationMode mode = simulations::sampling::remc_observation_mode(
+    option_value<std::string>(utils::options::replica_observation_mode, "ISOTHERMAL"));
+  logs << utils::LogLevel::INFO << "replica observation mode: " << simulations::sampling::remc_observation_mode_name(mode) << "\n";
+  auto out_name = [&](const std::string &prefix, const std::string &ext, const core::index2 irepl) {
+    return (mode == simulations::sampling::ReplicaExchangeObservationMode::DEMUX) ?
+           utils::string_format("%s-r%d%s", prefix.c_str(), int(irepl), ext.c_str()) :
+           utils::string_format("%s-%.3f%s", prefix.c_str(), temperatures[irepl], ext.c_str());
+  };
+
+  // --- Native structure in SURPASS representation for TM-score; without it observers files keep their format
+  core::data::structural::Structure_SP native_surpass = nullptr;
+  if (input_pdb_native.was_used()) native_surpass = native_surpass_structure(nullptr);
+
+  // --- Create the systems to be sampled, their energy functions, movers and samplers
+  simulations::api::SurpassSimulation simulation(starting_structures, ss2_aa, scoring_cfg.str());
+  simulation.cycles(n_inner_cycles, n_outer_cycles);
+  moves_from_cmdline(simulation);
+  simulation.replicas(temperatures, n_exchanges, mode);
+  // --- Topologies are identified across replicas and counted at every temperature
+  auto topologies = std::make_shared<simulations::observers::TopologyRegistry>();
 
-  std::vector<core::real> move_ranges;
-  if (random_jump_range.was_used()) option_value<core::real>(random_jump_range, move_ranges);
-  else move_ranges.push_back(0.5);
-
-  // --- Create the systems to be sampled
   for (core::index2 irepl = 0; irepl < temperatures.size(); ++irepl) {
 
-    auto rc = std::make_shared<SurpassModel<Vec3>>(*starting_structures[irepl]);
-    systems.push_back(rc);
-
-    // ---------- Create energy function for that systems
-    std::shared_ptr<TotalEnergyByResidue> en = create_surpass_energy<Vec3>(*rc, ss2_aa, scoring_cfg.str());
-    energies.push_back( std::dynamic_pointer_cast<CalculateEnergyBase>(en) );
-
-    // ---------- Movers definition ----------
-    logs << utils::LogLevel::INFO << "jump range for replica " << irepl << " : "
-         << move_ranges[irepl % move_ranges.size()] << "\n";
-    simulations::movers::MoversSet_SP movers = create_movers(*rc, en, move_ranges[irepl % move_ranges.size()]);
-
-    // ---------- Create the sampler
-    auto sampler = std::make_shared<simulations::sampling::IsothermalMC>(movers, temperatures[irepl]);
-    replica_samplers.push_back(sampler);
-    sampler->cycles(n_inner_cycles,n_outer_cycles);
+    std::shared_ptr<SurpassModel<Vec3>> rc = simulation.system(irepl);
+    std::shared_ptr<TotalEnergyByResidue> en = simulation.energy_function(irepl);
+    simulations::movers::MoversSet_SP movers = simulation.movers(irepl);
+    simulations::sampling::IsothermalMC_SP sampler = simulation.sampler(irepl);
+    const simulations::sampling::IsothermalMC *replica = sampler.get(); // --- a raw pointer: observers are owned by the sampler
+    surrogate_from_cmdline(*en);
+    adaptive_movers_from_cmdline(*movers);
 
 //    logs << utils::LogLevel::INFO << "chain length: " << rc->count_residues() << ", seq length: " << ss2_aa->length() << "\n";
 
@@ -272,9 +449,9 @@ void run_replicas(std::vector<core::data::structural::Structure_SP> & starting_s
 
     // ---------- Observers & Evaluators
     auto tra = std::make_shared<simulations::observers::cartesian::PdbObserver<Vec3>>(*rc, *starting_structures[irepl],
-      utils::string_format("tra-%.3f.pdb",temperatures[irepl]));
+      out_name("tra", ".pdb", irepl));
 
-    ObserveEvaluators_SP stats = std::make_shared<ObserveEvaluators>(utils::string_format("observers-%.3f.dat",temperatures[irepl]));
+    ObserveEvaluators_SP stats = std::make_shared<ObserveEvaluators>(out_name("observers", ".dat", irepl));
     stats->add_evaluator(std::make_shared<simulations::evaluators::cartesian::RgSquare<Vec3>>(*rc));
     stats->add_evaluator(std::make_shared<simulations::evaluators::Timer>());
 //    stats->add_evaluator(std::make_shared<simulations::evaluators::EchoEvaluator<core::real>>(temperature,"temperature"));
@@ -285,16 +462,21 @@ void run_replicas(std::vector<core::data::structural::Structure_SP> & starting_s
       rms = std::make_shared<simulations::evaluators::cartesian::CrmsdEvaluator<Vec3>>(native_structure, *rc);
     } else rms = std::make_shared<simulations::evaluators::cartesian::CrmsdEvaluator<Vec3>>(starting_structures[irepl], *rc);
     stats->add_evaluator(rms);
+    if (native_surpass) {
+      auto tm_score = std::make_shared<simulations::evaluators::cartesian::TMScoreEvaluator<Vec3>>(native_surpass, *rc);
+      stats->add_evaluator(tm_score);
+      stats->add_evaluator(std::make_shared<simulations::evaluators::cartesian::GdtTsEvaluator<Vec3>>(tm_score));
+    }
     stats->observe_header();
 //    stats->observe();
 
     // --- Create observer for energy components and movers
     std::shared_ptr<ObserveEnergyComponents<ByResidueEnergy>> obs_en
-      = std::make_shared<simulations::observers::ObserveEnergyComponents<ByResidueEnergy>>(*en, utils::string_format("energy-%.3f.dat",temperatures[irepl]));
+      = std::make_shared<simulations::observers::ObserveEnergyComponents<ByResidueEnergy>>(*en, out_name("energy", ".dat", irepl));
     obs_en->observe_header();
 //    obs_en->observe();
     ObserveMoversAcceptance_SP obs_ms = std::make_shared<simulations::observers::ObserveMoversAcceptance>(*movers,
-      utils::string_format("movers-%.3f.dat",temperatures[irepl]));
+      out_name("movers", ".dat", irepl));
     obs_ms->observe_header();
 //    obs_ms->observe();
 
@@ -302,7 +484,7 @@ void run_replicas(std::vector<core::data::structural::Structure_SP> & starting_s
       std::shared_ptr<SurpassHydrogenBond<Vec3>> hb_en = std::dynamic_pointer_cast<SurpassHydrogenBond<Vec3>>(en->get_component(ien));
       if(hb_en!= nullptr) {
         std::shared_ptr<ObserveTopologyMatrix<Vec3>> obs_topo = std::make_shared<ObserveTopologyMatrix<Vec3>>(hb_en,
-          utils::string_format("topology-%.3f.dat",temperatures[irepl]));
+          out_name("topology", ".dat", irepl), topologies, [replica]() { return replica->temperature(); });
         sampler->outer_cycle_observer(obs_topo);
       }
     }
@@ -310,21 +492,414 @@ void run_replicas(std::vector<core::data::structural::Structure_SP> & starting_s
     sampler->outer_cycle_observer(obs_en);
     sampler->outer_cycle_observer(obs_ms);
     sampler->outer_cycle_observer(tra);
+
+    if (output_perf.was_used()) {
+      perf.push_back(std::make_shared<utils::PerfCounters>());
+      en->profile(perf.back());
+      sampler->profile(perf.back());
+    }
+  }
+
+  auto remc_flow = std::make_shared<ObserveReplicaFlow>(*simulation.replica_exchange(), "replica_flow.dat");
+  simulation.replica_exchange()->exchange_observer(remc_flow);
+  std::shared_ptr<simulations::sampling::ConformationReservoir> reservoir = nullptr;
+  if (reservoir_in.was_used()) {
+    const std::string fname = option_value<std::string>(reservoir_in);
+    try {
+      reservoir = std::make_shared<simulations::sampling::ConformationReservoir>(fname);
+    } catch (const std::runtime_error &e) {
+      logs << utils::LogLevel::CRITICAL << "Can't load a reservoir: " << e.what();
+      utils::exit_OK_with_message(std::string("Can't load a reservoir: ") + e.what());
+    }
+    if (reservoir->count_atoms() != simulation.system(0)->n_atoms) {
+      const std::string msg = utils::string_format("Reservoir %s holds conformations of %d atoms while replicas have %d\n",
+        fname.c_str(), int(reservoir->count_atoms()), int(simulation.system(0)->n_atoms));
+      logs << utils::LogLevel::CRITICAL << msg;
+      utils::exit_OK_with_message(msg);
+    }
+    simulation.replica_exchange()->reservoir(reservoir->energies(), reservoir->temperature(),
+      [&simulation, reservoir](const core::index2 replica, const core::index4 conformation) {
+        reservoir->copy_to(conformation, *simulation.system(replica));
+      });
+  }
+  std::shared_ptr<ObserveReservoir<Vec3>> reservoir_tra = nullptr;
+  if (reservoir_out.was_used()) {
+    std::vector<std::shared_ptr<simulations::systems::CartesianAtomsSimple<Vec3>>> remc_systems;
+    for (core::index2 irepl = 0; irepl < simulation.count_replicas(); ++irepl) remc_systems.push_back(simulation.system(irepl));
+    reservoir_tra = std::make_shared<ObserveReservoir<Vec3>>(*simulation.replica_exchange(), remc_systems,
+      option_value<std::string>(reservoir_out));
+    simulation.replica_exchange()->exchange_observer(reservoir_tra);
+  }
+  simulation.run();
+  if (reservoir_tra) reservoir_tra->finalize();
+  for (core::index2 irepl = 0; irepl < simulation.count_replicas(); ++irepl)
+    report_screening(*simulation.energy_function(irepl), utils::string_format(" (replica %d)", int(irepl)));
+  for (core::index2 irepl = 0; irepl < perf.size(); ++irepl)
+    perf[irepl]->write(*utils::out_stream(utils::string_format("perf-r%d.dat", int(irepl))));
+  if (topologies->count_topologies() > 0) {
+    topologies->write_populations(*utils::out_stream("topology_populations.dat"));
+    topologies->write_transitions(*utils::out_stream("topology_transitions.dat"));
+  }
+
+  simulations::observers::cartesian::PdbObserver<Vec3> final(*simulation.system(0), *starting_structures[0], "final.pdb");
+  for (core::index2 irepl = 0; irepl < simulation.count_replicas(); ++irepl) final.observe(*simulation.system(irepl));
+  final.finalize();
+}
+
+void run_lockstep(std::vector<core::data::structural::Structure_SP> & starting_structures,
+              const simulations::forcefields::ForceFieldConfig & scoring_cfg, std::vector<core::real> temperatures) {
+
+  using namespace simulations::forcefields;
+  using namespace simulations::forcefields::surpass;
+  using namespace simulations::systems::surpass;
+  using namespace utils::options; // --- All the options are in this namespace
+  using namespace simulations::observers;
+
+  const core::index4 n_inner_cycles = option_value<core::index4>(mc_inner_cycles, 10);
+  const core::index4 n_outer_cycles = option_value<core::index4>(mc_outer_cycles, 200);
+  const core::index4 cycle_size = option_value<core::index4>(mc_cycle_factor, 1);
+
+  std::string input_ss2_file = option_value<std::string>(input_ss2);
+  core::data::sequence::SecondaryStructure_SP ss2_aa = core::data::io::read_ss2(input_ss2_file, "");
+
+  std::vector<std::shared_ptr<SurpassModel<Vec3>>> systems;
+  std::vector<std::shared_ptr<TotalEnergyByResidue>> energies;
+  for (core::index2 irepl = 0; irepl < temperatures.size(); ++irepl) {
+    systems.push_back(std::make_shared<SurpassModel<Vec3>>(*starting_structures[irepl]));
+    energies.push_back(create_surpass_energy<Vec3>(*systems.back(), ss2_aa, scoring_cfg.str()));
+    logs << utils::LogLevel::INFO << "Initial energy for replica " << irepl << " : " << energies.back()->calculate()
+         << " at temperature " << temperatures[irepl] << "\n";
   }
 
-  core::index2 trajectory_mode = option_value<core::index2>(utils::options::replica_observation_mode,0);
-  bool replica_isothermal_observation_mode = (trajectory_mode==0);
-  auto remc = std::make_shared<simulations::sampling::ReplicaExchangeMC>(replica_samplers, energies, replica_isothermal_observation_mode);
-  auto remc_flow = std::make_shared<ObserveReplicaFlow>(*remc,"replica_flow.dat");
-  remc->exchange_observer(remc_flow);
-  remc->replica_exchanges(n_exchanges);
-  remc->run();
+  simulations::sampling::LockstepReplicaMC sampler(systems, energies, temperatures);
+  sampler.cycles(n_inner_cycles, n_outer_cycles, cycle_size);
+  sampler.max_move_range((!random_jump_range.was_used()) ? 0.5 : option_value<core::real>(random_jump_range));
+  for (core::index2 irepl = 0; irepl < temperatures.size(); ++irepl) {
+    std::shared_ptr<ObserveEnergyComponents<ByResidueEnergy>> obs_en = std::make_shared<ObserveEnergyComponents<ByResidueEnergy>>(
+      *energies[irepl], utils::string_format("energy-%.3f.dat", temperatures[irepl]));
+    obs_en->observe_header();
+    sampler.outer_cycle_observer(obs_en);
+    sampler.outer_cycle_observer(std::make_shared<simulations::observers::cartesian::PdbObserver<Vec3>>(*systems[irepl],
+      *starting_structures[irepl], utils::string_format("tra-%.3f.pdb", temperatures[irepl])));
+  }
+  sampler.run();
 
-  simulations::observers::cartesian::PdbObserver<Vec3> final(*systems[0],*starting_structures[0], "final.pdb");
-  for(auto rc : systems) final.observe(*rc);
+  simulations::observers::cartesian::PdbObserver<Vec3> final(*systems[0], *starting_structures[0], "final.pdb");
+  for (auto rc : systems) final.observe(*rc);
   final.finalize();
 }
 
+void run_umbrella(std::vector<core::data::structural::Structure_SP> & starting_structures,
+              const simulations::forcefields::ForceFieldConfig & scoring_cfg, std::vector<core::real> centers) {
+
+  using namespace simulations::forcefields;
+  using namespace simulations::forcefields::surpass;
+  using namespace simulations::systems::surpass;
+  using namespace simulations::evaluators::cv;
+  using namespace utils::options; // --- All the options are in this namespace
+  using namespace simulations::observers;
+
+  const core::index4 n_inner_cycles = option_value<core::index4>(mc_inner_cycles, 10);
+  const core::index4 n_outer_cycles = option_value<core::index4>(mc_outer_cycles, 200);
+  const core::index4 n_rounds = option_value<core::index4>(replica_exchanges, 10);
+  const core::real temperature = option_value<core::real>(begin_temperature, 1.0);
+  const core::real k = option_value<core::real>(umbrella_k, 1.0);
+  const std::string cv_name = option_value<std::string>(umbrella_cv);
+  const BiasShape shape = (umbrella_flat.was_used()) ? BiasShape::FLAT_BOTTOM : BiasShape::HARMONIC;
+  const core::real half_width = option_value<core::real>(umbrella_flat, 0.0);
+
+  std::string input_ss2_file = option_value<std::string>(input_ss2);
+  core::data::sequence::SecondaryStructure_SP ss2_aa = core::data::io::read_ss2(input_ss2_file, "");
+
+  core::data::structural::Structure_SP reference = starting_structures[0];
+  if (input_pdb_native.was_used()) {
+    core::data::io::Pdb native_reader(option_value<std::string>(input_pdb_native));
+    reference = native_reader.create_structure(0);
+  }
+
+  std::vector<std::shared_ptr<SurpassModel<Vec3>>> systems;
+  std::vector<simulations::sampling::IsothermalMC_SP> window_samplers;
+  std::vector<CVBiasEnergy_SP> biases;
+  std::vector<std::shared_ptr<TotalEnergyByResidue>> energies; // --- movers hold just references to energy functions
+
+  for (core::index2 iw = 0; iw < centers.size(); ++iw) {
+
+    auto rc = std::make_shared<SurpassModel<Vec3>>(*starting_structures[iw]);
+    systems.push_back(rc);
+
+    // ---------- Energy function for that system: force field plus the umbrella bias
+    std::shared_ptr<TotalEnergyByResidue> en = create_surpass_energy<Vec3>(*rc, ss2_aa, scoring_cfg.str());
+    CollectiveVariable_SP cv = nullptr;
+    if (cv_name == "crmsd") cv = std::make_shared<CrmsdCV<Vec3>>(reference, *rc);
+    else if (cv_name == "q") cv = std::make_shared<NativeContactsCV<Vec3>>(*native_surpass_structure(starting_structures[0]), *rc);
+    else cv = std::make_shared<RgCV<Vec3>>(*rc);
+    auto bias = std::make_shared<CVBiasEnergy>(*rc, cv, centers[iw], k, shape, half_width);
+    en->add_component(bias, 1.0);
+    biases.push_back(bias);
+    energies.push_back(en);
+
+    simulations::movers::MoversSet_SP movers = create_movers(*rc, en, iw);
+    auto sampler = std::make_shared<simulations::sampling::IsothermalMC>(movers, temperature);
+    sampler->cycles(n_inner_cycles, n_outer_cycles);
+    window_samplers.push_back(sampler);
+
+    logs << utils::LogLevel::INFO << "Initial energy for window " << iw << " : " << en->calculate() << " "
+         << cv->name() << " = " << cv->evaluate() << " umbrella center: " << centers[iw] << "\n";
+
+    std::shared_ptr<ObserveEnergyComponents<ByResidueEnergy>> obs_en
+      = std::make_shared<ObserveEnergyComponents<ByResidueEnergy>>(*en, utils::string_format("energy-%d.dat", iw));
+    obs_en->observe_header();
+    sampler->outer_cycle_observer(obs_en);
+  }
+
+  simulations::sampling::UmbrellaSampling umbrella(window_samplers, biases, option_value<core::index2>(n_threads, 0));
+  umbrella.window_exchanges(!umbrella_no_exchange.was_used());
+  umbrella.run(n_rounds);
+
+  core::calc::statistics::Wham wham = umbrella.wham(option_value<core::index2>(umbrella_bins, 50));
+  std::vector<double> pmf = wham.pmf();
+  std::vector<double> p = wham.probabilities();
+  std::ofstream out("pmf.dat");
+  out << "#       x      pmf     probability\n";
+  for (core::index2 b = 0; b < wham.count_bins(); ++b)
+    out << utils::string_format("%9.4f %8.3f %15.8f\n", wham.x(b), pmf[b], p[b]);
+  out.close();
+
+  simulations::observers::cartesian::PdbObserver<Vec3> final(*systems[0], *starting_structures[0], "final.pdb");
+  for (core::index2 iw = 0; iw < centers.size(); ++iw) final.observe(*systems[umbrella.replica_for_window(iw)]);
+  final.finalize();
+}
+
+void run_metadynamics(core::data::structural::Structure_SP starting_structure,
+              const simulations::forcefields::ForceFieldConfig & scoring_cfg) {
+
+  using namespace simulations::forcefields;
+  using namespace simulations::forcefields::surpass;
+  using namespace simulations::systems::surpass;
+  using namespace simulations::evaluators::cv;
+  using namespace utils::options; // --- All the options are in this namespace
+  using namespace simulations::observers;
+
+  const core::index4 n_inner_cycles = option_value<core::index4>(mc_inner_cycles, 10);
+  const core::index4 n_outer_cycles = option_value<core::index4>(mc_outer_cycles, 200);
+  const core::index4 cycle_size = option_value<core::index4>(mc_cycle_factor, 1);
+  const core::real temperature = option_value<core::real>(begin_temperature, 1.0);
+
+  std::string input_ss2_file = option_value<std::string>(input_ss2);
+  core::data::sequence::SecondaryStructure_SP ss2_aa = core::data::io::read_ss2(input_ss2_file, "");
+  std::shared_ptr<SurpassModel<Vec3>> rc = std::make_shared<SurpassModel<Vec3>>(*starting_structure);
+  std::shared_ptr<TotalEnergyByResidue> en = create_surpass_energy<Vec3>(*rc, ss2_aa, scoring_cfg.str());
+
+  // ---------- Collective variables and their grids
+  std::vector<std::string> cv_names;
+  utils::split(option_value<std::string>(metad_cv), cv_names, ',');
+  std::vector<core::real> grid, sigma;
+  option_value<core::real>(metad_grid, grid);
+  option_value<core::real>(metad_sigma, sigma);
+  std::vector<MetadynamicsAxis> axes;
+  for (core::index2 i = 0; i < cv_names.size(); ++i) {
+    MetadynamicsAxis a;
+    if (cv_names[i] == "hb") {
+      std::shared_ptr<SurpassHydrogenBond<Vec3>> hb_en = nullptr;
+      for (core::index2 ien = 0; ien < en->count_components(); ++ien)
+        if (hb_en == nullptr) hb_en = std::dynamic_pointer_cast<SurpassHydrogenBond<Vec3>>(en->get_component(ien));
+      if (hb_en == nullptr) utils::exit_OK_with_message("H-bond count CV requires SurpassHydrogenBond energy term\n");
+      a.cv = std::make_shared<HBondCountCV<Vec3>>(hb_en, rc->n_atoms);
+      a.min = 0;
+      a.max = 2 * rc->atoms_in_beta().size() + 1;
+      a.n_points = a.max + 1;
+      a.sigma = 1.0;
+    } else if (cv_names[i] == "q") {
+      a.cv = std::make_shared<NativeContactsCV<Vec3>>(*native_surpass_structure(starting_structure), *rc);
+      a.min = 0.0;
+      a.max = 1.0;
+      a.n_points = 101;
+      a.sigma = 0.05;
+    } else {
+      a.cv = std::make_shared<RgCV<Vec3>>(*rc);
+      a.min = 5.0;
+      a.max = 5.0 + rc->n_atoms;
+      a.n_points = 10 * rc->n_atoms + 1;
+      a.sigma = 0.3;
+    }
+    if (grid.size() >= 3 * size_t(i) + 3) {
+      a.min = grid[3 * i];
+      a.max = grid[3 * i + 1];
+      a.n_points = core::index2(grid[3 * i + 2]);
+    }
+    if (sigma.size() > i) a.sigma = sigma[i];
+    axes.push_back(a);
+  }
+  auto bias = std::make_shared<MetadynamicsBias>(*rc, axes, option_value<core::real>(metad_height, 0.5),
+                                                 option_value<core::real>(metad_bias_factor, 10.0), temperature);
+  if (metad_restart.was_used()) {
+    std::ifstream in(option_value<std::string>(metad_restart));
+    try {
+      bias->read_state(in);
+    } catch (const std::invalid_argument &e) {
+      logs << utils::LogLevel::CRITICAL << "Can't restart metadynamics: " << e.what();
+      utils::exit_OK_with_message(std::string("Can't restart metadynamics: ") + e.what());
+    }
+  }
+  en->add_component(bias, 1.0); // --- must follow SurpassHydrogenBond, which updates H-bonds for HBondCountCV
+
+  // ---------- Movers and the sampler
+  simulations::movers::MoversSet_SP movers = create_movers(*rc, en, 0);
+  simulations::sampling::IsothermalMC sampler(movers, temperature);
+  sampler.cycles(n_inner_cycles, n_outer_cycles, cycle_size);
+  logs << utils::LogLevel::INFO << "Initial energy: " << en->calculate() << "\n";
+
+  auto metad = std::make_shared<ObserveMetadynamics>(bias, "metad.state", "fes.dat");
+  metad->set_trigger(std::make_shared<TriggerEveryN>(option_value<core::index2>(metad_stride, 1)));
+  sampler.inner_cycle_observer(metad);
+
+  ObserveEvaluators_SP stats = std::make_shared<ObserveEvaluators>("observers.dat");
+  for (const auto &a : axes) stats->add_evaluator(a.cv);
+  stats->add_evaluator(std::make_shared<simulations::evaluators::Timer>());
+  stats->observe_header();
+  std::shared_ptr<ObserveEnergyComponents<ByResidueEnergy>> obs_en
+    = std::make_shared<ObserveEnergyComponents<ByResidueEnergy>>(*en, "energy.dat");
+  obs_en->observe_header();
+  auto tra = std::make_shared<simulations::observers::cartesian::PdbObserver<Vec3>>(*rc, *starting_structure,
+    option_value<std::string>(output_pdb, "tra.pdb"));
+  sampler.outer_cycle_observer(stats);
+  sampler.outer_cycle_observer(obs_en);
+  sampler.outer_cycle_observer(tra);
+  sampler.run();
+
+  metad->finalize();
+  simulations::observers::cartesian::write_pdb_conformation(*rc, *starting_structure, "final.pdb");
+}
+
+void run_portfolio(std::vector<core::data::structural::Structure_SP> & starting_structures,
+              const simulations::forcefields::ForceFieldConfig & scoring_cfg) {
+
+  using namespace simulations::forcefields;
+  using namespace simulations::forcefields::surpass;
+  using namespace simulations::systems::surpass;
+  using namespace simulations::evaluators::cv;
+  using namespace utils::options; // --- All the options are in this namespace
+
+  const core::index4 n_inner_cycles = option_value<core::index4>(mc_inner_cycles, 200);
+  const core::index4 n_outer_cycles = option_value<core::index4>(mc_outer_cycles, 200);
+  const core::index4 cycle_size = option_value<core::index4>(mc_cycle_factor, 10);
+  const bool by_crmsd = (option_value<std::string>(portfolio_score, "energy") == "crmsd");
+
+  std::string input_ss2_file = option_value<std::string>(input_ss2);
+  core::data::sequence::SecondaryStructure_SP ss2_aa = core::data::io::read_ss2(input_ss2_file, "");
+
+  core::data::structural::Structure_SP reference = starting_structures[0];
+  if (input_pdb_native.was_used()) {
+    core::data::io::Pdb native_reader(option_value<std::string>(input_pdb_native));
+    reference = native_reader.create_structure(0);
+  }
+
+  std::vector<std::shared_ptr<SurpassModel<Vec3>>> systems;
+  std::vector<std::shared_ptr<TotalEnergyByResidue>> energies; // --- movers hold just references to energy functions
+  std::vector<CollectiveVariable_SP> crmsd;
+  std::vector<simulations::sampling::SimulatedAnnealing_SP> runs;
+  std::vector<core::real> temperatures = utils::options::annealing_temperatures_from_cmdline();
+
+  for (core::index2 irun = 0; irun < starting_structures.size(); ++irun) {
+    auto rc = std::make_shared<SurpassModel<Vec3>>(*starting_structures[irun]);
+    systems.push_back(rc);
+    energies.push_back(create_surpass_energy<Vec3>(*rc, ss2_aa, scoring_cfg.str()));
+    crmsd.push_back(std::make_shared<CrmsdCV<Vec3>>(reference, *rc));
+    simulations::movers::MoversSet_SP movers = create_movers(*rc, energies.back(), irun);
+    auto sampler = std::make_shared<simulations::sampling::SimulatedAnnealing>(movers, temperatures);
+    sampler->cycles(n_inner_cycles, n_outer_cycles, cycle_size);
+    runs.push_back(sampler);
+  }
+
+  simulations::sampling::AnnealingPortfolio portfolio(runs, [&](const core::index2 i) {
+    return (by_crmsd) ? crmsd[i]->evaluate() : energies[i]->calculate();
+  }, option_value<core::index2>(n_threads, 0));
+  portfolio.keep_fraction(option_value<core::real>(portfolio_keep, 0.5));
+  if (portfolio_stages.was_used()) portfolio.count_stages(option_value<core::index2>(portfolio_stages));
+  if (portfolio_clone.was_used())
+    portfolio.clone_best([&](const core::index2 from, const core::index2 to) {
+      systems[to]->copy_state(*systems[from]);
+      energies[to]->calculate(); // --- refreshes data cached by energy terms, e.g. the list of hydrogen bonds
+    });
+  portfolio.run();
+
+  // --- Surviving runs are written from the best to the worst
+  std::vector<core::index2> order;
+  for (core::index2 i = 0; i < portfolio.count_runs(); ++i)
+    if (portfolio.is_active(i)) order.push_back(i);
+  std::sort(order.begin(), order.end(),
+            [&](const core::index2 a, const core::index2 b) { return portfolio.score(a) < portfolio.score(b); });
+  simulations::observers::cartesian::PdbObserver<Vec3> final(*systems[0], *starting_structures[0], "final.pdb");
+  for (core::index2 i : order) {
+    logs << utils::LogLevel::INFO << "run " << i << " energy: " << energies[i]->calculate() << " crmsd: "
+         << crmsd[i]->evaluate() << "\n";
+    final.observe(*systems[i]);
+  }
+  final.finalize();
+}
+
+void run_nested(core::data::structural::Structure_SP starting_structure,
+                const simulations::forcefields::ForceFieldConfig & scoring_cfg) {
+
+  using namespace simulations::forcefields;
+  using namespace simulations::forcefields::surpass;
+  using namespace simulations::systems::surpass;
+  using namespace utils::options; // --- All the options are in this namespace
+
+  std::string input_ss2_file = option_value<std::string>(input_ss2);
+  core::data::sequence::SecondaryStructure_SP ss2_aa = core::data::io::read_ss2(input_ss2_file, "");
+
+  const core::index4 n_live = option_value<core::index4>(nested_live);
+  if (n_live < 2) {
+    logs << utils::LogLevel::CRITICAL << "Nested sampling requires at least two live points\n";
+    utils::exit_OK_with_message("Nested sampling requires at least two live points\n");
+  }
+  // --- every walker replaces a live point, so there must be more live points than walkers
+  core::index2 n_walkers = option_value<core::index2>(n_threads, 0);
+  if (n_walkers == 0) n_walkers = std::min<core::index4>(std::max(1u, std::thread::hardware_concurrency()), n_live - 1);
+  else if (n_walkers >= n_live) {
+    logs << utils::LogLevel::WARNING << "only " << int(n_live - 1) << " walkers used for " << int(n_live)
+         << " live points\n";
+    n_walkers = n_live - 1;
+  }
+
+  // --- Every walker has its own copy of the system, energy function and movers
+  std::vector<std::shared_ptr<simulations::systems::CartesianAtomsSimple<Vec3>>> systems;
+  std::vector<std::shared_ptr<TotalEnergyByResidue>> energies; // --- movers hold just references to energy functions
+  std::vector<CalculateEnergyBase_SP> walker_energies;
+  std::vector<simulations::movers::MoversSet_SP> movers;
+  auto first = std::make_shared<SurpassModel<Vec3>>(*starting_structure);
+  for (core::index2 iw = 0; iw < n_walkers; ++iw) {
+    auto rc = (iw == 0) ? first : std::make_shared<SurpassModel<Vec3>>(*first);
+    systems.push_back(rc);
+    energies.push_back(create_surpass_energy<Vec3>(*rc, ss2_aa, scoring_cfg.str()));
+    walker_energies.push_back(energies.back());
+    movers.push_back(create_movers(*rc, energies.back(), 0));
+  }
+
+  simulations::sampling::NestedSampling<Vec3> nested(systems, walker_energies, movers, n_live);
+  nested.prior_temperature(option_value<core::real>(nested_prior_t, option_value<core::real>(begin_temperature, 3.0)));
+  if (nested_walk.was_used()) nested.walk_length(option_value<core::index4>(nested_walk));
+
+  // --- Conformations of dead points are numbered as the samples in nested_samples.dat
+  SurpassModel<Vec3> display(*first);
+  simulations::observers::cartesian::PdbObserver<Vec3> samples_pdb(display, *starting_structure, "nested_samples.pdb");
+  nested.dead_point_callback([&](const std::vector<Vec3> &xyz, const simulations::sampling::NestedSampling<Vec3>::Sample &) {
+    display.restore(xyz);
+    samples_pdb.observe();
+  });
+  nested.run(option_value<core::index4>(nested_dead, 10 * n_live));
+  samples_pdb.finalize();
+
+  nested.write_samples("nested_samples.dat");
+  const core::real t_from = option_value<core::real>(begin_temperature, 0.5);
+  const core::real t_to = option_value<core::real>(end_temperature, 3.0);
+  const core::index2 n_temps = std::max(core::index2(2), option_value<core::index2>(temp_steps, 26));
+  std::vector<core::real> temperatures;
+  for (core::index2 i = 0; i < n_temps; ++i) temperatures.push_back(t_from + (t_to - t_from) * i / (n_temps - 1));
+  nested.write_thermodynamics("nested_thermo.dat", temperatures);
+}
+
 int main(int argc, const char *argv[]) {
 
   utils::LogManager::INFO();
@@ -336,9 +911,17 @@ int main(int argc, const char *argv[]) {
   cmd.register_option(db_path, rnd_seed);
   cmd.register_option(mc_outer_cycles, mc_inner_cycles, mc_cycle_factor, random_jump_range, random_n_jump_range,
     random_n_jump_len);
-  cmd.register_option(input_pdb, input_pdb_native, input_ss2);  // Input options
-  cmd.register_option(output_pdb, output_pdb_min, output_pdb_min_fraction, output_pdb_min_value); // output options
+  cmd.register_option(input_pdb, input_pdb_native, input_ss2, input_restraints, input_cache);  // Input options
+  cmd.register_option(restraints_weight, restraints_shape, restraints_constant); // Scoring options
+  cmd.register_option(output_pdb, output_pdb_min, output_pdb_min_fraction, output_pdb_min_value, output_pdb_min_archive); // output options
+  cmd.register_option(output_pymol, output_pymol_fps);
   cmd.register_option(begin_temperature, end_temperature, temp_steps, replicas, replica_observation_mode, replica_exchanges);
+  cmd.register_option(annealing_adaptive, annealing_schedule);
+  cmd.register_option(umbrella_cv, umbrella_centers, umbrella_k, umbrella_flat, umbrella_no_exchange, umbrella_bins, n_threads);
+  cmd.register_option(metad_cv, metad_grid, metad_sigma, metad_height, metad_bias_factor, metad_stride, metad_restart);
+  cmd.register_option(portfolio_runs, portfolio_keep, portfolio_stages, portfolio_score, portfolio_clone);
+  cmd.register_option(replica_lockstep, output_perf, surrogate_terms, adaptive_movers, reservoir_in, reservoir_out);
+  cmd.register_option(perm_tours, perm_temperature, nested_live, nested_dead, nested_walk, nested_prior_t);
 
   if (!cmd.parse_cmdline(argc, argv)) return 1;
 
@@ -357,18 +940,36 @@ int main(int argc, const char *argv[]) {
   // --- Prepare the scoring function config
   simulations::forcefields::ForceFieldConfig scfx(utils::load_text_file(core::SURPASSenvironment::from_file_or_db("surpass.wghts", "forcefield")));
   scfx.input_ss2(input_ss2_file);
+  if (input_restraints.was_used())
+    scfx.add_line("SurpassDistanceRestraints " + option_value<std::string>(restraints_weight, "1.0") + " " +
+      option_value<std::string>(input_restraints) + " " + option_value<std::string>(restraints_shape, "flat") + " " +
+      option_value<std::string>(restraints_constant, "1.0"));
 
   // --- Create the sampler user requested
-  if(replicas.was_used()) {
+  if(umbrella_cv.was_used()) {
+    std::vector<core::real> centers;
+    utils::split(option_value<std::string>(umbrella_centers), centers, ',');
+    std::vector<core::data::structural::Structure_SP> starts = starting_structures(ss2_aa, scfx, centers.size());
+    run_umbrella(starts, scfx, centers);
+  } else if(metad_cv.was_used()) {
+    run_metadynamics(starting_structures(ss2_aa, scfx, 1)[0], scfx);
+  } else if(nested_live.was_used()) {
+    run_nested(starting_structures(ss2_aa, scfx, 1)[0], scfx);
+  } else if(portfolio_runs.was_used()) {
+    core::index2 n_runs = option_value<core::index2>(portfolio_runs);
+    std::vector<core::data::structural::Structure_SP> starts = starting_structures(ss2_aa, scfx, n_runs);
+    run_portfolio(starts, scfx);
+  } else if(replicas.was_used()) {
     std::vector<core::real> temperatures;
     utils::split(option_value<std::string>(replicas),temperatures,',');
-    std::vector<core::data::structural::Structure_SP> starts = starting_structures(ss2_aa, temperatures.size());
+    std::vector<core::data::structural::Structure_SP> starts = starting_structures(ss2_aa, scfx, temperatures.size());
     logs << utils::LogLevel::INFO << "Replica temperatures";
     for (core::real t : temperatures) logs << " " << t;
     logs << "\n";
-    run_replicas(starts,scfx,temperatures);
+    if (replica_lockstep.was_used()) run_lockstep(starts, scfx, temperatures);
+    else run_replicas(starts,scfx,temperatures);
   } else {
-    core::data::structural::Structure_SP starting_structure = starting_structures(ss2_aa, 1)[0];
+    core::data::structural::Structure_SP starting_structure = starting_structures(ss2_aa, scfx, 1)[0];
     run_annealing(starting_structure, scfx);
   }
 
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <fstream>
+#include <future>
+#include <map>
+#include <regex>
+#include <sstream>
+
+#include <utils/io_utils.hh>
+#include <utils/string_utils.hh>
+#include <utils/ThreadPool.hh>
+#include <utils/LogManager.hh>
+#include <utils/options/Option.hh>
+#include <utils/options/OptionParser.hh>
+#include <utils/options/input_options.hh>
+
+#include <simulations/sampling/ReplicaExchangeMC.hh>
+
+utils::Logger logs("surpass_demux");
+
+/// Output of all replicas of a single observer, e.g. tra-r0.pdb, tra-r1.pdb, ...
+struct ReplicaFiles {
+  std::string prefix; ///< e.g. "tra"
+  std::string extension; ///< e.g. ".pdb"
+  std::map<core::index2, std::string> files; ///< file name for every replica index
+};
+
+/** @brief Splits outputs of a single observer into per-temperature files.
+ *
+ * All replica files are read together, one exchange cycle at a time, so the blocks written to every
+ * temperature file remain in the order of exchange cycles.
+ * @return the number of exchange cycles
+ */
+core::index4 demux(const ReplicaFiles &group) {
+
+  const std::string &tag = simulations::sampling::ReplicaExchangeMC::demux_tag;
+  std::vector<std::unique_ptr<std::ifstream>> in;
+  std::vector<std::string> next_line; // --- a tag line that opens the next block of every file
+  std::string header, line;
+  for (const auto &f : group.files) {
+    in.emplace_back(new std::ifstream(f.second));
+    if (!*in.back()) throw std::runtime_error("Can't open a replica output file: " + f.second + "\n");
+    // --- Lines preceding the first tag (a header) are copied to every output file
+    std::string h;
+    while (std::getline(*in.back(), line) && (line.compare(0, tag.size(), tag) != 0)) h += line + "\n";
+    if (in.size() == 1) header = h;
+    next_line.push_back((line.compare(0, tag.size(), tag) == 0) ? line : "");
+  }
+
+  std::map<core::index2, std::shared_ptr<std::ofstream>> out;
+  core::index4 n_cycles = 0;
+  bool any_block = true;
+  while (any_block) {
+    any_block = false;
+    for (core::index2 i = 0; i < in.size(); ++i) {
+      if (next_line[i].empty()) continue;
+      any_block = true;
+      // --- Tag: #REMC exchange <e> replica <r> temperature_index <t> temperature <T>
+      std::istringstream tokens(next_line[i].substr(tag.size()));
+      std::string key;
+      core::index4 exchange = 0, replica = 0, t_index = 0;
+      core::real temperature = 0.0;
+      tokens >> key >> exchange >> key >> replica >> key >> t_index >> key >> temperature;
+      if (exchange != n_cycles)
+        logs << utils::LogLevel::WARNING << "replica " << size_t(replica) << " of " << group.prefix << " is at exchange "
+             << size_t(exchange) << " while " << size_t(n_cycles) << " expected\n";
+      auto it = out.find(t_index);
+      if (it == out.end()) {
+        const std::string fname = utils::string_format("%s-%.3f%s", group.prefix.c_str(), temperature,
+                                                       group.extension.c_str());
+        it = out.insert(std::make_pair(t_index, std::make_shared<std::ofstream>(fname))).first;
+        *(it->second) << header;
+      }
+      next_line[i].clear();
+      while (std::getline(*in[i], line)) {
+        if (line.compare(0, tag.size(), tag) == 0) {
+          next_line[i] = line;
+          break;
+        }
+        *(it->second) << line << "\n";
+      }
+    }
+    if (any_block) ++n_cycles;
+  }
+  return n_cycles;
+}
+
+/** @brief Splits output files written by REMC simulation in DEMUX observation mode into isothermal files.
+ *
+ * In DEMUX mode every replica writes its own files (tra-r0.pdb, energy-r0.dat, ...), where each exchange cycle is
+ * preceded by a tag line giving the temperature the replica was at. This program collects all the files of a given
+ * kind and writes the observations made at each temperature into a separate file, named in the same way as
+ * in ISOTHERMAL mode (tra-1.500.pdb, energy-1.500.dat, ...). Files of different kinds are processed in parallel.
+ *
+ * Usage: surpass_demux -in:file="tra-r*.pdb,energy-r*.dat"
+ */
+int main(int argc, const char *argv[]) {
+
+  utils::LogManager::INFO();
+
+  using namespace utils::options; // --- All the options are in this namespace
+
+  utils::options::OptionParser &cmd = utils::options::OptionParser::get();
+  cmd.register_option(utils::options::help, verbose, input_file, n_threads);
+
+  if (!cmd.parse_cmdline(argc, argv)) return 1;
+
+  if (!input_file.was_used()) {
+    logs << utils::LogLevel::SEVERE << "Replica output files must be provided with -in:file option, e.g. -in:file=\"tra-r*.pdb\"\n";
+    return 0;
+  }
+
+  // --- Group files by their kind; a replica file is named <prefix>-r<replica_index><extension>
+  std::vector<std::string> masks;
+  utils::split(option_value<std::string>(input_file), masks, ',');
+  std::map<std::string, ReplicaFiles> groups;
+  const std::regex name_pattern("(.*)-r([0-9]+)(\\.[^.]*)?");
+  for (const std::string &mask : masks) {
+    for (const std::string &f : utils::glob(mask)) {
+      std::smatch m;
+      if (!std::regex_match(f, m, name_pattern)) {
+        logs << utils::LogLevel::WARNING << "file " << f << " is not a replica output; skipped\n";
+        continue;
+      }
+      ReplicaFiles &g = groups[m[1].str() + m[3].str()];
+      g.prefix = m[1].str();
+      g.extension = m[3].str();
+      g.files[utils::from_string<core::index2>(m[2].str())] = f;
+    }
+  }
+
+  utils::ThreadPool pool(option_value<core::index2>(n_threads, 0));
+  std::vector<std::future<void>> jobs;
+  for (const auto &g : groups) {
+    const ReplicaFiles *group = &g.second;
+    jobs.push_back(pool.submit([group]() {
+      core::index4 n = demux(*group);
+      logs << utils::LogLevel::INFO << group->prefix << group->extension << ": " << group->files.size()
+           << " replicas, " << size_t(n) << " exchange cycles\n";
+    }));
+  }
+  for (auto &j : jobs) j.get();
+}
@@ -0,0 +1,267 @@
+#include <iostream>
+#include <fstream>
+#include <future>
+#include <functional>
+
+#include <core/SURPASSenvironment.hh>
+#include <core/data/basic/Vec3.hh>
+#include <core/data/io/ss2_io.hh>
+#include <core/data/io/Pdb.hh>
+#include <core/data/sequence/SecondaryStructure.hh>
+#include <core/data/structural/Structure.hh>
+#include <core/calc/structural/TMScore.hh>
+
+#include <simulations/systems/surpass/SurpassModel.hh>
+#include <simulations/forcefields/TotalEnergyByResidue.hh>
+#include <simulations/forcefields/ForceFieldConfig.hh>
+#include <simulations/forcefields/surpass/surpass_force_field_factory.hh>
+#include <simulations/forcefields/surpass/SurpassThreading.hh>
+#include <simulations/representations/surpass_utils.hh>
+
+#include <utils/io_utils.hh>
+#include <utils/string_utils.hh>
+#include <utils/ThreadPool.hh>
+#include <utils/LogManager.hh>
+#include <utils/options/Option.hh>
+#include <utils/options/OptionParser.hh>
+#include <utils/options/input_options.hh>
+#include <utils/options/output_options.hh>
+#include <utils/options/scoring_options.hh>
+
+utils::Logger logs("surpass_score");
+
+using core::data::basic::Vec3;
+using simulations::systems::surpass::SurpassModel;
+using simulations::forcefields::TotalEnergyByResidue;
+
+/// A single model to be scored: its name and PDB records
+struct Decoy {
+  std::string name;
+  std::string pdb_text;
+};
+
+/** @brief Splits a PDB file into models while reading it.
+ *
+ * Every MODEL - ENDMDL block becomes a separate decoy; a file without MODEL records holds a single decoy.
+ * Whenever the batch reaches <code>batch_size</code> decoys, <code>score_batch</code> is called, so a large
+ * multi-model file is never held in memory as a whole.
+ * @param fname - input PDB file
+ * @param decoys - batch the decoys are appended to; <code>score_batch</code> is expected to empty it
+ * @param batch_size - the number of decoys that triggers scoring
+ * @param score_batch - scores the decoys collected so far
+ */
+void split_models(const std::string &fname, std::vector<Decoy> &decoys, const core::index4 batch_size,
+                  const std::function<void()> &score_batch) {
+
+  std::ifstream in(fname);
+  if (!in) throw std::runtime_error("Can't open a PDB file: " + fname + "\n");
+  std::string line, block;
+  core::index4 n_models = 0;
+  const std::string name = utils::basename(fname);
+  while (std::getline(in, line)) {
+    if (line.compare(0, 6, "ENDMDL") == 0) {
+      ++n_models;
+      if (!block.empty()) decoys.push_back({utils::string_format("%s:%d", name.c_str(), n_models), block});
+      block.clear();
+      if (decoys.size() >= batch_size) score_batch();
+    } else if ((line.compare(0, 4, "ATOM") == 0) || (line.compare(0, 6, "HETATM") == 0)) {
+      block += line;
+      block += '\n';
+    }
+  }
+  if (!block.empty())
+    decoys.push_back({(n_models == 0) ? name : utils::string_format("%s:%d", name.c_str(), n_models + 1), block});
+}
+
+/** @brief Scores models with the SURPASS force field.
+ *
+ * Models are read from multi-model PDB files or from all PDB files found in a directory. Each of them is converted
+ * into the SURPASS representation directly from its CA atoms (no Structure objects are created) and
+ * all the energy terms are evaluated. Decoys are scored in batches on a pool of threads, each thread holding its own
+ * copy of the system and the force field. The first model defines the chain and its secondary structure,
+ * all the remaining ones must have the same number of residues.
+ *
+ * When a list of SS2 files is given with -in:ss2:listfile, the program works in the threading mode: every decoy is scored
+ * with every secondary structure profile from that list (see SurpassThreading). The geometry of a decoy is tabulated
+ * once, therefore scanning thousands of profiles takes only a fraction of the time needed to score them from scratch.
+ *
+ * When a native structure is given with -in:pdb:native, TM-score and GDT_TS of every decoy are reported as well.
+ */
+int main(int argc, const char *argv[]) {
+
+  utils::LogManager::INFO();
+
+  using namespace utils::options; // --- All the options are in this namespace
+  using namespace simulations::forcefields;
+  using namespace simulations::forcefields::surpass;
+
+  const core::index4 batch_size = 1024;
+
+  utils::options::OptionParser &cmd = utils::options::OptionParser::get();
+  cmd.register_option(utils::options::help, verbose, db_path, n_threads);
+  cmd.register_option(input_pdb, input_pdb_path, input_pdb_list, input_ss2, input_restraints);
+  cmd.register_option(restraints_weight, restraints_shape, restraints_constant, output_file, input_ss2_list);
+  cmd.register_option(input_pdb_native);
+
+  if (!cmd.parse_cmdline(argc, argv)) return 1;
+
+  if (!input_ss2.was_used()) {
+    logs << utils::LogLevel::SEVERE << "All-atom secondary structure must be provided with -in:ss2 command line option\n";
+    return 0;
+  }
+
+  // --- Collect input files
+  std::vector<std::string> files;
+  if (input_pdb.was_used()) utils::split(option_value<std::string>(input_pdb), files, ',');
+  if (input_pdb_list.was_used()) utils::read_listfile(option_value<std::string>(input_pdb_list), files);
+  if (input_pdb_path.was_used()) {
+    for (const std::string &f : utils::glob(utils::join_paths(option_value<std::string>(input_pdb_path), "*.pdb")))
+      files.push_back(f);
+  }
+  if (files.empty()) {
+    logs << utils::LogLevel::SEVERE << "No models to score; use -in:pdb, -in:pdb:path or -in:pdb:listfile\n";
+    return 0;
+  }
+
+  // --- Read the input secondary structure and prepare the scoring function config
+  std::string input_ss2_file = option_value<std::string>(input_ss2);
+  core::data::sequence::SecondaryStructure_SP ss2_aa = core::data::io::read_ss2(input_ss2_file);
+  simulations::forcefields::ForceFieldConfig scfx(utils::load_text_file(core::SURPASSenvironment::from_file_or_db("surpass.wghts", "forcefield")));
+  scfx.input_ss2(input_ss2_file);
+  if (input_restraints.was_used())
+    scfx.add_line("SurpassDistanceRestraints " + option_value<std::string>(restraints_weight, "1.0") + " " +
+      option_value<std::string>(input_restraints) + " " + option_value<std::string>(restraints_shape, "flat") + " " +
+      option_value<std::string>(restraints_constant, "1.0"));
+
+  // --- Profiles for the threading mode
+  std::vector<std::string> profile_files;
+  std::vector<core::data::sequence::SecondaryStructure_SP> profiles;
+  if (input_ss2_list.was_used()) {
+    utils::read_listfile(option_value<std::string>(input_ss2_list), profile_files);
+    for (const std::string &f : profile_files) profiles.push_back(core::data::io::read_ss2(f, ""));
+    logs << utils::LogLevel::INFO << profiles.size() << " secondary structure profiles loaded for threading\n";
+  }
+
+  // --- The first model defines the system; it goes through the regular (slow) path
+  core::data::io::Pdb reader(files[0], core::data::io::is_not_alternative, true);
+  core::data::structural::Structure_SP templ = reader.create_structure(0);
+  if (!simulations::representations::is_surpass_model(*templ)) {
+    core::index2 res_cnt = 0;
+    for (auto res_it = templ->first_residue(); res_it != templ->last_residue(); ++res_it)
+      (*res_it)->ss(ss2_aa->ss(res_cnt++));
+    templ = simulations::representations::surpass_representation(*templ);
+  }
+
+  // --- Native structure in SURPASS representation, for TM-score and GDT_TS columns
+  std::vector<Vec3> native_beads;
+  if (input_pdb_native.was_used()) {
+    core::data::io::Pdb native_reader(option_value<std::string>(input_pdb_native), core::data::io::is_not_alternative, true);
+    core::data::structural::Structure_SP native = native_reader.create_structure(0);
+    if (!simulations::representations::is_surpass_model(*native))
+      native = simulations::representations::surpass_representation(*native);
+    for (auto it = native->first_const_atom(); it != native->last_const_atom(); ++it) native_beads.push_back(**it);
+  }
+
+  // --- Every thread scores decoys on its own system, because energy terms are bound to a system they evaluate
+  utils::ThreadPool pool(option_value<core::index2>(n_threads, 0));
+  std::vector<std::shared_ptr<SurpassModel<Vec3>>> systems;
+  std::vector<std::shared_ptr<TotalEnergyByResidue>> energies;
+  std::vector<std::vector<std::shared_ptr<SurpassContactEnergy<Vec3>>>> contacts(pool.size());
+  for (core::index2 w = 0; w < pool.size(); ++w) {
+    systems.push_back(std::make_shared<SurpassModel<Vec3>>(*templ));
+    energies.push_back(create_surpass_energy<Vec3>(*systems.back(), ss2_aa, scfx.str()));
+    for (core::index2 i = 0; i < energies.back()->count_components(); ++i) {
+      auto c = std::dynamic_pointer_cast<SurpassContactEnergy<Vec3>>(energies.back()->get_component(i));
+      if (c != nullptr) contacts[w].push_back(c);
+    }
+  }
+  const core::index4 n_beads = systems[0]->count_residues();
+  const core::index2 n_terms = energies[0]->count_components();
+  logs << utils::LogLevel::INFO << "scoring models of " << size_t(n_beads) << " beads on " << pool.size()
+       << " threads\n";
+  if ((!native_beads.empty()) && (native_beads.size() != n_beads)) {
+    logs << utils::LogLevel::SEVERE << "Native structure has " << native_beads.size() << " beads while models have "
+         << size_t(n_beads) << "\n";
+    return 0;
+  }
+
+  // --- Output table
+  std::shared_ptr<std::ostream> out_sp;
+  if (output_file.was_used()) out_sp = utils::out_stream(option_value<std::string>(output_file));
+  std::ostream &out = (out_sp) ? *out_sp : std::cout;
+  out << ((profiles.empty()) ? "#decoy" : "#decoy profile");
+  for (core::index2 i = 0; i < n_terms; ++i) out << ' ' << energies[0]->get_component(i)->name();
+  out << ((native_beads.empty()) ? " total\n" : " total TM-score GDT_TS\n");
+
+  std::vector<Decoy> batch;
+  std::vector<std::string> rows;
+  std::vector<char> is_scored;
+  core::index4 n_scored = 0, n_skipped = 0;
+  auto score_batch = [&]() {
+    rows.assign(batch.size(), "");
+    is_scored.assign(batch.size(), false);
+    std::vector<std::future<void>> jobs;
+    for (core::index2 w = 0; w < pool.size(); ++w) {
+      jobs.push_back(pool.submit([&, w]() {
+        std::vector<Vec3> beads;
+        std::vector<double> scores(n_terms);
+        SurpassModel<Vec3> &system = *systems[w];
+        std::unique_ptr<SurpassThreading<Vec3>> threading;
+        if (!profiles.empty()) threading.reset(new SurpassThreading<Vec3>(*energies[w]));
+        std::unique_ptr<core::calc::structural::TMScore> tm;
+        if (!native_beads.empty()) tm.reset(new core::calc::structural::TMScore(native_beads));
+        for (core::index4 k = w; k < batch.size(); k += pool.size()) {
+          if (simulations::representations::surpass_beads_from_pdb(batch[k].pdb_text, beads) != n_beads) continue;
+          for (core::index4 i = 0; i < n_beads; ++i) system.coordinates[i].set(beads[i]);
+          for (auto &c : contacts[w]) c->update_sheets();
+          std::string similarity = "\n";
+          if (tm) {
+            tm->calculate(beads);
+            similarity = utils::string_format(" %.3f %.3f\n", tm->tm_score(), tm->gdt_ts());
+          }
+          if (threading) {
+            threading->update();
+            for (core::index4 p = 0; p < profiles.size(); ++p) {
+              const double total = threading->score(*profiles[p], scores);
+              rows[k] += batch[k].name + " " + utils::basename(profile_files[p]);
+              for (double e : scores) rows[k] += utils::string_format(" %.3f", e);
+              rows[k] += utils::string_format(" %.3f", total) + similarity;
+            }
+          } else {
+            double total = 0.0;
+            rows[k] = batch[k].name;
+            for (core::index2 i = 0; i < n_terms; ++i) {
+              scores[i] = energies[w]->calculate_component(i) * energies[w]->get_factors()[i];
+              rows[k] += utils::string_format(" %.3f", scores[i]);
+              total += scores[i];
+            }
+            rows[k] += utils::string_format(" %.3f", total) + similarity;
+          }
+          is_scored[k] = true;
+        }
+      }));
+    }
+    for (auto &j : jobs) j.get();
+    for (core::index4 k = 0; k < batch.size(); ++k) {
+      if (!is_scored[k]) {
+        logs << utils::LogLevel::WARNING << "decoy " << batch[k].name << " skipped: number of beads differs from "
+             << size_t(n_beads) << "\n";
+        ++n_skipped;
+        continue;
+      }
+      out << rows[k];
+      ++n_scored;
+    }
+    batch.clear();
+  };
+
+  // --- Stream models file by file, scoring them in batches as soon as a batch is full
+  for (const std::string &f : files) {
+    split_models(f, batch, batch_size, score_batch);
+    if (batch.size() >= batch_size) score_batch();
+  }
+  if (!batch.empty()) score_batch();
+  out.flush();
+
+  logs << utils::LogLevel::INFO << size_t(n_scored) << " decoys scored, " << size_t(n_skipped) << " skipped\n";
+}
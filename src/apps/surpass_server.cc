@@ -0,0 +1,43 @@
+#include <iostream>
+
+#include <utils/LogManager.hh>
+#include <utils/options/Option.hh>
+#include <utils/options/OptionParser.hh>
+#include <utils/options/input_options.hh>
+#include <utils/options/sampling_options.hh>
+
+#include <core/calc/statistics/Random.hh>
+#include <simulations/api/JobServer.hh>
+
+utils::Logger logs("surpass_server");
+
+/** @brief Runs SURPASS simulations submitted through a Unix domain socket.
+ *
+ * The server loads the force field once and keeps it in memory, so every job is charged only for its own sampling.
+ * See simulations::api::JobServer for the protocol. A job may be submitted e.g. with <code>socat</code>:
+ *
+ * <code>(cat job.txt; sleep 60) | socat - UNIX-CONNECT:/tmp/surpass.sock</code>
+ *
+ * Usage: surpass_server -in:socket=/tmp/surpass.sock -in:database=./data -n_threads=4 [-sample:seed=1]
+ */
+int main(int argc, const char *argv[]) {
+
+  utils::LogManager::INFO();
+
+  using namespace utils::options; // --- All the options are in this namespace
+
+  utils::options::OptionParser &cmd = utils::options::OptionParser::get();
+  cmd.register_option(utils::options::help, verbose, db_path, n_threads, input_socket, rnd_seed);
+
+  if (!cmd.parse_cmdline(argc, argv)) return 1;
+
+  if (!input_socket.was_used()) {
+    logs << utils::LogLevel::SEVERE << "Socket file name must be provided with -in:socket option\n";
+    return 0;
+  }
+  if (rnd_seed.was_used())
+    core::calc::statistics::Random::seed(option_value<core::calc::statistics::Random::result_type>(rnd_seed));
+
+  simulations::api::JobServer server(option_value<std::string>(input_socket), option_value<core::index2>(n_threads, 0));
+  server.serve();
+}
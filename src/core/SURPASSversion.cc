@@ -4,9 +4,9 @@
 
 namespace core {
 
-const std::string SURPASSversion::GIT_HASH = "d81726d2747d5446bbe3b48f464f5b199f0e3ed1";
-const std::string SURPASSversion::GIT_TIMESTAMP = "2024-01-29 06:10:25";
-const std::string SURPASSversion::GIT_BRANCH = "surpass";
+const std::string SURPASSversion::GIT_HASH = "92d70e9fb5e7f0e96a5d0a57cfd6265a4b7cbc21";
+const std::string SURPASSversion::GIT_TIMESTAMP = "2026-10-18 14:18:11";
+const std::string SURPASSversion::GIT_BRANCH = "master";
 
 std::string SURPASSversion::to_string() {
 
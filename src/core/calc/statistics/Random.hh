@@ -20,6 +20,14 @@ public :
   /// type of values returned by this random generator engine
   typedef std::mt19937_64::result_type result_type;
 
+  /// Creates an independent engine with the default seed; most of the code should use the singleton returned by <code>get()</code>
+  Random() {}
+
+  /** @brief Creates an independent engine, e.g. to provide a separate random stream for each of concurrent simulations.
+   * @param seed - seed for this engine
+   */
+  explicit Random(const result_type seed) : generator(seed) {}
+
   /// Returns the reference to the engine singleton
   static Random &get() {
     static Random instance;
@@ -23,9 +23,11 @@ public:
    *
    * @param source - data to be iterated in a random order
    * @param sequence_size - how long should the sequence be? It might be actually longer or shorter than <code>source.size()</code>
+   * @param generator - random engine used to draw the sequence
    */
-  static RandomSequenceIterator<T> begin(const std::vector<T> &source, int sequence_size) {
-    return RandomSequenceIterator(source, sequence_size);
+  static RandomSequenceIterator<T> begin(const std::vector<T> &source, int sequence_size,
+                                         Random &generator = Random::get()) {
+    return RandomSequenceIterator(source, sequence_size, generator);
   }
 
   /// Provides the <code>end</code> iterator
@@ -38,7 +40,7 @@ public:
   RandomSequenceIterator<T> operator++() {
     if (sequence_size_ == 0) return *this;
     --sequence_size_;
-    which_element_ = generator() % source_->size();
+    which_element_ = (*generator)() % source_->size();
     return *this;
   }
 
@@ -62,14 +64,14 @@ private:
   const std::vector<T> *source_;
   int sequence_size_;
   index2 which_element_;
-  core::calc::statistics::Random &generator = core::calc::statistics::Random::get();
+  core::calc::statistics::Random *generator = &core::calc::statistics::Random::get();
 
   //Creates "end" iterator
   RandomSequenceIterator() : source_(nullptr), sequence_size_(0) {}
 
   //Creates random "start" iterator
-  RandomSequenceIterator(const std::vector<T> &source, index4 nOutputCount) :
-    source_(&source), sequence_size_(nOutputCount + 1), m_distribution(0, source.size() - 1) {
+  RandomSequenceIterator(const std::vector<T> &source, index4 nOutputCount, Random &rng) :
+    source_(&source), sequence_size_(nOutputCount + 1), generator(&rng), m_distribution(0, source.size() - 1) {
     operator++(); //make new random value
   }
 
@@ -0,0 +1,121 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <core/calc/statistics/Wham.hh>
+
+namespace core {
+namespace calc {
+namespace statistics {
+
+static const double minus_infinity = -std::numeric_limits<double>::infinity();
+
+/// log(sum(exp(v))) that does not overflow nor underflow
+static double log_sum_exp(const std::vector<double> &v) {
+
+  double max_v = minus_infinity;
+  for (double e : v) max_v = std::max(max_v, e);
+  if (max_v == minus_infinity) return minus_infinity;
+  double s = 0.0;
+  for (double e : v) s += exp(e - max_v);
+  return max_v + log(s);
+}
+
+Wham::Wham(const core::real x_min, const core::real x_max, const core::index2 n_bins, const core::real temperature) :
+  x_min_(x_min), width_((x_max - x_min) / n_bins), n_bins_(n_bins), beta(1.0 / temperature),
+  total_counts(n_bins, 0.0), log_p(n_bins, minus_infinity), logger("Wham") {}
+
+void Wham::add_window(const std::vector<core::real> &samples, const std::function<double(double)> &bias) {
+
+  counts.emplace_back(n_bins_, 0);
+  beta_bias.emplace_back(n_bins_, 0.0);
+  double n = 0;
+  for (core::real s : samples) {
+    if (s < x_min_) continue;
+    core::index4 b = core::index4((s - x_min_) / width_);
+    if (b >= n_bins_) continue;
+    ++counts.back()[b];
+    ++total_counts[b];
+    ++n;
+  }
+  n_samples.push_back(n);
+  for (core::index2 b = 0; b < n_bins_; ++b) beta_bias.back()[b] = beta * bias(x(b));
+  f_.push_back(0.0);
+  logger << utils::LogLevel::FINE << "window " << counts.size() - 1 << " : " << n << " of " << samples.size()
+         << " samples within the histogram range\n";
+}
+
+core::index4 Wham::solve(utils::ThreadPool *pool, const core::index4 max_iterations, const double tolerance) {
+
+  const core::index2 n_windows = counts.size();
+  std::vector<double> new_f(n_windows, 0.0);
+
+  // --- ln P(b) from the current window free energies
+  auto update_bin = [&](core::index4 b) {
+    if (total_counts[b] == 0) {
+      log_p[b] = minus_infinity;
+      return;
+    }
+    std::vector<double> terms(n_windows, minus_infinity);
+    for (core::index2 i = 0; i < n_windows; ++i)
+      if (n_samples[i] > 0) terms[i] = log(n_samples[i]) - beta_bias[i][b] + f_[i];
+    log_p[b] = log(total_counts[b]) - log_sum_exp(terms);
+  };
+  // --- beta * F_i from the current ln P(b)
+  auto update_window = [&](core::index4 i) {
+    std::vector<double> terms(n_bins_);
+    for (core::index2 b = 0; b < n_bins_; ++b) terms[b] = log_p[b] - beta_bias[i][b];
+    new_f[i] = -log_sum_exp(terms);
+  };
+
+  core::index4 iter = 0;
+  double max_change = 0.0;
+  while (iter < max_iterations) {
+    ++iter;
+    if (pool != nullptr) {
+      pool->parallel_for(0, n_bins_, update_bin);
+      pool->parallel_for(0, n_windows, update_window);
+    } else {
+      for (core::index4 b = 0; b < n_bins_; ++b) update_bin(b);
+      for (core::index4 i = 0; i < n_windows; ++i) update_window(i);
+    }
+    max_change = 0.0;
+    const double f0 = new_f[0];
+    for (core::index2 i = 0; i < n_windows; ++i) {
+      new_f[i] -= f0;
+      if (std::isfinite(new_f[i])) max_change = std::max(max_change, fabs(new_f[i] - f_[i]));
+      f_[i] = new_f[i];
+    }
+    if (max_change < tolerance) break;
+  }
+  for (core::index4 b = 0; b < n_bins_; ++b) update_bin(b);
+
+  if (max_change < tolerance)
+    logger << utils::LogLevel::INFO << "WHAM converged after " << size_t(iter) << " iterations\n";
+  else
+    logger << utils::LogLevel::WARNING << "WHAM did not converge after " << size_t(iter) << " iterations, last change: "
+           << max_change << "\n";
+
+  return iter;
+}
+
+std::vector<double> Wham::probabilities() const {
+
+  double log_norm = log_sum_exp(log_p);
+  std::vector<double> out(n_bins_);
+  for (core::index2 b = 0; b < n_bins_; ++b) out[b] = exp(log_p[b] - log_norm);
+  return out;
+}
+
+std::vector<double> Wham::pmf() const {
+
+  double max_log_p = *std::max_element(log_p.begin(), log_p.end());
+  std::vector<double> out(n_bins_);
+  for (core::index2 b = 0; b < n_bins_; ++b)
+    out[b] = (log_p[b] == minus_infinity) ? std::numeric_limits<double>::infinity() : (max_log_p - log_p[b]) / beta;
+  return out;
+}
+
+} // ~ statistics
+} // ~ calc
+} // ~ core
@@ -0,0 +1,106 @@
+/** @file Wham.hh
+ * @brief Provides Wham class that combines biased histograms into an unbiased free energy profile
+ */
+#ifndef CORE_CALC_STATISTICS_Wham_HH
+#define CORE_CALC_STATISTICS_Wham_HH
+
+#include <vector>
+#include <functional>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <utils/Logger.hh>
+#include <utils/ThreadPool.hh>
+
+namespace core {
+namespace calc {
+namespace statistics {
+
+/** @brief Weighted Histogram Analysis Method (WHAM) for a one-dimensional reaction coordinate.
+ *
+ * Each window \f$ i \f$ provides samples of a coordinate \f$ x \f$ collected under a bias \f$ U_i(x) \f$.
+ * The WHAM equations:
+ * \f[
+ *    P(b) = \frac{\sum_i n_i(b)}{\sum_i N_i e^{-\beta (U_i(b) - F_i)}} \qquad e^{-\beta F_i} = \sum_b P(b) e^{-\beta U_i(b)}
+ * \f]
+ * are iterated until free energies \f$ F_i \f$ of windows converge. All the sums are evaluated in logarithmic scale,
+ * so strong biases do not underflow. Both steps of an iteration may be distributed on a thread pool: over bins
+ * and over windows, respectively.
+ *
+ * @code
+ * Wham wham(0.0, 20.0, 100, temperature);
+ * for (size_t i = 0; i < samples.size(); ++i) wham.add_window(samples[i], [&](double x) { return biases[i]->bias(x); });
+ * wham.solve();
+ * std::vector<double> f = wham.pmf();
+ * @endcode
+ */
+class Wham {
+public:
+
+  /** @brief Prepares an empty WHAM calculation.
+   *
+   * @param x_min - lower bound of the histogram range
+   * @param x_max - upper bound of the histogram range
+   * @param n_bins - the number of histogram bins
+   * @param temperature - temperature of the simulation
+   */
+  Wham(const core::real x_min, const core::real x_max, const core::index2 n_bins, const core::real temperature);
+
+  /** @brief Adds a window: its samples and the bias potential they were collected with.
+   *
+   * Samples outside the histogram range are discarded.
+   * @param samples - values of the coordinate observed in the window
+   * @param bias - bias potential of the window, as a function of the coordinate
+   */
+  void add_window(const std::vector<core::real> &samples, const std::function<double(double)> &bias);
+
+  /** @brief Iterates WHAM equations until convergence.
+   *
+   * @param pool - thread pool to use; if <code>nullptr</code>, the calculations are serial
+   * @param max_iterations - maximum number of iterations
+   * @param tolerance - iterations stop when no window free energy changes more than that (in kT units)
+   * @return the number of iterations done
+   */
+  core::index4 solve(utils::ThreadPool *pool = nullptr, const core::index4 max_iterations = 100000,
+                     const double tolerance = 1.0e-7);
+
+  /// Returns the number of windows
+  core::index2 count_windows() const { return counts.size(); }
+
+  /// Returns the number of bins
+  core::index2 count_bins() const { return n_bins_; }
+
+  /// Returns the middle of a given bin
+  core::real x(const core::index2 bin) const { return x_min_ + (bin + 0.5) * width_; }
+
+  /// Free energies of windows (\f$ F_0 = 0 \f$), available after <code>solve()</code>
+  const std::vector<double> &window_free_energies() const { return f_; }
+
+  /// Unbiased probability of each bin, available after <code>solve()</code>
+  std::vector<double> probabilities() const;
+
+  /** @brief Potential of mean force \f$ -k_BT \ln P(b) \f$, shifted so its minimum is zero.
+   *
+   * Empty bins get <code>std::numeric_limits<double>::infinity()</code>
+   */
+  std::vector<double> pmf() const;
+
+private:
+  const core::real x_min_;
+  const core::real width_;
+  const core::index2 n_bins_;
+  const double beta;
+  std::vector<std::vector<core::index4>> counts; ///< counts[window][bin]
+  std::vector<std::vector<double>> beta_bias; ///< beta * U_i(x_b) for every window i and bin b
+  std::vector<double> n_samples; ///< N_i
+  std::vector<double> total_counts; ///< sum over windows n_i(b)
+  std::vector<double> f_; ///< beta * F_i
+  std::vector<double> log_p; ///< ln P(b)
+  utils::Logger logger;
+};
+
+} // ~ statistics
+} // ~ calc
+} // ~ core
+
+#endif
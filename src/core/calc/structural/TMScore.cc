@@ -0,0 +1,115 @@
+#include <cmath>
+#include <algorithm>
+
+#include <core/calc/structural/TMScore.hh>
+
+namespace core {
+namespace calc {
+namespace structural {
+
+TMScore::TMScore(const std::vector<core::data::basic::Vec3> &reference) :
+  n(reference.size()), rx(n), ry(n), rz(n), mx(n), my(n), mz(n), d2(n) {
+
+  d0_ = (n > 21) ? 1.24 * cbrt(n - 15.0) - 1.8 : 0.5;
+  d0_ = std::max(d0_, core::real(0.5));
+  d0_search = std::min(std::max(d0_, core::real(4.5)), core::real(8.0));
+  for (core::index4 i = 0; i < n; ++i) {
+    rx[i] = reference[i].x;
+    ry[i] = reference[i].y;
+    rz[i] = reference[i].z;
+  }
+}
+
+void TMScore::search() {
+
+  tm_score_ = 0.0;
+  for (core::index4 &g : best_gdt) g = 0;
+  if (n < 3) return;
+
+  for (core::index4 seed_len = n; seed_len >= 3; seed_len /= 2) {
+    const core::index4 step = std::max(core::index4(1), seed_len / 2);
+    for (core::index4 start = 0; start + seed_len <= n; start += step) {
+      selected.clear();
+      for (core::index4 i = start; i < start + seed_len; ++i) selected.push_back(i);
+      for (core::index2 iter = 0; iter < max_iterations_; ++iter) {
+        if (!superimpose(selected)) break;
+        distances();
+        score();
+        previous.swap(selected);
+        select(d0_search);
+        if (selected == previous) break; // --- converged: the superposition would not change
+      }
+    }
+    if (seed_len == 3) break;
+  }
+  gdt_ts_ = (best_gdt[0] + best_gdt[1] + best_gdt[2] + best_gdt[3]) / (4.0 * n);
+}
+
+bool TMScore::superimpose(const std::vector<core::index4> &subset) {
+
+  if (subset.size() < 3) return false;
+  sub_model.resize(subset.size());
+  sub_reference.resize(subset.size());
+  for (core::index4 k = 0; k < subset.size(); ++k) {
+    sub_model[k].set(mx[subset[k]], my[subset[k]], mz[subset[k]]);
+    sub_reference[k].set(rx[subset[k]], ry[subset[k]], rz[subset[k]]);
+  }
+  rms.crmsd(sub_model, sub_reference, subset.size(), true);
+  return true;
+}
+
+void TMScore::distances() {
+
+  const core::real bx = rms.tr_before().x, by = rms.tr_before().y, bz = rms.tr_before().z;
+  const core::real ax = rms.tr_after().x, ay = rms.tr_after().y, az = rms.tr_after().z;
+  const core::real r00 = rms.rot_x().x, r01 = rms.rot_x().y, r02 = rms.rot_x().z;
+  const core::real r10 = rms.rot_y().x, r11 = rms.rot_y().y, r12 = rms.rot_y().z;
+  const core::real r20 = rms.rot_z().x, r21 = rms.rot_z().y, r22 = rms.rot_z().z;
+  const core::real *x = mx.data(), *y = my.data(), *z = mz.data();
+  const core::real *tx = rx.data(), *ty = ry.data(), *tz = rz.data();
+  core::real *d = d2.data();
+  // --- no branches here: this loop should be vectorized
+  for (core::index4 i = 0; i < n; ++i) {
+    const core::real qx = x[i] - bx, qy = y[i] - by, qz = z[i] - bz;
+    const core::real dx = r00 * qx + r01 * qy + r02 * qz + ax - tx[i];
+    const core::real dy = r10 * qx + r11 * qy + r12 * qz + ay - ty[i];
+    const core::real dz = r20 * qx + r21 * qy + r22 * qz + az - tz[i];
+    d[i] = dx * dx + dy * dy + dz * dz;
+  }
+}
+
+void TMScore::score() {
+
+  const core::real inv_d02 = 1.0 / (d0_ * d0_);
+  const core::real *d = d2.data();
+  core::real tm = 0.0;
+  core::index4 g1 = 0, g2 = 0, g4 = 0, g8 = 0;
+  for (core::index4 i = 0; i < n; ++i) {
+    tm += 1.0 / (1.0 + d[i] * inv_d02);
+    g1 += (d[i] < 1.0);
+    g2 += (d[i] < 4.0);
+    g4 += (d[i] < 16.0);
+    g8 += (d[i] < 64.0);
+  }
+  tm_score_ = std::max(tm_score_, tm / n);
+  best_gdt[0] = std::max(best_gdt[0], g1);
+  best_gdt[1] = std::max(best_gdt[1], g2);
+  best_gdt[2] = std::max(best_gdt[2], g4);
+  best_gdt[3] = std::max(best_gdt[3], g8);
+}
+
+void TMScore::select(const core::real cutoff) {
+
+  // --- at least three atoms are needed to superimpose, so the cutoff is relaxed if necessary
+  selected.clear();
+  for (core::real c = cutoff; selected.size() < 3 && c < cutoff + 20.0; c += 0.5) {
+    selected.clear();
+    const core::real c2 = c * c;
+    for (core::index4 i = 0; i < n; ++i)
+      if (d2[i] < c2) selected.push_back(i);
+  }
+}
+
+} // ~ structural
+} // ~ calc
+} // ~ core
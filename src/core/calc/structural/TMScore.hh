@@ -0,0 +1,95 @@
+/** \file TMScore.hh
+ * @brief Provides TMScore: superposition-based TM-score and GDT_TS similarity measures
+ */
+#ifndef CORE_CALC_STRUCTURAL_TMScore_H
+#define CORE_CALC_STRUCTURAL_TMScore_H
+
+#include <vector>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/data/basic/Vec3.hh>
+#include <core/calc/structural/transformations/Crmsd.hh>
+
+namespace core {
+namespace calc {
+namespace structural {
+
+/** @brief Computes TM-score and GDT_TS of a model in respect to a reference structure.
+ *
+ * Both measures require a superposition that maximises the score rather than minimises crmsd. The search follows
+ * the TM-score program: a model is superimposed on seed fragments of \f$ L, L/2, L/4, \ldots \f$ consecutive atoms;
+ * then, iteratively, on all the atoms closer than \f$ d_0^{search} \f$ to their reference positions, until that set
+ * does not change (or <code>max_iterations()</code> is reached). Both scores are evaluated for every superposition
+ * found during the search and the highest values are reported. GDT_TS computed this way is a lower bound of
+ * the exact value, which would require a separate search for each of its four distance cutoffs.
+ *
+ * Coordinates are stored as separate x, y and z arrays and distances are computed for all atoms in a single
+ * branch-free loop, which the compiler vectorizes.
+ *
+ * The distance scale of TM-score is \f$ d_0 = 1.24 \sqrt[3]{L-15} - 1.8 \f$ (not less than 0.5), where \f$ L \f$
+ * is the number of atoms in the reference structure.
+ */
+class TMScore {
+public:
+
+  /** @brief Prepares the calculations for a given reference structure.
+   * @param reference - coordinates of the reference structure
+   */
+  TMScore(const std::vector<core::data::basic::Vec3> &reference);
+
+  /// Returns the number of atoms in the reference structure
+  core::index4 size() const { return n; }
+
+  /// Returns the \f$ d_0 \f$ distance scale
+  core::real d0() const { return d0_; }
+
+  /// Sets the maximum number of iterations of superposition refinement per seed fragment
+  void max_iterations(const core::index2 n_iter) { max_iterations_ = n_iter; }
+
+  /** @brief Evaluates both scores for a given model.
+   * @param model - coordinates of a model, indexed as <code>model[i].x</code>; must provide <code>size()</code> atoms
+   */
+  template<typename T>
+  void calculate(const T &model) {
+    for (core::index4 i = 0; i < n; ++i) {
+      mx[i] = model[i].x;
+      my[i] = model[i].y;
+      mz[i] = model[i].z;
+    }
+    search();
+  }
+
+  /// TM-score found by the most recent <code>calculate()</code> call
+  core::real tm_score() const { return tm_score_; }
+
+  /// GDT_TS found by the most recent <code>calculate()</code> call
+  core::real gdt_ts() const { return gdt_ts_; }
+
+private:
+  const core::index4 n;
+  core::real d0_;
+  core::real d0_search;
+  core::index2 max_iterations_ = 20;
+  std::vector<core::real> rx, ry, rz; ///< reference coordinates
+  std::vector<core::real> mx, my, mz; ///< model coordinates
+  std::vector<core::real> d2; ///< squared distances after the current superposition
+  std::vector<core::index4> selected, previous;
+  std::vector<core::data::basic::Vec3> sub_model, sub_reference;
+  core::real tm_score_ = 0.0;
+  core::real gdt_ts_ = 0.0;
+  core::index4 best_gdt[4];
+  transformations::Crmsd<std::vector<core::data::basic::Vec3>, std::vector<core::data::basic::Vec3>> rms;
+
+  void search();
+  bool superimpose(const std::vector<core::index4> &subset);
+  void distances();
+  void score();
+  void select(const core::real cutoff);
+};
+
+} // ~ structural
+} // ~ calc
+} // ~ core
+
+#endif
@@ -0,0 +1,383 @@
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <core/SURPASSenvironment.hh>
+#include <core/calc/statistics/Random.hh>
+#include <core/data/io/Pdb.hh>
+#include <core/data/io/ss2_io.hh>
+#include <core/data/sequence/SecondaryStructure.hh>
+#include <utils/io_utils.hh>
+#include <utils/string_utils.hh>
+
+#include <simulations/api/SurpassSimulation.hh>
+#include <simulations/api/JobServer.hh>
+
+namespace simulations {
+namespace api {
+
+using core::data::basic::Vec3;
+
+/// A connected client: its socket and the lock that keeps lines sent by concurrent jobs from being mixed
+struct JobServer::Client {
+  const int fd;
+  const core::index4 id;
+  std::mutex send_mutex;
+  bool connected = true;
+
+  Client(const int fd, const core::index4 id) : fd(fd), id(id) {}
+
+  /// Closed when the last job of this client is done
+  ~Client() { close(fd); }
+
+  /// Sends a text; it is silently dropped when the client has gone away
+  void send(const std::string &text) {
+
+    std::lock_guard<std::mutex> lock(send_mutex);
+    size_t sent = 0;
+    while (connected && (sent < text.size())) {
+      ssize_t n = ::send(fd, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) connected = false;
+      else sent += n;
+    }
+  }
+
+  /// Reads a single line (without the newline character); returns false at the end of the input
+  bool read_line(std::string &line) {
+
+    line.clear();
+    while (true) {
+      size_t pos = buffer.find('\n');
+      if (pos != std::string::npos) {
+        line = buffer.substr(0, pos);
+        buffer.erase(0, pos + 1);
+        if ((!line.empty()) && (line.back() == '\r')) line.pop_back();
+        return true;
+      }
+      char chunk[4096];
+      ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+      if (n <= 0) {
+        if (buffer.empty()) return false;
+        line.swap(buffer);
+        return true;
+      }
+      buffer.append(chunk, n);
+    }
+  }
+
+private:
+  std::string buffer;
+};
+
+/// Everything needed to run a single job
+struct JobServer::Job {
+  core::index4 id = 0;
+  std::shared_ptr<Client> client;
+  std::string pdb, pdb_text; ///< starting structure: a file name or the PDB-formatted data
+  std::string ss2, ss2_text; ///< secondary structure: a file name or the SS2-formatted data
+  std::string config, config_text; ///< force field configuration; the default is used when both are empty
+  bool is_remc = false;
+  std::vector<core::real> temperatures{1.0};
+  core::index4 n_exchanges = 10;
+  core::index4 inner = 10, outer = 10, cycle_size = 1;
+  std::vector<core::real> move_ranges{0.5};
+  core::calc::statistics::Random::result_type seed = 0;
+  bool has_seed = false;
+  bool stream = true;
+};
+
+JobServer::JobServer(const std::string &socket_path, const core::index2 n_workers) :
+  socket_path(socket_path), n_workers((n_workers == 0) ? std::max(1u, std::thread::hardware_concurrency()) : n_workers),
+  logs("JobServer") {}
+
+JobServer::~JobServer() {
+
+  if (listen_fd >= 0) {
+    close(listen_fd);
+    unlink(socket_path.c_str());
+  }
+}
+
+void JobServer::warm_up() {
+
+  if (is_warm) return;
+  auto start = std::chrono::high_resolution_clock::now();
+  default_config = utils::load_text_file(core::SURPASSenvironment::from_file_or_db("surpass.wghts", "forcefield"));
+
+  // --- Creating an energy function of any chain loads all the mean-field distributions; they are cached then
+  const core::index2 n = 24;
+  std::vector<Vec3> ca;
+  for (core::index2 i = 0; i < n; ++i) ca.emplace_back(2.3 * cos(i * 1.745), 2.3 * sin(i * 1.745), 1.5 * i);
+  auto ss2 = std::make_shared<core::data::sequence::SecondaryStructure>("", std::string(n, 'A'), 1,
+                                                                        std::string(n, 'H'));
+  try {
+    SurpassSimulation probe({SurpassSimulation::structure_from_ca(ca, *ss2)}, ss2, default_config);
+    probe.annealing({1.0});
+  } catch (const std::exception &e) {
+    logs << utils::LogLevel::WARNING << "force field not preloaded, the first job will load it: " << e.what() << "\n";
+  }
+  is_warm = true;
+  auto end = std::chrono::high_resolution_clock::now();
+  logs << utils::LogLevel::INFO << "force field loaded in "
+       << size_t(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()) << " ms\n";
+}
+
+void JobServer::serve() {
+
+  warm_up();
+
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0) throw std::runtime_error("Can't create a Unix socket: " + std::string(strerror(errno)) + "\n");
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (socket_path.size() >= sizeof(address.sun_path))
+    throw std::invalid_argument("Socket name too long: " + socket_path + "\n");
+  strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+  unlink(socket_path.c_str()); // --- a file left by a server that did not stop cleanly
+  if ((bind(listen_fd, (sockaddr *) &address, sizeof(address)) < 0) || (listen(listen_fd, 64) < 0))
+    throw std::runtime_error("Can't listen at " + socket_path + ": " + std::string(strerror(errno)) + "\n");
+  logs << utils::LogLevel::INFO << "listening at " << socket_path << " with " << size_t(n_workers) << " workers\n";
+
+  for (core::index2 i = 0; i < n_workers; ++i) workers.emplace_back(&JobServer::worker_loop, this);
+
+  while (!stopped) {
+    int fd = accept(listen_fd, nullptr, nullptr);
+    if (fd < 0) {
+      if (stopped) break;
+      if (errno == EINTR) continue;
+      logs << utils::LogLevel::WARNING << "accept() failed: " << strerror(errno) << "\n";
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                 [](const std::weak_ptr<Client> &c) { return c.expired(); }), clients.end());
+    auto client = std::make_shared<Client>(fd, ++n_clients);
+    clients.push_back(client);
+    ++n_talking;
+    std::thread(&JobServer::talk, this, client).detach();
+  }
+
+  // --- Stop reading from clients that are still connected, then let the workers finish queued jobs
+  {
+    std::unique_lock<std::mutex> lock(queue_mutex);
+    stopped = true;
+    for (auto &c : clients)
+      if (auto client = c.lock()) shutdown(client->fd, SHUT_RD);
+    queue_changed.wait(lock, [this]() { return n_talking == 0; });
+  }
+  queue_changed.notify_all();
+  for (auto &w : workers) w.join();
+  workers.clear();
+  logs << utils::LogLevel::INFO << "server stopped after " << size_t(n_jobs) << " jobs\n";
+}
+
+/// Reads the value of an input: either the rest of the line after '=' or a block of lines ended by END
+static bool read_input(const std::string &line, const std::string &key, std::string &path,
+                       std::string &text, const std::function<bool(std::string &)> &read_line) {
+
+  if (line.compare(0, key.size() + 1, key + "=") == 0) {
+    path = line.substr(key.size() + 1);
+    utils::trim(path);
+    text.clear();
+    return true;
+  }
+  if (line == key + ":inline") {
+    path.clear();
+    text.clear();
+    std::string l;
+    while (read_line(l) && (l != "END")) text += l + "\n";
+    return true;
+  }
+  return false;
+}
+
+void JobServer::talk(std::shared_ptr<Client> client) {
+
+  Job job; // --- values not given by a client are taken from the previous job
+  std::string line;
+  auto read_line = [&client](std::string &l) { return client->read_line(l); };
+  while (client->read_line(line)) {
+    line = utils::trim(line);
+    if (line.empty() || (line[0] == '#')) continue;
+    if (read_input(line, "pdb", job.pdb, job.pdb_text, read_line)) continue;
+    if (read_input(line, "ss2", job.ss2, job.ss2_text, read_line)) continue;
+    if (read_input(line, "config", job.config, job.config_text, read_line)) continue;
+    if (line == "RUN") {
+      auto j = std::make_shared<Job>(job);
+      j->client = client;
+      enqueue(j);
+      continue;
+    }
+    if (line == "STATUS") {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      size_t n_queued = 0;
+      for (const auto &p : pending) n_queued += p.second.size();
+      client->send(utils::string_format("STATUS %d queued %d running %d workers\n", int(n_queued), int(n_running),
+                                        int(n_workers)));
+      continue;
+    }
+    if (line == "SHUTDOWN") {
+      client->send("BYE\n");
+      stopped = true;
+      shutdown(listen_fd, SHUT_RDWR); // --- wakes up accept()
+      break;
+    }
+    const size_t eq = line.find('=');
+    std::string key = line.substr(0, eq);
+    std::string value = (eq == std::string::npos) ? "" : line.substr(eq + 1);
+    utils::trim(key);
+    utils::trim(value);
+    try {
+      if (key == "mode") {
+        if ((value != "annealing") && (value != "replicas")) throw std::invalid_argument("unknown mode: " + value);
+        job.is_remc = (value == "replicas");
+      } else if (key == "temperatures") {
+        job.temperatures.clear();
+        utils::split(value, job.temperatures, ',');
+      } else if (key == "exchanges") job.n_exchanges = utils::from_string<core::index4>(value);
+      else if (key == "cycles") {
+        std::vector<core::index4> c;
+        utils::split(value, c, ',');
+        if (c.size() < 2) throw std::invalid_argument("cycles requires inner and outer number of cycles");
+        job.inner = c[0];
+        job.outer = c[1];
+        job.cycle_size = (c.size() > 2) ? c[2] : 1;
+      } else if (key == "move_range") {
+        job.move_ranges.clear();
+        utils::split(value, job.move_ranges, ',');
+      } else if (key == "seed") {
+        job.seed = utils::from_string<core::calc::statistics::Random::result_type>(value);
+        job.has_seed = true;
+      } else if (key == "stream") job.stream = (value != "0");
+      else throw std::invalid_argument("unknown key: " + key);
+    } catch (const std::exception &e) {
+      client->send("ERROR 0 " + std::string(e.what()) + "\n");
+    }
+  }
+
+  // --- The server may be destroyed as soon as the lock is released, so this must be the last use of its members
+  std::lock_guard<std::mutex> lock(queue_mutex);
+  --n_talking;
+  queue_changed.notify_all();
+}
+
+void JobServer::enqueue(std::shared_ptr<Job> job) {
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (stopped) {
+      job->client->send("ERROR 0 server is shutting down\n");
+      return;
+    }
+    job->id = ++n_jobs;
+    // --- Every job draws from its own engine; the seed is taken from the global one unless given by the client.
+    // --- This is the only use of the singleton in the server; queue_mutex serialises it
+    if (!job->has_seed) job->seed = core::calc::statistics::Random::get()();
+    pending[job->client->id].push_back(job);
+  }
+  job->client->send(utils::string_format("ACCEPTED %d\n", int(job->id)));
+  queue_changed.notify_one();
+}
+
+std::shared_ptr<JobServer::Job> JobServer::next_job() {
+
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  queue_changed.wait(lock, [this]() { return stopped || (!pending.empty()); });
+  if (pending.empty()) return nullptr;
+
+  // --- Round-robin over clients: take the first client after the one served most recently
+  auto it = pending.upper_bound(last_client);
+  if (it == pending.end()) it = pending.begin();
+  std::shared_ptr<Job> job = it->second.front();
+  it->second.pop_front();
+  last_client = it->first;
+  if (it->second.empty()) pending.erase(it);
+  ++n_running;
+  return job;
+}
+
+void JobServer::worker_loop() {
+
+  while (true) {
+    std::shared_ptr<Job> job = next_job();
+    if (!job) return;
+    try {
+      run_job(*job);
+    } catch (const std::exception &e) {
+      std::string msg(e.what());
+      std::replace(msg.begin(), msg.end(), '\n', ' ');
+      job->client->send(utils::string_format("ERROR %d ", int(job->id)) + utils::trim(msg) + "\n");
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    --n_running;
+  }
+}
+
+void JobServer::run_job(Job &job) {
+
+  auto start = std::chrono::high_resolution_clock::now();
+  Client &client = *job.client;
+  client.send(utils::string_format("STARTED %d\n", int(job.id)));
+
+  // --- Inputs
+  std::vector<core::data::structural::Structure_SP> starting;
+  if (!job.pdb_text.empty()) {
+    std::istringstream in(job.pdb_text);
+    core::data::io::Pdb reader(in, core::data::io::is_not_alternative);
+    reader.create_structures(starting);
+  } else if (!job.pdb.empty()) {
+    core::data::io::Pdb reader(job.pdb, core::data::io::is_not_alternative, true);
+    reader.create_structures(starting);
+  } else throw std::invalid_argument("starting structure not given");
+  if (starting.empty()) throw std::invalid_argument("no structure found in the PDB input");
+
+  core::data::sequence::SecondaryStructure_SP ss2_aa;
+  if (!job.ss2_text.empty()) {
+    std::istringstream in(job.ss2_text);
+    ss2_aa = core::data::io::read_ss2(in, "");
+  } else if (!job.ss2.empty()) ss2_aa = core::data::io::read_ss2(job.ss2, "");
+  else throw std::invalid_argument("secondary structure not given");
+
+  std::string config = job.config_text;
+  if (config.empty()) config = (job.config.empty()) ? default_config : utils::load_text_file(job.config);
+
+  // --- Simulation
+  SurpassSimulation sim(starting, ss2_aa, config);
+  sim.cycles(job.inner, job.outer, job.cycle_size);
+  sim.move_ranges(job.move_ranges);
+  sim.seed(job.seed); // --- before the sampler is set up, so that workers never draw from the singleton
+  if (job.is_remc) sim.replicas(job.temperatures, job.n_exchanges);
+  else sim.annealing(job.temperatures);
+  if (job.stream) {
+    const core::index4 id = job.id;
+    sim.on_cycle([&client, id](const SurpassSimulation &s, const core::index2 r, const core::index4 c) {
+      client.send(utils::string_format("CYCLE %d %d %d %.3f %.3f\n", int(id), int(r), int(c), s.temperature(r),
+                                       s.energy(r)));
+    });
+  }
+  sim.run();
+
+  // --- Results: the final conformation of every replica, sent at once
+  std::ostringstream out;
+  for (core::index2 r = 0; r < sim.count_replicas(); ++r) {
+    out << utils::string_format("MODEL %d %d %.3f %.3f\n", int(job.id), int(r), sim.temperature(r), sim.energy(r));
+    sim.write_pdb(r, out);
+    out << utils::string_format("ENDMODEL %d\n", int(job.id));
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  out << utils::string_format("DONE %d %d\n", int(job.id),
+                              int(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+  client.send(out.str());
+}
+
+} // ~ api
+} // ~ simulations
@@ -0,0 +1,125 @@
+/** @file JobServer.hh
+ * @brief Provides JobServer: a long-running process that runs SURPASS simulations submitted through a Unix socket
+ */
+#ifndef SIMULATIONS_API_JobServer_HH
+#define SIMULATIONS_API_JobServer_HH
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+#include <core/index.hh>
+#include <utils/Logger.hh>
+
+namespace simulations {
+namespace api {
+
+/** @brief Runs SURPASS jobs submitted by clients connected to a Unix domain socket.
+ *
+ * The server is started once and then runs any number of jobs. Data that is expensive to prepare (force field
+ * configuration, mean-field distributions, monomer tables) is loaded at startup and shared by all jobs,
+ * so a small job costs only the simulation itself. Every job is run by a <code>SurpassSimulation</code> object
+ * seeded with its own random engine.
+ *
+ * A client sends a job as text lines, terminated by a <code>RUN</code> line:
+ * @code
+ * pdb=/path/to/start.pdb
+ * ss2:inline
+ * ... lines of an SS2 file ...
+ * END
+ * mode=replicas
+ * temperatures=1.5,1.8,2.1
+ * exchanges=10
+ * cycles=10,20
+ * seed=1234
+ * RUN
+ * @endcode
+ * Every input (<code>pdb</code>, <code>ss2</code>, <code>config</code>) may be given either by a path or inline,
+ * as a block ended by <code>END</code>. Other keys are: <code>mode</code> (<code>annealing</code>, which is
+ * the default, or <code>replicas</code>), <code>temperatures</code>, <code>exchanges</code>,
+ * <code>cycles</code> (inner, outer and optionally cycle size), <code>move_range</code>, <code>seed</code>
+ * and <code>stream</code> (when 0, per-cycle energies are not sent). Keys not given in a job keep the values
+ * from the previous job sent over the same connection. Results are sent back as they come, each line tagged
+ * with the job id:
+ * @code
+ * ACCEPTED <id>
+ * STARTED <id>
+ * CYCLE <id> <replica> <cycle> <temperature> <energy>
+ * MODEL <id> <replica> <temperature> <energy>
+ * ... PDB lines of the final conformation ...
+ * ENDMODEL <id>
+ * DONE <id> <milliseconds>
+ * @endcode
+ * or <code>ERROR <id> <message></code> when the job fails. A client may submit several jobs over one connection;
+ * closing its writing end tells the server there will be no more. Two more commands are understood:
+ * <code>STATUS</code> and <code>SHUTDOWN</code>; the latter stops accepting connections and returns
+ * from <code>serve()</code> once all queued jobs are done.
+ *
+ * Jobs are run by a fixed number of worker threads. Queued jobs are taken from clients in a round-robin order,
+ * so a client who submits many jobs does not hold back the others.
+ */
+class JobServer {
+public:
+
+  /** @brief Prepares a server; nothing is listening until <code>serve()</code> is called
+   * @param socket_path - file name of the Unix socket
+   * @param n_workers - the number of jobs run concurrently; when 0, the number of hardware threads is used
+   */
+  JobServer(const std::string &socket_path, const core::index2 n_workers = 0);
+
+  /// Closes the socket and removes its file
+  ~JobServer();
+
+  /** @brief Loads force field data that is shared by all jobs.
+   *
+   * Called by <code>serve()</code>; it may be called earlier to measure the startup time separately.
+   */
+  void warm_up();
+
+  /// Listens for connections and runs jobs until a client sends <code>SHUTDOWN</code>
+  void serve();
+
+  /// Returns the number of worker threads
+  core::index2 count_workers() const { return n_workers; }
+
+private:
+  struct Client;
+  struct Job;
+
+  const std::string socket_path;
+  const core::index2 n_workers;
+  int listen_fd = -1;
+  std::atomic<bool> stopped{false};
+  std::string default_config; ///< surpass.wghts, loaded once
+  bool is_warm = false;
+
+  std::mutex queue_mutex; ///< guards all the members below
+  std::condition_variable queue_changed;
+  std::map<core::index4, std::deque<std::shared_ptr<Job>>> pending; ///< queued jobs of every client
+  core::index4 last_client = 0; ///< the client whose job was started most recently
+  core::index4 n_clients = 0;
+  core::index4 n_jobs = 0;
+  core::index2 n_running = 0;
+
+  std::vector<std::weak_ptr<Client>> clients; ///< every client, to disconnect those still connected at shutdown
+  core::index4 n_talking = 0; ///< the number of threads reading jobs from clients
+  std::vector<std::thread> workers;
+  utils::Logger logs;
+
+  void talk(std::shared_ptr<Client> client);
+  void enqueue(std::shared_ptr<Job> job);
+  std::shared_ptr<Job> next_job();
+  void worker_loop();
+  void run_job(Job &job);
+};
+
+} // ~ api
+} // ~ simulations
+
+#endif
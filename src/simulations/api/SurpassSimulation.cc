@@ -0,0 +1,255 @@
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+
+#include <core/SURPASSenvironment.hh>
+#include <core/data/io/ss2_io.hh>
+#include <core/data/structural/Chain.hh>
+#include <core/data/structural/Residue.hh>
+#include <core/data/structural/PdbAtom.hh>
+#include <utils/io_utils.hh>
+#include <utils/string_utils.hh>
+
+#include <simulations/forcefields/surpass/surpass_force_field_factory.hh>
+#include <simulations/movers/PerturbResidue.hh>
+#include <simulations/movers/PerturbChainFragment.hh>
+#include <simulations/observers/ObserverInterface.hh>
+#include <simulations/observers/cartesian/PdbObserver.hh>
+#include <simulations/representations/surpass_utils.hh>
+#include <simulations/api/SurpassSimulation.hh>
+
+namespace simulations {
+namespace api {
+
+using core::data::basic::Vec3;
+
+/// Calls a user's function after every outer cycle of a single replica
+class CallbackObserver : public observers::ObserverInterface {
+public:
+  CallbackObserver(const SurpassSimulation &sim, const core::index2 replica, CycleCallback callback) :
+    sim(sim), replica(replica), callback(callback) {}
+
+  virtual bool observe() {
+    callback(sim, replica, ++n_cycles);
+    return true;
+  }
+
+  virtual void finalize() {}
+
+private:
+  const SurpassSimulation &sim;
+  const core::index2 replica;
+  CycleCallback callback;
+  core::index4 n_cycles = 0;
+};
+
+static std::string default_scoring_config() {
+  return utils::load_text_file(core::SURPASSenvironment::from_file_or_db("surpass.wghts", "forcefield"));
+}
+
+SurpassSimulation::SurpassSimulation(const std::vector<Vec3> &ca, const std::string &ss2_text,
+                                     const std::string &scoring_config) :
+  scoring_config_((scoring_config.empty()) ? default_scoring_config() : scoring_config), logs("SurpassSimulation") {
+
+  std::istringstream in(ss2_text);
+  ss2_aa_ = core::data::io::read_ss2(in, "");
+  starting_.push_back(structure_from_ca(ca, *ss2_aa_));
+}
+
+SurpassSimulation::SurpassSimulation(const std::vector<core::data::structural::Structure_SP> &starting,
+                                     core::data::sequence::SecondaryStructure_SP ss2_aa,
+                                     const std::string &scoring_config) :
+  starting_(starting), ss2_aa_(ss2_aa),
+  scoring_config_((scoring_config.empty()) ? default_scoring_config() : scoring_config), logs("SurpassSimulation") {
+
+  if (starting_.empty()) throw std::invalid_argument("At least one starting structure is required\n");
+}
+
+core::data::structural::Structure_SP SurpassSimulation::structure_from_ca(const std::vector<Vec3> &ca,
+                                                                         const core::data::sequence::SecondaryStructure &ss2_aa) {
+
+  using namespace core::data::structural;
+
+  if (ss2_aa.length() < ca.size())
+    throw std::invalid_argument(utils::string_format("%d CA atoms given for the secondary structure of %d residues\n",
+                                                     int(ca.size()), int(ss2_aa.length())));
+  Structure_SP s = std::make_shared<Structure>("");
+  Chain_SP chain = std::make_shared<Chain>('A');
+  s->push_back(chain);
+  for (core::index4 i = 0; i < ca.size(); ++i) {
+    Residue_SP r = std::make_shared<Residue>(i + 1, "GLY");
+    r->push_back(std::make_shared<PdbAtom>(i + 1, " CA ", ca[i].x, ca[i].y, ca[i].z));
+    r->ss(ss2_aa.ss(i));
+    chain->push_back(r);
+  }
+  return s;
+}
+
+void SurpassSimulation::cycles(const core::index4 inner_cycles, const core::index4 outer_cycles,
+                               const core::index4 cycle_size) {
+
+  inner_cycles_ = inner_cycles;
+  outer_cycles_ = outer_cycles;
+  cycle_size_ = cycle_size;
+  for (auto &s : samplers_) s->cycles(inner_cycles_, outer_cycles_, cycle_size_);
+}
+
+void SurpassSimulation::fragment_moves(const core::index2 length, const std::vector<core::real> &ranges) {
+
+  fragment_length_ = length;
+  fragment_ranges_ = (ranges.empty()) ? std::vector<core::real>{0.5} : ranges;
+}
+
+void SurpassSimulation::create_systems(const core::index2 n_replicas) {
+
+  if (!systems_.empty()) throw std::logic_error("The sampler of this simulation has already been set up\n");
+
+  for (core::index2 irepl = 0; irepl < n_replicas; ++irepl) {
+    std::shared_ptr<systems::surpass::SurpassModel<Vec3>> rc;
+    if (irepl < starting_.size()) {
+      core::data::structural::Structure_SP s = starting_[irepl];
+      if (!representations::is_surpass_model(*s)) {
+        core::index2 res_cnt = 0;
+        for (auto res_it = s->first_residue(); res_it != s->last_residue(); ++res_it) (*res_it)->ss(ss2_aa_->ss(res_cnt++));
+        s = representations::surpass_representation(*s);
+      }
+      structures_.push_back(s);
+      rc = std::make_shared<systems::surpass::SurpassModel<Vec3>>(*s);
+    } else { // --- more replicas than starting structures: a copy of the last one shares its topology
+      structures_.push_back(structures_.back());
+      rc = std::make_shared<systems::surpass::SurpassModel<Vec3>>(*systems_.back());
+    }
+    systems_.push_back(rc);
+    auto en = forcefields::surpass::create_surpass_energy<Vec3>(*rc, ss2_aa_, scoring_config_);
+    energies_.push_back(en);
+
+    movers_.push_back(create_movers(*rc, *en, move_ranges_[irepl % move_ranges_.size()], fragment_length_,
+      (fragment_length_ > 0) ? fragment_ranges_[irepl % fragment_ranges_.size()] : 0.5));
+  }
+}
+
+movers::MoversSet_SP SurpassSimulation::create_movers(systems::ResidueChain<Vec3> &system,
+                                                      forcefields::TotalEnergyByResidue &energy,
+                                                      const core::real move_range, const core::index2 fragment_length,
+                                                      const core::real fragment_range) {
+
+  movers::MoversSet_SP ms = std::make_shared<movers::MoversSet>();
+  auto perturb = std::make_shared<movers::PerturbResidue<Vec3>>(system, energy);
+  perturb->max_move_range(move_range);
+  ms->add_mover(perturb, system.n_atoms);
+  if (fragment_length > 0) {
+    auto perturb_n = std::make_shared<movers::PerturbChainFragment<Vec3>>(system, fragment_length, energy);
+    perturb_n->max_move_range(fragment_range);
+    ms->add_mover(perturb_n, system.n_atoms / fragment_length);
+  }
+  return ms;
+}
+
+void SurpassSimulation::annealing(const std::vector<core::real> &temperatures) {
+
+  create_systems(1);
+  annealing_ = std::make_shared<sampling::SimulatedAnnealing>(movers_[0], temperatures);
+  annealing_->cycles(inner_cycles_, outer_cycles_, cycle_size_);
+  samplers_.push_back(annealing_);
+  use_own_generator();
+}
+
+void SurpassSimulation::annealing(const std::vector<core::real> &temperatures,
+                                  const std::vector<core::index4> &outer_cycles) {
+
+  create_systems(1);
+  annealing_ = std::make_shared<sampling::SimulatedAnnealing>(movers_[0], temperatures, outer_cycles);
+  annealing_->cycles(inner_cycles_, outer_cycles_, cycle_size_);
+  samplers_.push_back(annealing_);
+  use_own_generator();
+}
+
+void SurpassSimulation::adaptive_annealing(const core::real t_start, const core::real t_end, const core::real speed) {
+
+  create_systems(1);
+  adaptive_ = std::make_shared<sampling::AdaptiveAnnealing>(movers_[0], *energies_[0], t_start, t_end);
+  adaptive_->thermodynamic_speed(speed);
+  adaptive_->cycles(inner_cycles_, outer_cycles_, cycle_size_);
+  samplers_.push_back(adaptive_);
+  use_own_generator();
+}
+
+void SurpassSimulation::replicas(const std::vector<core::real> &temperatures, const core::index4 n_exchanges,
+                                 const sampling::ReplicaExchangeObservationMode mode) {
+
+  if (temperatures.size() < 2) throw std::invalid_argument("Replica exchange requires at least two temperatures\n");
+  create_systems(temperatures.size());
+  std::vector<forcefields::CalculateEnergyBase_SP> energies;
+  for (core::index2 irepl = 0; irepl < temperatures.size(); ++irepl) {
+    auto sampler = std::make_shared<sampling::IsothermalMC>(movers_[irepl], temperatures[irepl]);
+    sampler->cycles(inner_cycles_, outer_cycles_, cycle_size_);
+    samplers_.push_back(sampler);
+    energies.push_back(energies_[irepl]);
+  }
+  // --- the constructor seeds the replicas, so it must already draw from the engine of this simulation
+  remc_ = std::make_shared<sampling::ReplicaExchangeMC>(samplers_, energies, mode,
+    (generator_) ? *generator_ : core::calc::statistics::Random::get());
+  remc_->replica_exchanges(n_exchanges);
+}
+
+void SurpassSimulation::seed(const core::calc::statistics::Random::result_type seed) {
+
+  generator_.reset(new core::calc::statistics::Random(seed));
+  use_own_generator();
+}
+
+void SurpassSimulation::use_own_generator() {
+
+  if (!generator_) return;
+  if (remc_) remc_->random_generator(*generator_); // --- re-seeds the replicas from the given engine
+  else if (annealing_) annealing_->random_generator(*generator_);
+  else if (adaptive_) adaptive_->random_generator(*generator_);
+}
+
+void SurpassSimulation::on_cycle(CycleCallback callback) {
+
+  if (samplers_.empty()) throw std::logic_error("Call annealing() or replicas() before registering callbacks\n");
+  for (core::index2 irepl = 0; irepl < samplers_.size(); ++irepl)
+    samplers_[irepl]->outer_cycle_observer(std::make_shared<CallbackObserver>(*this, irepl, callback));
+}
+
+void SurpassSimulation::run() {
+
+  if (remc_) remc_->run();
+  else if (annealing_) annealing_->run();
+  else if (adaptive_) adaptive_->run();
+  else throw std::logic_error("Call annealing() or replicas() before run()\n");
+}
+
+void SurpassSimulation::coordinates(const core::index2 replica, std::vector<Vec3> &beads) const {
+
+  const auto &rc = *systems_.at(replica);
+  beads.resize(rc.n_atoms);
+  for (core::index4 i = 0; i < rc.n_atoms; ++i) beads[i].set(rc[i]);
+}
+
+void SurpassSimulation::write_pdb(const core::index2 replica, std::ostream &out) const {
+
+  observers::cartesian::PdbObserver<Vec3> o(*systems_.at(replica), *structures_.at(replica), "");
+  std::shared_ptr<std::ostream> sink(&out, [](std::ostream *) {}); // --- the stream is owned by the caller
+  o.output_stream(sink);
+  o.observe(*systems_[replica]);
+}
+
+void SurpassSimulation::energy_components(const core::index2 replica, std::vector<double> &components) const {
+
+  const auto &en = *energies_.at(replica);
+  components.resize(en.count_components());
+  for (core::index2 i = 0; i < en.count_components(); ++i)
+    components[i] = en.calculate_component(i) * en.get_factors()[i];
+}
+
+const std::string &SurpassSimulation::component_name(const core::index2 which) const {
+
+  if (energies_.empty() || (which >= energies_[0]->count_components()))
+    throw std::out_of_range(utils::string_format("Energy component index %d out of range\n", int(which)));
+  return energies_[0]->get_component(which)->name();
+}
+
+} // ~ api
+} // ~ simulations
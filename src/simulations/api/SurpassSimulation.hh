@@ -0,0 +1,226 @@
+/** @file SurpassSimulation.hh
+ * @brief Provides SurpassSimulation: an in-memory API to run SURPASS simulations from other programs
+ */
+#ifndef SIMULATIONS_API_SurpassSimulation_HH
+#define SIMULATIONS_API_SurpassSimulation_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/data/basic/Vec3.hh>
+#include <core/data/sequence/SecondaryStructure.hh>
+#include <core/data/structural/Structure.hh>
+#include <core/calc/statistics/Random.hh>
+#include <utils/Logger.hh>
+
+#include <simulations/systems/surpass/SurpassModel.hh>
+#include <simulations/forcefields/TotalEnergyByResidue.hh>
+#include <simulations/movers/MoversSet.hh>
+#include <simulations/sampling/IsothermalMC.hh>
+#include <simulations/sampling/SimulatedAnnealing.hh>
+#include <simulations/sampling/AdaptiveAnnealing.hh>
+#include <simulations/sampling/ReplicaExchangeMC.hh>
+
+namespace simulations {
+namespace api {
+
+class SurpassSimulation;
+
+/** @brief A function called after every outer cycle of every replica.
+ *
+ * Arguments are: the simulation, index of the replica (system) and the number of outer cycles this replica has done
+ * so far. In REMC replicas are run concurrently, so a callback may be called from several threads at the same time.
+ */
+typedef std::function<void(const SurpassSimulation &, const core::index2, const core::index4)> CycleCallback;
+
+/** @brief Runs SURPASS simulated annealing or replica exchange Monte Carlo entirely in memory.
+ *
+ * The only files read are the force field parameters from the SURPASS database. A simulation is defined in three steps:
+ * the constructor takes starting conformation(s) and a secondary structure profile, then <code>annealing()</code>
+ * or <code>replicas()</code> creates systems, energy functions, movers and samplers; finally <code>run()</code>
+ * samples. Between the last two steps a caller may register callbacks with <code>on_cycle()</code>
+ * or attach any observer directly to <code>sampler()</code>, as the <code>surpass</code> program does.
+ * After the run, coordinates and energies are read back with <code>coordinates()</code> and <code>energy()</code>:
+ * @code
+ * SurpassSimulation sim(ca_coordinates, ss2_text);
+ * sim.cycles(10, 100);
+ * sim.annealing({2.0, 1.8, 1.6});
+ * sim.on_cycle([](const SurpassSimulation &s, core::index2 r, core::index4 c) { std::cout << s.energy(r) << "\n"; });
+ * sim.run();
+ * std::vector<core::data::basic::Vec3> beads;
+ * sim.coordinates(0, beads);
+ * @endcode
+ */
+class SurpassSimulation {
+public:
+
+  /** @brief Creates a simulation of a single chain given by its CA coordinates.
+   * @param ca - coordinates of CA atoms, one per residue
+   * @param ss2_text - secondary structure profile in the SS2 (PsiPred) format, as a string
+   * @param scoring_config - force field configuration; when empty, <code>surpass.wghts</code> from the database is used
+   */
+  SurpassSimulation(const std::vector<core::data::basic::Vec3> &ca, const std::string &ss2_text,
+                    const std::string &scoring_config = "");
+
+  /** @brief Creates a simulation from starting structures.
+   * @param starting - starting structure(s), either all-atom or in SURPASS representation; when there are fewer
+   *    structures than replicas, the last one is used for the remaining replicas
+   * @param ss2_aa - secondary structure profile of the all-atom chain
+   * @param scoring_config - force field configuration; when empty, <code>surpass.wghts</code> from the database is used
+   */
+  SurpassSimulation(const std::vector<core::data::structural::Structure_SP> &starting,
+                    core::data::sequence::SecondaryStructure_SP ss2_aa, const std::string &scoring_config = "");
+
+  /** @brief Builds a chain of glycine residues, each holding only a CA atom
+   * @param ca - coordinates of CA atoms
+   * @param ss2_aa - secondary structure assigned to the residues; must be at least as long as the chain
+   */
+  static core::data::structural::Structure_SP structure_from_ca(const std::vector<core::data::basic::Vec3> &ca,
+                                                                 const core::data::sequence::SecondaryStructure &ss2_aa);
+
+  /** @brief Creates the movers of a SURPASS system: moves of single beads and, optionally, of chain fragments.
+   *
+   * This is the mover setup of every SURPASS simulation; it is also used by the <code>surpass</code> program
+   * for sampling protocols that are not provided by this class
+   * @param system - the system to be moved
+   * @param energy - energy function of that system
+   * @param move_range - the maximum range of a single-bead move
+   * @param fragment_length - the number of beads moved together by a fragment move; 0 turns fragment moves off
+   * @param fragment_range - the maximum range of a fragment move
+   */
+  static movers::MoversSet_SP create_movers(systems::ResidueChain<core::data::basic::Vec3> &system,
+                                            forcefields::TotalEnergyByResidue &energy, const core::real move_range,
+                                            const core::index2 fragment_length = 0, const core::real fragment_range = 0.5);
+
+  /// Sets the number of inner and outer cycles and the number of MC sweeps per inner cycle
+  void cycles(const core::index4 inner_cycles, const core::index4 outer_cycles, const core::index4 cycle_size = 1);
+
+  /// Sets the maximum range of a single-bead move; replica \f$ i \f$ uses <code>ranges[i % ranges.size()]</code>
+  void move_ranges(const std::vector<core::real> &ranges) { move_ranges_ = ranges; }
+
+  /** @brief Adds moves of chain fragments, as <code>-sample:perturb:n</code> does
+   * @param length - the number of beads moved together
+   * @param ranges - maximum move range; replica \f$ i \f$ uses <code>ranges[i % ranges.size()]</code>
+   */
+  void fragment_moves(const core::index2 length, const std::vector<core::real> &ranges);
+
+  /// Prepares simulated annealing of a single system over the given temperatures
+  void annealing(const std::vector<core::real> &temperatures);
+
+  /** @brief Prepares simulated annealing that spends a given number of outer cycles at every temperature
+   * @param temperatures - the annealing schedule
+   * @param outer_cycles - outer cycles for every temperature, e.g. as realized by an adaptive annealing run
+   */
+  void annealing(const std::vector<core::real> &temperatures, const std::vector<core::index4> &outer_cycles);
+
+  /** @brief Prepares adaptive simulated annealing of a single system
+   * @param t_start - the initial temperature
+   * @param t_end - the final temperature
+   * @param speed - thermodynamic speed, see <code>AdaptiveAnnealing</code>
+   */
+  void adaptive_annealing(const core::real t_start, const core::real t_end, const core::real speed);
+
+  /** @brief Prepares replica exchange Monte Carlo: one system per temperature
+   * @param temperatures - temperature of every replica
+   * @param n_exchanges - the number of exchange attempts, made every <code>inner x outer</code> cycles
+   * @param mode - how observations are assigned to temperatures
+   */
+  void replicas(const std::vector<core::real> &temperatures, const core::index4 n_exchanges,
+                const sampling::ReplicaExchangeObservationMode mode = sampling::ReplicaExchangeObservationMode::ISOTHERMAL);
+
+  /** @brief Makes this simulation draw all its random numbers from its own engine.
+   *
+   * By default the <code>Random::get()</code> singleton is used. Simulations run concurrently in the same process
+   * must be seeded before the sampler is set up, otherwise setting it up draws from the singleton. When called
+   * after setting up the sampler, the sampler and its replicas are re-seeded from the new engine.
+   * @param seed - seed of the engine
+   */
+  void seed(const core::calc::statistics::Random::result_type seed);
+
+  /// Registers a function called after every outer cycle of every replica; must be called after setting up the sampler
+  void on_cycle(CycleCallback callback);
+
+  /// Runs the simulation
+  void run();
+
+  /// Returns the number of systems (one for annealing, one per temperature for REMC)
+  core::index2 count_replicas() const { return systems_.size(); }
+
+  /// Returns the number of SURPASS beads in every system
+  core::index4 count_beads() const { return (systems_.empty()) ? 0 : systems_[0]->n_atoms; }
+
+  /// Copies the current coordinates of a given replica
+  void coordinates(const core::index2 replica, std::vector<core::data::basic::Vec3> &beads) const;
+
+  /// Returns the current total energy of a given replica
+  double energy(const core::index2 replica) const { return energies_.at(replica)->calculate(); }
+
+  /// Returns weighted energy components of a given replica, in the order of <code>component_name()</code>
+  void energy_components(const core::index2 replica, std::vector<double> &components) const;
+
+  /// Returns the name of an energy component
+  const std::string &component_name(const core::index2 which) const;
+
+  /// Returns the temperature the replica is currently sampled at
+  core::real temperature(const core::index2 replica) const { return samplers_.at(replica)->temperature(); }
+
+  /// Returns the starting structure of a given replica in SURPASS representation, e.g. to write it as PDB
+  core::data::structural::Structure_SP structure(const core::index2 replica) const { return structures_.at(replica); }
+
+  /// Writes the current conformation of a given replica in PDB format
+  void write_pdb(const core::index2 replica, std::ostream &out) const;
+
+  /// The system of a given replica
+  std::shared_ptr<systems::surpass::SurpassModel<core::data::basic::Vec3>> system(const core::index2 replica) const {
+    return systems_.at(replica);
+  }
+
+  /// The energy function of a given replica
+  std::shared_ptr<forcefields::TotalEnergyByResidue> energy_function(const core::index2 replica) const {
+    return energies_.at(replica);
+  }
+
+  /// The movers of a given replica
+  movers::MoversSet_SP movers(const core::index2 replica) const { return movers_.at(replica); }
+
+  /// The sampler of a given replica, e.g. to register observers
+  sampling::IsothermalMC_SP sampler(const core::index2 replica) const { return samplers_.at(replica); }
+
+  /// The adaptive annealing sampler; <code>nullptr</code> unless <code>adaptive_annealing()</code> was called
+  std::shared_ptr<sampling::AdaptiveAnnealing> adaptive_annealer() const { return adaptive_; }
+
+  /// The replica exchange driver; <code>nullptr</code> unless <code>replicas()</code> was called
+  std::shared_ptr<sampling::ReplicaExchangeMC> replica_exchange() const { return remc_; }
+
+private:
+  std::vector<core::data::structural::Structure_SP> starting_;
+  core::data::sequence::SecondaryStructure_SP ss2_aa_;
+  std::string scoring_config_;
+  core::index4 inner_cycles_ = 10, outer_cycles_ = 100, cycle_size_ = 1;
+  std::vector<core::real> move_ranges_{0.5};
+  core::index2 fragment_length_ = 0;
+  std::vector<core::real> fragment_ranges_;
+
+  std::vector<core::data::structural::Structure_SP> structures_;
+  std::vector<std::shared_ptr<systems::surpass::SurpassModel<core::data::basic::Vec3>>> systems_;
+  std::vector<std::shared_ptr<forcefields::TotalEnergyByResidue>> energies_;
+  std::vector<movers::MoversSet_SP> movers_;
+  std::vector<sampling::IsothermalMC_SP> samplers_;
+  std::shared_ptr<sampling::SimulatedAnnealing> annealing_;
+  std::shared_ptr<sampling::AdaptiveAnnealing> adaptive_;
+  std::shared_ptr<sampling::ReplicaExchangeMC> remc_;
+  std::unique_ptr<core::calc::statistics::Random> generator_;
+  utils::Logger logs;
+
+  void create_systems(const core::index2 n_replicas);
+  void use_own_generator();
+};
+
+} // ~ api
+} // ~ simulations
+
+#endif
@@ -0,0 +1,145 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <exception>
+
+#include <core/SURPASSenvironment.hh>
+#include <core/data/basic/Vec3.hh>
+
+#include <simulations/api/SurpassSimulation.hh>
+#include <simulations/api/surpass_c.h>
+
+using core::data::basic::Vec3;
+using simulations::api::SurpassSimulation;
+
+struct surpass_simulation {
+  std::unique_ptr<SurpassSimulation> sim;
+};
+
+static thread_local std::string last_error;
+
+/// Runs a call, converting any exception into -1 and the error message
+template<typename F>
+static int guarded(F f) {
+  try {
+    f();
+    return 0;
+  } catch (const std::exception &e) {
+    last_error = e.what();
+  } catch (...) {
+    last_error = "unknown error";
+  }
+  return -1;
+}
+
+/// Checks a handle passed to an entry point; a NULL handle sets the error message
+static bool valid(const surpass_simulation *sim) {
+  if ((sim != nullptr) && sim->sim) return true;
+  last_error = "NULL simulation handle";
+  return false;
+}
+
+/// Checks a pointer to the data passed to or from an entry point; NULL sets the error message
+static bool valid(const void *data, const char *name) {
+  if (data != nullptr) return true;
+  last_error = std::string("NULL pointer given as ") + name;
+  return false;
+}
+
+extern "C" {
+
+int surpass_abi_version(void) { return SURPASS_C_ABI_VERSION; }
+
+const char *surpass_last_error(void) { return last_error.c_str(); }
+
+void surpass_set_database(const char *path) { core::SURPASSenvironment::surpass_db_path(path); }
+
+surpass_simulation *surpass_create(const double *ca_xyz, int n_residues, const char *ss2_text,
+                                   const char *scoring_config) {
+
+  if (!valid(ca_xyz, "CA coordinates") || !valid(ss2_text, "secondary structure")) return nullptr;
+  std::unique_ptr<surpass_simulation> handle(new surpass_simulation);
+  int status = guarded([&]() {
+    std::vector<Vec3> ca(n_residues);
+    for (int i = 0; i < n_residues; ++i) ca[i].set(ca_xyz[3 * i], ca_xyz[3 * i + 1], ca_xyz[3 * i + 2]);
+    handle->sim.reset(new SurpassSimulation(ca, ss2_text, (scoring_config == nullptr) ? "" : scoring_config));
+  });
+  return (status == 0) ? handle.release() : nullptr;
+}
+
+void surpass_destroy(surpass_simulation *sim) { delete sim; }
+
+int surpass_set_cycles(surpass_simulation *sim, unsigned int inner, unsigned int outer, unsigned int cycle_size) {
+  if (!valid(sim)) return -1;
+  return guarded([&]() { sim->sim->cycles(inner, outer, cycle_size); });
+}
+
+int surpass_set_move_range(surpass_simulation *sim, double range) {
+  if (!valid(sim)) return -1;
+  return guarded([&]() { sim->sim->move_ranges({range}); });
+}
+
+int surpass_setup_annealing(surpass_simulation *sim, const double *temperatures, int n) {
+  if (!valid(sim) || !valid(temperatures, "temperatures")) return -1;
+  return guarded([&]() { sim->sim->annealing(std::vector<core::real>(temperatures, temperatures + n)); });
+}
+
+int surpass_setup_replicas(surpass_simulation *sim, const double *temperatures, int n, unsigned int n_exchanges) {
+  if (!valid(sim) || !valid(temperatures, "temperatures")) return -1;
+  return guarded([&]() {
+    sim->sim->replicas(std::vector<core::real>(temperatures, temperatures + n), n_exchanges);
+  });
+}
+
+int surpass_on_cycle(surpass_simulation *sim, surpass_cycle_callback callback, void *user_data) {
+  if (!valid(sim) || !valid((const void *) callback, "callback")) return -1;
+  return guarded([&]() {
+    sim->sim->on_cycle([sim, callback, user_data](const SurpassSimulation &, const core::index2 r, const core::index4 c) {
+      callback(sim, r, c, user_data);
+    });
+  });
+}
+
+int surpass_run(surpass_simulation *sim) {
+  if (!valid(sim)) return -1;
+  return guarded([&]() { sim->sim->run(); });
+}
+
+int surpass_count_replicas(const surpass_simulation *sim) { return valid(sim) ? int(sim->sim->count_replicas()) : -1; }
+
+int surpass_count_beads(const surpass_simulation *sim) { return valid(sim) ? int(sim->sim->count_beads()) : -1; }
+
+int surpass_coordinates(const surpass_simulation *sim, int replica, double *xyz) {
+  if (!valid(sim) || !valid(xyz, "coordinates")) return -1;
+  return guarded([&]() {
+    std::vector<Vec3> beads;
+    sim->sim->coordinates(replica, beads);
+    for (size_t i = 0; i < beads.size(); ++i) {
+      xyz[3 * i] = beads[i].x;
+      xyz[3 * i + 1] = beads[i].y;
+      xyz[3 * i + 2] = beads[i].z;
+    }
+  });
+}
+
+int surpass_energy(const surpass_simulation *sim, int replica, double *energy) {
+  if (!valid(sim) || !valid(energy, "energy")) return -1;
+  return guarded([&]() { *energy = sim->sim->energy(replica); });
+}
+
+int surpass_energy_components(const surpass_simulation *sim, int replica, double *components, int n_max) {
+  if (!valid(sim) || ((n_max > 0) && !valid(components, "energy components"))) return -1;
+  std::vector<double> values;
+  if (guarded([&]() { sim->sim->energy_components(replica, values); }) != 0) return -1;
+  for (int i = 0; (i < n_max) && (i < int(values.size())); ++i) components[i] = values[i];
+  return values.size();
+}
+
+const char *surpass_component_name(const surpass_simulation *sim, int which) {
+  if (!valid(sim)) return nullptr;
+  const char *name = nullptr;
+  guarded([&]() { name = sim->sim->component_name(which).c_str(); });
+  return name;
+}
+
+} // ~ extern "C"
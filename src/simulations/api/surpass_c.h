@@ -0,0 +1,102 @@
+/** @file surpass_c.h
+ * @brief C interface to SurpassSimulation, for programs and languages that can't use the C++ API directly
+ *
+ * All the functions returning <code>int</code> return 0 on success and -1 on failure; the reason of the most recent
+ * failure in the calling thread is given by <code>surpass_last_error()</code>. Coordinates are passed as flat arrays
+ * of x, y, z triplets. Passing a NULL handle is reported as a failure. A handle must not be used by two threads
+ * at the same time.
+ *
+ * @code
+ * surpass_simulation *sim = surpass_create(ca_xyz, n_residues, ss2_text, NULL);
+ * double temperatures[] = {2.0, 1.8, 1.6};
+ * surpass_set_cycles(sim, 10, 100, 1);
+ * surpass_setup_annealing(sim, temperatures, 3);
+ * if (surpass_run(sim) != 0) fprintf(stderr, "%s\n", surpass_last_error());
+ * surpass_coordinates(sim, 0, beads_xyz);
+ * surpass_destroy(sim);
+ * @endcode
+ */
+#ifndef SIMULATIONS_API_surpass_c_H
+#define SIMULATIONS_API_surpass_c_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Version of this interface.
+ *
+ * Incremented only when a function is removed or its signature changed; new functions may be added within a version.
+ */
+#define SURPASS_C_ABI_VERSION 2
+
+/// Opaque handle to a simulation
+typedef struct surpass_simulation surpass_simulation;
+
+/// Called after every outer cycle of every replica; replicas of REMC call it concurrently
+typedef void (*surpass_cycle_callback)(const surpass_simulation *sim, int replica, unsigned int cycle, void *user_data);
+
+/// Returns SURPASS_C_ABI_VERSION of the library
+int surpass_abi_version(void);
+
+/// Returns a description of the most recent error in the calling thread
+const char *surpass_last_error(void);
+
+/// Sets the location of the SURPASS database (force field parameters)
+void surpass_set_database(const char *path);
+
+/** @brief Creates a simulation of a single chain
+ * @param ca_xyz - coordinates of CA atoms, 3 * n_residues values
+ * @param n_residues - the number of residues
+ * @param ss2_text - secondary structure profile in the SS2 (PsiPred) format
+ * @param scoring_config - force field configuration; NULL to use the default one
+ * @return new simulation or NULL on failure
+ */
+surpass_simulation *surpass_create(const double *ca_xyz, int n_residues, const char *ss2_text,
+                                   const char *scoring_config);
+
+/// Releases a simulation
+void surpass_destroy(surpass_simulation *sim);
+
+/// Sets the number of inner and outer cycles and MC sweeps per inner cycle
+int surpass_set_cycles(surpass_simulation *sim, unsigned int inner, unsigned int outer, unsigned int cycle_size);
+
+/// Sets the maximum range of a single-bead move
+int surpass_set_move_range(surpass_simulation *sim, double range);
+
+/// Prepares simulated annealing over n temperatures
+int surpass_setup_annealing(surpass_simulation *sim, const double *temperatures, int n);
+
+/// Prepares replica exchange Monte Carlo at n temperatures
+int surpass_setup_replicas(surpass_simulation *sim, const double *temperatures, int n, unsigned int n_exchanges);
+
+/// Registers a callback; must be called after one of the setup functions
+int surpass_on_cycle(surpass_simulation *sim, surpass_cycle_callback callback, void *user_data);
+
+/// Runs the simulation
+int surpass_run(surpass_simulation *sim);
+
+/// Returns the number of replicas (systems) or -1 on failure
+int surpass_count_replicas(const surpass_simulation *sim);
+
+/// Returns the number of SURPASS beads of every replica or -1 on failure
+int surpass_count_beads(const surpass_simulation *sim);
+
+/// Copies coordinates of a replica into xyz, which must hold 3 * surpass_count_beads() values
+int surpass_coordinates(const surpass_simulation *sim, int replica, double *xyz);
+
+/// Stores the total energy of a replica in energy; since version 2 of this interface
+int surpass_energy(const surpass_simulation *sim, int replica, double *energy);
+
+/** @brief Copies weighted energy components of a replica
+ * @return the number of components, which may be larger than n_max; -1 on failure
+ */
+int surpass_energy_components(const surpass_simulation *sim, int replica, double *components, int n_max);
+
+/// Returns the name of an energy component or NULL
+const char *surpass_component_name(const surpass_simulation *sim, int which);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef SIMULATIONS_GENERIC_EVALUATORS_TMScoreEvaluator_HH
+#define SIMULATIONS_GENERIC_EVALUATORS_TMScoreEvaluator_HH
+
+#include <memory>
+#include <stdexcept>
+
+#include <core/real.hh>
+#include <core/data/basic/Vec3.hh>
+#include <core/data/structural/Structure.hh>
+#include <core/calc/structural/TMScore.hh>
+#include <utils/string_utils.hh>
+
+#include <simulations/systems/CartesianAtomsSimple.hh>
+#include <simulations/evaluators/Evaluator.hh>
+
+namespace simulations {
+namespace evaluators {
+namespace cartesian {
+
+/** @brief Evaluates TM-score of a system in respect to a reference structure.
+ *
+ * The reference structure must be given in the same representation as the system, e.g. as SURPASS beads.
+ * GDT_TS is computed at the same time; it can be reported by GdtTsEvaluator.
+ * @tparam C - the type used to express coordinates
+ */
+template <typename C>
+class TMScoreEvaluator : public Evaluator {
+public:
+
+  /** @brief Creates the evaluator
+   * @param reference - reference structure; must have as many atoms as the system
+   * @param system - TM-score of this system will be evaluated
+   */
+  TMScoreEvaluator(core::data::structural::Structure_SP reference, const systems::CartesianAtomsSimple<C> & system) :
+      xyz(system), tm(reference_coordinates(*reference)) {
+
+    if (tm.size() != xyz.n_atoms)
+      throw std::invalid_argument(utils::string_format("Reference structure has %d atoms while the system has %d\n",
+                                                       int(tm.size()), int(xyz.n_atoms)));
+  }
+
+  virtual core::real evaluate() {
+    tm.calculate(xyz.coordinates);
+    return tm.tm_score();
+  }
+
+  /// GDT_TS found by the most recent <code>evaluate()</code> call
+  core::real gdt_ts() const { return tm.gdt_ts(); }
+
+  virtual const std::string & name() const { return name_; }
+
+  virtual core::index1 precision() const { return 3; }
+
+  virtual core::index2 min_width() const { return 8; }
+
+  virtual ~TMScoreEvaluator() {}
+
+private:
+  const systems::CartesianAtomsSimple<C> & xyz;
+  core::calc::structural::TMScore tm;
+  static const std::string name_;
+
+  static std::vector<core::data::basic::Vec3> reference_coordinates(const core::data::structural::Structure & s) {
+    std::vector<core::data::basic::Vec3> v;
+    for (auto it = s.first_const_atom(); it != s.last_const_atom(); ++it) v.push_back(**it);
+    return v;
+  }
+};
+
+template<typename C>
+const std::string TMScoreEvaluator<C>::name_ = "TM-score";
+
+/** @brief Reports GDT_TS computed by a TMScoreEvaluator.
+ *
+ * This evaluator does not superimpose structures by itself: the TMScoreEvaluator it refers to must be evaluated
+ * first, e.g. by registering it in the same ObserveEvaluators object before this one.
+ * @tparam C - the type used to express coordinates
+ */
+template <typename C>
+class GdtTsEvaluator : public Evaluator {
+public:
+
+  /// Creates the evaluator reading GDT_TS from a given TM-score evaluator
+  GdtTsEvaluator(std::shared_ptr<TMScoreEvaluator<C>> tm_score) : tm(tm_score) {}
+
+  virtual core::real evaluate() { return tm->gdt_ts(); }
+
+  virtual const std::string & name() const { return name_; }
+
+  virtual core::index1 precision() const { return 3; }
+
+  virtual core::index2 min_width() const { return 7; }
+
+  virtual ~GdtTsEvaluator() {}
+
+private:
+  std::shared_ptr<TMScoreEvaluator<C>> tm;
+  static const std::string name_;
+};
+
+template<typename C>
+const std::string GdtTsEvaluator<C>::name_ = "GDT_TS";
+
+} // ~ cartesian
+} // ~ evaluators
+} // ~ simulations
+#endif
@@ -0,0 +1,51 @@
+/** @file CollectiveVariable.hh
+ * @brief Provides CollectiveVariable base class
+ */
+#ifndef SIMULATIONS_EVALUATORS_CV_CollectiveVariable_HH
+#define SIMULATIONS_EVALUATORS_CV_CollectiveVariable_HH
+
+#include <memory>
+
+#include <core/real.hh>
+#include <core/index.hh>
+
+#include <simulations/evaluators/Evaluator.hh>
+
+namespace simulations {
+namespace evaluators {
+namespace cv {
+
+/** @brief A collective variable (CV) is a scalar function of coordinates of a system, e.g. its radius of gyration.
+ *
+ * A CV is an Evaluator, so it can be observed as any other quantity. It is also the argument of bias energy terms
+ * (umbrella or metadynamics potentials), which call <code>evaluate_by_chunk()</code> before and after every Monte Carlo move.
+ * A derived class may update its value incrementally there, at the cost proportional to the number of moved atoms.
+ */
+class CollectiveVariable : public Evaluator {
+public:
+
+  /// Computes the value of this CV from scratch
+  virtual core::real evaluate() = 0;
+
+  /** @brief Computes the value of this CV after atoms from the range <code>[chunk_from, chunk_to]</code> might have been moved.
+   *
+   * This method assumes that since the previous call only the atoms given at that call and the atoms given now
+   * could have changed their positions. The default implementation simply calls <code>evaluate()</code>.
+   * @param chunk_from - the first moved atom
+   * @param chunk_to - the last moved atom (inclusive)
+   * @return the current value of this CV
+   */
+  virtual core::real evaluate_by_chunk(const core::index4 chunk_from, const core::index4 chunk_to) { return evaluate(); }
+
+  /// Virtual destructor
+  virtual ~CollectiveVariable() {}
+};
+
+/// Declares a shared pointer to CollectiveVariable type
+typedef std::shared_ptr<CollectiveVariable> CollectiveVariable_SP;
+
+} // ~ cv
+} // ~ evaluators
+} // ~ simulations
+
+#endif
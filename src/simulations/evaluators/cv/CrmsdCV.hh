@@ -0,0 +1,63 @@
+#ifndef SIMULATIONS_EVALUATORS_CV_CrmsdCV_HH
+#define SIMULATIONS_EVALUATORS_CV_CrmsdCV_HH
+
+#include <memory>
+
+#include <core/real.hh>
+#include <core/data/basic/Vec3.hh>
+#include <core/data/structural/Structure.hh>
+#include <core/calc/structural/transformations/Crmsd.hh>
+
+#include <simulations/systems/CartesianAtomsSimple.hh>
+#include <simulations/evaluators/cv/CollectiveVariable.hh>
+
+namespace simulations {
+namespace evaluators {
+namespace cv {
+
+/** @brief Crmsd to a reference structure used as a collective variable.
+ *
+ * This CV requires an optimal superposition, therefore it is always computed from scratch.
+ * @tparam C - the type used to express coordinates
+ */
+template<typename C>
+class CrmsdCV : public CollectiveVariable {
+public:
+
+  /** @brief Creates a CV that measures crmsd between a system and a reference structure
+   * @param reference - reference structure, e.g. the native; must be in the same representation as the system
+   * @param system - the system of interest
+   */
+  CrmsdCV(core::data::structural::Structure_SP reference, const systems::CartesianAtomsSimple<C> &system) :
+    n(reference->count_atoms()), xyz(system) {
+
+    ref = std::make_shared<core::data::basic::Coordinates>(n);
+    core::data::structural::structure_to_coordinates(reference, *ref);
+  }
+
+  virtual core::real evaluate() { return rms.crmsd(xyz.coordinates, *ref, n); }
+
+  virtual const std::string &name() const { return name_; }
+
+  virtual core::index1 precision() const { return 3; }
+
+  virtual core::index2 min_width() const { return 7; }
+
+  virtual ~CrmsdCV() {}
+
+private:
+  const core::index4 n;
+  core::data::basic::Coordinates_SP ref;
+  const systems::CartesianAtomsSimple<C> &xyz;
+  core::calc::structural::transformations::Crmsd<std::unique_ptr<core::data::basic::Vec3[]>, core::data::basic::Coordinates> rms;
+  static const std::string name_;
+};
+
+template<typename C>
+const std::string CrmsdCV<C>::name_ = "crmsd";
+
+} // ~ cv
+} // ~ evaluators
+} // ~ simulations
+
+#endif
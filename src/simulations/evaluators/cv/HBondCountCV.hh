@@ -0,0 +1,75 @@
+#ifndef SIMULATIONS_EVALUATORS_CV_HBondCountCV_HH
+#define SIMULATIONS_EVALUATORS_CV_HBondCountCV_HH
+
+#include <memory>
+
+#include <core/real.hh>
+#include <core/index.hh>
+
+#include <simulations/forcefields/surpass/SurpassHydrogenBond.hh>
+#include <simulations/evaluators/cv/CollectiveVariable.hh>
+
+namespace simulations {
+namespace evaluators {
+namespace cv {
+
+/** @brief The number of hydrogen bonds between beta strands used as a collective variable.
+ *
+ * The bonds are taken from <code>SurpassHydrogenBond::hydrogen_bonds()</code>. That energy term updates its list
+ * of hydrogen bonds whenever a beta residue is moved, so <code>evaluate_by_chunk()</code> just counts the bonds listed there.
+ * A bias term using this CV must therefore be added to the total energy <em>after</em> the hydrogen bond term.
+ * <code>evaluate()</code> recomputes the hydrogen bonds itself.
+ * @tparam C - the type used to express coordinates
+ */
+template<typename C>
+class HBondCountCV : public CollectiveVariable {
+public:
+
+  /** @brief Creates a CV counting hydrogen bonds found by a given energy term
+   * @param hb_energy - hydrogen bond energy term
+   * @param n_atoms - the number of atoms of the system, used by the energy term as "no partner" marker
+   */
+  HBondCountCV(std::shared_ptr<forcefields::surpass::SurpassHydrogenBond<C>> hb_energy, const core::index4 n_atoms) :
+    hb(hb_energy), n_atoms(n_atoms) {}
+
+  /// Finds hydrogen bonds from scratch and counts them
+  virtual core::real evaluate() {
+    hb->find_hydrogen_bonds();
+    return count();
+  }
+
+  /// Counts hydrogen bonds most recently found by the energy term
+  virtual core::real evaluate_by_chunk(const core::index4 chunk_from, const core::index4 chunk_to) { return count(); }
+
+  virtual const std::string &name() const { return name_; }
+
+  virtual core::index1 precision() const { return 0; }
+
+  virtual core::index2 min_width() const { return 4; }
+
+  virtual ~HBondCountCV() {}
+
+private:
+  std::shared_ptr<forcefields::surpass::SurpassHydrogenBond<C>> hb;
+  const core::index4 n_atoms;
+  static const std::string name_;
+
+  inline core::real count() const {
+
+    core::index4 n = 0;
+    for (const auto &p : hb->hydrogen_bonds()) {
+      if (p.first != n_atoms) ++n;
+      if (p.second != n_atoms) ++n;
+    }
+    return n;
+  }
+};
+
+template<typename C>
+const std::string HBondCountCV<C>::name_ = "n_hbonds";
+
+} // ~ cv
+} // ~ evaluators
+} // ~ simulations
+
+#endif
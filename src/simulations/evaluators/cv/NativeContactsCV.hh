@@ -0,0 +1,154 @@
+#ifndef SIMULATIONS_EVALUATORS_CV_NativeContactsCV_HH
+#define SIMULATIONS_EVALUATORS_CV_NativeContactsCV_HH
+
+#include <memory>
+#include <vector>
+#include <stdexcept>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/data/basic/Vec3.hh>
+#include <core/data/structural/Structure.hh>
+#include <utils/string_utils.hh>
+
+#include <simulations/systems/CartesianAtomsSimple.hh>
+#include <simulations/evaluators/cv/CollectiveVariable.hh>
+
+namespace simulations {
+namespace evaluators {
+namespace cv {
+
+/** @brief Fraction of native contacts (Q) used as a collective variable.
+ *
+ * A native contact is a pair of beads at least <code>min_separation</code> positions apart along the chain, whose distance
+ * in the native structure \f$ r^0_{ij} \f$ is below <code>cutoff</code>. The contact is formed when the current distance
+ * is below \f$ \lambda r^0_{ij} \f$, where \f$ \lambda \f$ is the <code>tolerance</code> factor. Contacts are stored for every
+ * bead in the compressed sparse row format, so the state of contacts may be updated only for beads that have been moved:
+ * <code>evaluate_by_chunk()</code> compares the current positions with a cached copy and re-checks contacts
+ * of the beads that differ. This covers both accepted and rejected (undone) moves at the cost proportional to
+ * the number of contacts of the moved beads.
+ * @tparam C - the type used to express coordinates
+ */
+template<typename C>
+class NativeContactsCV : public CollectiveVariable {
+public:
+
+  /** @brief Creates Q collective variable for a given system
+   * @param native - native structure in SURPASS representation; must have as many atoms as the system
+   * @param system - Q of this system will be evaluated
+   * @param cutoff - the longest distance between two beads in the native structure to call them a contact
+   * @param tolerance - a contact is formed when the distance is below <code>tolerance</code> times its native value
+   * @param min_separation - the smallest separation along the chain for a pair of beads to be considered
+   */
+  NativeContactsCV(const core::data::structural::Structure &native, const systems::CartesianAtomsSimple<C> &system,
+                   const core::real cutoff = 8.0, const core::real tolerance = 1.2,
+                   const core::index2 min_separation = 5) :
+    xyz(system), cached(new core::data::basic::Vec3[system.n_atoms]), row_start(system.n_atoms + 1, 0) {
+
+    std::vector<core::data::basic::Vec3> ref;
+    for (auto it = native.first_const_atom(); it != native.last_const_atom(); ++it) ref.push_back(**it);
+    if (ref.size() != xyz.n_atoms)
+      throw std::invalid_argument(utils::string_format("Native structure has %d atoms while the system has %d\n",
+                                                       int(ref.size()), int(xyz.n_atoms)));
+
+    // --- Every contact is listed in the rows of both its beads; both entries refer to the same contact index
+    const core::real cutoff2 = cutoff * cutoff;
+    std::vector<std::vector<std::pair<core::index4, core::index4>>> rows(xyz.n_atoms);
+    for (core::index4 i = 0; i < xyz.n_atoms; ++i)
+      for (core::index4 j = i + min_separation; j < xyz.n_atoms; ++j) {
+        const core::real d2 = ref[i].distance_square_to(ref[j]);
+        if (d2 >= cutoff2) continue;
+        rows[i].push_back(std::make_pair(j, formed_below2.size()));
+        rows[j].push_back(std::make_pair(i, formed_below2.size()));
+        formed_below2.push_back(d2 * tolerance * tolerance);
+      }
+    for (core::index4 i = 0; i < xyz.n_atoms; ++i) {
+      for (const auto &p : rows[i]) {
+        partner.push_back(p.first);
+        contact.push_back(p.second);
+      }
+      row_start[i + 1] = partner.size();
+    }
+    is_formed.assign(formed_below2.size(), 0);
+    evaluate();
+  }
+
+  /// Returns the number of native contacts
+  core::index4 count_contacts() const { return formed_below2.size(); }
+
+  /// Returns the number of native contacts formed at the most recent evaluation
+  core::index4 count_formed() const { return n_formed; }
+
+  /// Computes Q from scratch
+  virtual core::real evaluate() {
+
+    for (core::index4 i = 0; i < xyz.n_atoms; ++i) cached[i].set(xyz[i]);
+    n_formed = 0;
+    for (core::index4 i = 0; i < xyz.n_atoms; ++i)
+      for (core::index4 k = row_start[i]; k < row_start[i + 1]; ++k) {
+        if (partner[k] < i) continue; // --- every contact is checked once
+        is_formed[contact[k]] = (cached[i].distance_square_to(cached[partner[k]]) < formed_below2[contact[k]]);
+        n_formed += is_formed[contact[k]];
+      }
+    last_from = 1;
+    last_to = 0;
+    return q();
+  }
+
+  /// Updates Q for the beads moved by the most recent and the current Monte Carlo move
+  virtual core::real evaluate_by_chunk(const core::index4 chunk_from, const core::index4 chunk_to) {
+
+    sync(last_from, last_to);
+    sync(chunk_from, chunk_to);
+    last_from = chunk_from;
+    last_to = chunk_to;
+
+    return q();
+  }
+
+  /// Returns the name of this evaluator which is "Q"
+  virtual const std::string &name() const { return name_; }
+
+  virtual core::index1 precision() const { return 3; }
+
+  virtual core::index2 min_width() const { return 6; }
+
+  virtual ~NativeContactsCV() {}
+
+private:
+  const systems::CartesianAtomsSimple<C> &xyz;
+  std::unique_ptr<core::data::basic::Vec3[]> cached;
+  std::vector<core::index4> row_start; ///< contacts of bead i are stored at [row_start[i], row_start[i+1])
+  std::vector<core::index4> partner; ///< the other bead of a contact
+  std::vector<core::index4> contact; ///< index of a contact, shared by both its entries
+  std::vector<core::real> formed_below2; ///< squared distance below which a contact is formed
+  std::vector<char> is_formed;
+  core::index4 n_formed = 0;
+  core::index4 last_from = 1, last_to = 0;
+  static const std::string name_;
+
+  inline void sync(const core::index4 from, const core::index4 to) {
+
+    for (core::index4 i = from; i <= to; ++i) {
+      const C &c = xyz[i];
+      if ((c.x == cached[i].x) && (c.y == cached[i].y) && (c.z == cached[i].z)) continue;
+      cached[i].set(c);
+      for (core::index4 k = row_start[i]; k < row_start[i + 1]; ++k) {
+        const char f = (cached[i].distance_square_to(cached[partner[k]]) < formed_below2[contact[k]]);
+        n_formed += f - is_formed[contact[k]];
+        is_formed[contact[k]] = f;
+      }
+    }
+  }
+
+  inline core::real q() const { return (formed_below2.empty()) ? 0.0 : n_formed / core::real(formed_below2.size()); }
+};
+
+template<typename C>
+const std::string NativeContactsCV<C>::name_ = "Q";
+
+} // ~ cv
+} // ~ evaluators
+} // ~ simulations
+
+#endif
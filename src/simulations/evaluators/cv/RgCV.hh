@@ -0,0 +1,117 @@
+#ifndef SIMULATIONS_EVALUATORS_CV_RgCV_HH
+#define SIMULATIONS_EVALUATORS_CV_RgCV_HH
+
+#include <cmath>
+#include <memory>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/data/basic/Vec3.hh>
+
+#include <simulations/systems/CartesianAtomsSimple.hh>
+#include <simulations/evaluators/cv/CollectiveVariable.hh>
+
+namespace simulations {
+namespace evaluators {
+namespace cv {
+
+/** @brief Radius of gyration of a system used as a collective variable.
+ *
+ * The object keeps the sums \f$ \sum \vec{r}_i \f$ and \f$ \sum r_i^2 \f$ together with a copy of coordinates they were computed from.
+ * <code>evaluate_by_chunk()</code> updates the sums only for the atoms whose positions differ from the stored copy,
+ * so \f$ R_g \f$ is updated in a time proportional to the number of moved atoms. The sums are recomputed
+ * from scratch every <code>resync_every()</code> updates to avoid accumulation of round-off errors.
+ * @tparam C - the type used to express coordinates
+ */
+template<typename C>
+class RgCV : public CollectiveVariable {
+public:
+
+  /** @brief Creates \f$ R_g \f$ collective variable for a given system
+   * @param system - \f$ R_g \f$ of this system will be evaluated
+   */
+  RgCV(const systems::CartesianAtomsSimple<C> &system) : xyz(system), cached(new core::data::basic::Vec3[system.n_atoms]) {
+    evaluate();
+  }
+
+  /// Computes \f$ R_g \f$ from scratch
+  virtual core::real evaluate() {
+
+    sx = sy = sz = sq = 0.0;
+    for (core::index4 i = 0; i < xyz.n_atoms; ++i) {
+      cached[i].set(xyz[i]);
+      add(cached[i], 1.0);
+    }
+    last_from = 1;
+    last_to = 0;
+    n_updates = 0;
+    return rg();
+  }
+
+  /// Updates \f$ R_g \f$ for the atoms moved by the most recent and the current Monte Carlo move
+  virtual core::real evaluate_by_chunk(const core::index4 chunk_from, const core::index4 chunk_to) {
+
+    if (++n_updates >= resync_every_) return evaluate();
+    sync(last_from, last_to);
+    sync(chunk_from, chunk_to);
+    last_from = chunk_from;
+    last_to = chunk_to;
+
+    return rg();
+  }
+
+  /// Sets how often the sums are recomputed from scratch
+  void resync_every(const core::index4 n_updates) { resync_every_ = n_updates; }
+
+  /// Returns the name of this evaluator which is "Rg"
+  virtual const std::string &name() const { return name_; }
+
+  virtual core::index1 precision() const { return 3; }
+
+  virtual core::index2 min_width() const { return 7; }
+
+  virtual ~RgCV() {}
+
+private:
+  const systems::CartesianAtomsSimple<C> &xyz;
+  std::unique_ptr<core::data::basic::Vec3[]> cached;
+  double sx = 0, sy = 0, sz = 0, sq = 0;
+  core::index4 last_from = 1, last_to = 0;
+  core::index4 n_updates = 0;
+  core::index4 resync_every_ = 100000;
+  static const std::string name_;
+
+  inline void add(const core::data::basic::Vec3 &v, const double sign) {
+    sx += sign * v.x;
+    sy += sign * v.y;
+    sz += sign * v.z;
+    sq += sign * (double(v.x) * v.x + double(v.y) * v.y + double(v.z) * v.z);
+  }
+
+  inline void sync(const core::index4 from, const core::index4 to) {
+
+    for (core::index4 i = from; i <= to; ++i) {
+      const C &c = xyz[i];
+      if ((c.x == cached[i].x) && (c.y == cached[i].y) && (c.z == cached[i].z)) continue;
+      add(cached[i], -1.0);
+      cached[i].set(c);
+      add(cached[i], 1.0);
+    }
+  }
+
+  inline core::real rg() const {
+
+    const double n = xyz.n_atoms;
+    const double rg2 = sq / n - (sx * sx + sy * sy + sz * sz) / (n * n);
+    return (rg2 > 0) ? sqrt(rg2) : 0.0;
+  }
+};
+
+template<typename C>
+const std::string RgCV<C>::name_ = "Rg";
+
+} // ~ cv
+} // ~ evaluators
+} // ~ simulations
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SIMULATIONS_FORCEFIELDS_ByResidueDeltaEnergy_HH
+#define SIMULATIONS_FORCEFIELDS_ByResidueDeltaEnergy_HH
+
+#include <core/index.hh>
+
+namespace simulations {
+namespace forcefields {
+
+/** @brief Interface for an energy term that evaluates an energy change caused by a move in a single pass.
+ *
+ * A mover calls <code>calculate_by_chunk()</code> before a move and again after it, so every partner of the moved residues
+ * is visited twice. A term implementing this interface visits every partner once and evaluates its interaction
+ * with the old and the new positions of the moved residues side by side.
+ * @tparam C - the type used to express coordinates
+ */
+template<class C>
+class ByResidueDeltaEnergy {
+public:
+
+  /** @brief Calculates the energy change caused by a move of residues [chunk_from, chunk_to] (both inclusive).
+   *
+   * The system must already hold the new coordinates of the moved residues.
+   * @param chunk_from - index of the first moved residue
+   * @param chunk_to  - index of the last moved residue (inclusive)
+   * @param old_coordinates - coordinates of the system before the move, indexed as the system itself;
+   *    only the elements of the moved range are read
+   * @return energy after the move minus energy before the move
+   */
+  virtual double calculate_delta(const core::index2 chunk_from, const core::index2 chunk_to, const C *old_coordinates) = 0;
+
+  /// Virtual destructor
+  virtual ~ByResidueDeltaEnergy() { }
+};
+
+} // ~ simulations
+} // ~ ff
+#endif
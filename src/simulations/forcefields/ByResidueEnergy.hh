@@ -30,6 +30,14 @@ public:
    */
   virtual double calculate_by_chunk(const core::index2 chunk_from, const core::index2 chunk_to) = 0;
 
+  /** @brief Says whether this term can evaluate an energy change caused by a move directly.
+   *
+   * A term that returns true here also implements <code>ByResidueDeltaEnergy</code> interface for its coordinates type.
+   * Other terms are evaluated by a mover with <code>calculate_by_residue()</code> or <code>calculate_by_chunk()</code>
+   * called before and after a move.
+   */
+  virtual bool has_delta() const { return false; }
+
   /// Virtual destructor
   virtual ~ByResidueEnergy() { }
 };
@@ -0,0 +1,9 @@
+#include <simulations/forcefields/CVBiasEnergy.hh>
+
+namespace simulations {
+namespace forcefields {
+
+const std::string CVBiasEnergy::name_ = "CVBiasEnergy";
+
+} // ~ forcefields
+} // ~ simulations
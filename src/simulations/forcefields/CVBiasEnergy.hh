@@ -0,0 +1,141 @@
+/** @file CVBiasEnergy.hh
+ * @brief Provides CVBiasEnergy: harmonic or flat-bottom umbrella potential acting on a collective variable
+ */
+#ifndef SIMULATIONS_FORCEFIELDS_CVBiasEnergy_HH
+#define SIMULATIONS_FORCEFIELDS_CVBiasEnergy_HH
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <core/real.hh>
+#include <core/index.hh>
+
+#include <simulations/forcefields/ByResidueEnergy.hh>
+#include <simulations/systems/ResidueChain.hh>
+#include <simulations/evaluators/cv/CollectiveVariable.hh>
+
+namespace simulations {
+namespace forcefields {
+
+/// Functional form of an umbrella potential
+enum class BiasShape {
+  HARMONIC, ///< \f$ k (x - x_0)^2 \f$
+  FLAT_BOTTOM ///< zero within \f$ x_0 \pm w \f$, harmonic outside
+};
+
+/** @brief Umbrella potential acting on a collective variable (CV).
+ *
+ * The energy depends only on the value of a CV:
+ * \f[
+ *    U(x) = k (x - x_0)^2
+ * \f]
+ * (or a flat-bottom variant of it). Since this is a global term, both <code>calculate_by_residue()</code>
+ * and <code>calculate_by_chunk()</code> return the whole bias energy; the difference between the two calls made by a mover
+ * (before and after a move) is then the correct energy change. The CV is updated by its <code>evaluate_by_chunk()</code>
+ * method, which for some CVs (e.g. RgCV) takes time proportional to the number of moved atoms.
+ *
+ * The term can be added to TotalEnergyByResidue as any other energy component, e.g. for umbrella sampling.
+ */
+class CVBiasEnergy : public ByResidueEnergy {
+public:
+
+  /** @brief Creates an umbrella potential.
+   *
+   * @param system - the biased system; used to map residue indexes to atom indexes
+   * @param cv - collective variable to be restrained
+   * @param center - the center \f$ x_0 \f$ of the umbrella
+   * @param force_constant - the force constant \f$ k \f$
+   * @param shape - functional form of the bias
+   * @param half_width - half width \f$ w \f$ of a flat bottom, ignored for the harmonic potential
+   */
+  template<typename C>
+  CVBiasEnergy(const systems::ResidueChain<C> &system, evaluators::cv::CollectiveVariable_SP cv,
+               const core::real center, const core::real force_constant, const BiasShape shape = BiasShape::HARMONIC,
+               const core::real half_width = 0.0) : cv_(cv), center_(center), force_constant_(force_constant),
+                                                    half_width_(half_width), shape_(shape) {
+
+    for (core::index2 i = 0; i < system.count_residues(); ++i) {
+      first_atom.push_back(system.atoms_for_residue(i).first_atom);
+      last_atom.push_back(system.atoms_for_residue(i).last_atom);
+    }
+  }
+
+  /// Virtual destructor
+  virtual ~CVBiasEnergy() {}
+
+  /// Computes the bias energy from scratch
+  virtual double calculate() { return bias(cv_->evaluate()); }
+
+  /// Returns the bias energy after the given residue could have been moved
+  virtual double calculate_by_residue(const core::index2 which_residue) {
+    return bias(cv_->evaluate_by_chunk(first_atom[which_residue], last_atom[which_residue]));
+  }
+
+  /// Returns the bias energy after the given range of residues could have been moved
+  virtual double calculate_by_chunk(const core::index2 chunk_from, const core::index2 chunk_to) {
+    return bias(cv_->evaluate_by_chunk(first_atom[chunk_from], last_atom[chunk_to]));
+  }
+
+  /** @brief Evaluates the bias potential for a given value of the CV.
+   * @param x - value of the collective variable
+   * @return bias energy
+   */
+  inline double bias(const double x) const {
+
+    double d = x - center_;
+    if (shape_ == BiasShape::FLAT_BOTTOM) {
+      if (fabs(d) <= half_width_) return 0.0;
+      d = (d > 0) ? d - half_width_ : d + half_width_;
+    }
+    return force_constant_ * d * d;
+  }
+
+  /// The collective variable biased by this term
+  evaluators::cv::CollectiveVariable_SP cv() const { return cv_; }
+
+  /// The center of this umbrella
+  core::real center() const { return center_; }
+
+  /// The force constant of this umbrella
+  core::real force_constant() const { return force_constant_; }
+
+  /// Half-width of the flat bottom
+  core::real half_width() const { return half_width_; }
+
+  /// Functional form of this umbrella
+  BiasShape shape() const { return shape_; }
+
+  /** @brief Swaps umbrella parameters (center, force constant, shape) with another bias.
+   *
+   * This is how two umbrella windows exchange their replicas - the systems stay in place, only the potentials are swapped.
+   * @param other - another bias term
+   */
+  void swap_parameters(CVBiasEnergy &other) {
+    std::swap(center_, other.center_);
+    std::swap(force_constant_, other.force_constant_);
+    std::swap(half_width_, other.half_width_);
+    std::swap(shape_, other.shape_);
+  }
+
+  virtual const std::string &name() const { return name_; }
+
+private:
+  evaluators::cv::CollectiveVariable_SP cv_;
+  core::real center_;
+  core::real force_constant_;
+  core::real half_width_;
+  BiasShape shape_;
+  std::vector<core::index4> first_atom;
+  std::vector<core::index4> last_atom;
+  static const std::string name_;
+};
+
+/// Declares a shared pointer to CVBiasEnergy type
+typedef std::shared_ptr<CVBiasEnergy> CVBiasEnergy_SP;
+
+} // ~ forcefields
+} // ~ simulations
+
+#endif
@@ -29,6 +29,12 @@ public:
 
   const std::string & native_pdb() const { return substitutions.at("${NATIVE_PDB}"); }
 
+  /** @brief Appends a new line to the configuration, e.g. to add an energy term requested from a command line
+   *
+   * @param line - a line in the scoring config format: term name, its weight and parameters
+   */
+  void add_line(const std::string & line) { cfg += "\n" + line + "\n"; }
+
   const std::string &  substitute();
 
   const std::string &  str() const { return cfg; }
@@ -1,11 +1,14 @@
 #ifndef SIMULATIONS_FORCEFIELDS_LongRangeByResidues_HH
 #define SIMULATIONS_FORCEFIELDS_LongRangeByResidues_HH
 
+#include <stdexcept>
+
 #include <core/index.hh>
 #include <core/data/basic/Array2D.hh>
 
 #include <simulations/atom_indexing.hh>
 #include <simulations/forcefields/ByResidueEnergy.hh>
+#include <simulations/forcefields/ByResidueDeltaEnergy.hh>
 #include <simulations/systems/ResidueChain.hh>
 
 namespace simulations {
@@ -19,7 +22,7 @@ namespace forcefields {
  * @see calculate_by_residue(const core::index2) for details how energy is calculated.
  */
 template<class C>
-class LongRangeByResidues : public ByResidueEnergy {
+class LongRangeByResidues : public ByResidueEnergy, public ByResidueDeltaEnergy<C> {
 public:
 
   /** @brief Constructs an instance that will evaluate energy of a given system.
@@ -87,6 +90,45 @@ public:
     return energy;
   }
 
+  /** @brief Calculates the energy change caused by a move of residues from <code>chunk_from</code>
+   * to  <code>chunk_to</code> (both inclusive).
+   *
+   * Pairs of residues are visited in the same order as by <code>calculate_by_chunk()</code>, but each pair only once:
+   * <code>delta_kernel()</code> evaluates both the old and the new interaction. Available only when a derived class
+   * implements <code>delta_kernel()</code> and says so by <code>has_delta()</code>
+   * @param chunk_from - the first residue of the range
+   * @param chunk_to - the last residue of the range
+   * @param old_coordinates - coordinates before the move; only the moved range is read
+   * @return energy change
+   */
+  virtual inline double calculate_delta(const core::index2 chunk_from, const core::index2 chunk_to,
+                                        const C *old_coordinates) {
+
+    double delta = 0.0;
+    for (residue_index chunk_r = chunk_from; chunk_r <= chunk_to; ++chunk_r) {
+      const C &old_r = old_coordinates[chunk_r];
+      // --- Chunk interacting with upstream (e.g. N-terminal) residues
+      for (residue_index ir = 0;
+           ir <= std::min(int(chunk_r - correct_for_zero_offset - offset_), int(chunk_from-1)); ++ir) {
+        if (!delta_kernel(chunk_r, ir, old_r, the_system[ir], delta)) return std::numeric_limits<double>::max();
+      }
+
+      // Chunk interacting with downstream (e.g. C-terminal)  residues
+      for (core::index2 ir = std::max((core::index2)(chunk_to+1), (core::index2) (chunk_r + correct_for_zero_offset + offset_)); ir < n_residues; ++ir) {
+        if (!delta_kernel(chunk_r, ir, old_r, the_system[ir], delta)) return std::numeric_limits<double>::max();
+      }
+    }
+    // Chunk interacting with itself: both residues have been moved
+    for (core::index2 ir = chunk_from + offset_ ; ir <= chunk_to; ++ir) {
+      for (core::index2 jr = chunk_from; jr <= ir-offset_; ++jr) {
+        if (!delta_kernel(jr, ir, old_coordinates[jr], old_coordinates[ir], delta))
+          return std::numeric_limits<double>::max();
+      }
+    }
+
+    return delta;
+  }
+
   /** @brief Calculates energy of all atoms from <code>which_residue</code> interacting with all other residues in the system.
    *
    * Interactions will be calculated between residues <code>which_residue</code> and <code>another_residue</code> if and only if
@@ -176,6 +218,22 @@ public:
     return energy_kernel(the_moved_residue, the_other_residue, energy);
   };
 
+  /** @brief Evaluates the change of the interaction energy between a pair of residues.
+   *
+   * The current positions of the two residues are taken from the system. The default implementation throws
+   * an exception; a derived class that overrides this kernel must also override <code>has_delta()</code>
+   * @param the_moved_residue - the residue moved by a mover
+   * @param the_other_residue - another residue to calculate the pairwise energy
+   * @param moved_before - position of <code>the_moved_residue</code> before the move
+   * @param other_before - position of <code>the_other_residue</code> before the move
+   * @param delta - the new energy minus the old one will be accumulated there
+   * @return true if the new energy is finite, i.e. there is no 'hard' reason to reject the curernt MC move
+   */
+  virtual bool delta_kernel(const core::index2 the_moved_residue, const core::index2 the_other_residue,
+                            const C & moved_before, const C & other_before, double & delta) {
+    throw std::logic_error(name() + " can't evaluate an energy change directly\n");
+  }
+
   virtual inline double calculate() {
 
     double energy = 0.0;
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <limits>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+#include <utils/string_utils.hh>
+
+#include <simulations/forcefields/MetadynamicsBias.hh>
+
+namespace simulations {
+namespace forcefields {
+
+const std::string MetadynamicsBias::name_ = "MetadynamicsBias";
+
+void MetadynamicsBias::setup_grid() {
+
+  if ((axes_.size() < 1) || (axes_.size() > 2))
+    throw std::invalid_argument(utils::string_format("Metadynamics supports 1 or 2 CVs, %d given\n", int(axes_.size())));
+
+  for (core::index2 i = 0; i < axes_.size(); ++i) {
+    if (axes_[i].n_points < 2)
+      throw std::invalid_argument(utils::string_format("Metadynamics grid for %s must have at least 2 points\n",
+                                                       axes_[i].cv->name().c_str()));
+    n_points[i] = axes_[i].n_points;
+    spacing[i] = (axes_[i].max - axes_[i].min) / (n_points[i] - 1);
+    logger << utils::LogLevel::INFO << "grid for " << axes_[i].cv->name() << " from " << axes_[i].min << " to "
+           << axes_[i].max << " with " << int(n_points[i]) << " points, sigma: " << axes_[i].sigma << "\n";
+  }
+  grid.assign(n_points[0] * n_points[1], 0.0);
+}
+
+double MetadynamicsBias::bias(const core::real *s) const {
+
+  core::index4 i0[2] = {0, 0};
+  core::real t[2] = {0.0, 0.0};
+  for (core::index2 d = 0; d < axes_.size(); ++d) {
+    core::real x = (s[d] - axes_[d].min) / spacing[d];
+    if (x <= 0) x = 0;
+    if (x >= n_points[d] - 1) x = n_points[d] - 1.000001;
+    i0[d] = core::index4(x);
+    t[d] = x - i0[d];
+  }
+
+  if (axes_.size() == 1) return grid[i0[0]] * (1.0 - t[0]) + grid[i0[0] + 1] * t[0];
+
+  const core::index4 k = i0[1] * n_points[0] + i0[0];
+  return (grid[k] * (1.0 - t[0]) + grid[k + 1] * t[0]) * (1.0 - t[1]) +
+         (grid[k + n_points[0]] * (1.0 - t[0]) + grid[k + n_points[0] + 1] * t[0]) * t[1];
+}
+
+double MetadynamicsBias::calculate() {
+
+  core::real s[2] = {0.0, 0.0};
+  for (core::index2 d = 0; d < axes_.size(); ++d) s[d] = axes_[d].cv->evaluate();
+  return bias(s);
+}
+
+double MetadynamicsBias::calculate_by_atoms(const core::index4 atom_from, const core::index4 atom_to) {
+
+  core::real s[2] = {0.0, 0.0};
+  for (core::index2 d = 0; d < axes_.size(); ++d) s[d] = axes_[d].cv->evaluate_by_chunk(atom_from, atom_to);
+  return bias(s);
+}
+
+double MetadynamicsBias::deposit() {
+
+  core::real s[2] = {0.0, 0.0};
+  for (core::index2 d = 0; d < axes_.size(); ++d) s[d] = axes_[d].cv->evaluate();
+
+  double h = height_;
+  if (bias_factor_ > 1.0) h *= exp(-bias(s) / (temperature_ * (bias_factor_ - 1.0)));
+
+  // --- Hills are cut at 4 sigma, so a deposition costs only the grid points nearby
+  core::index4 from[2] = {0, 0}, to[2] = {0, 0};
+  for (core::index2 d = 0; d < axes_.size(); ++d) {
+    const core::real cut = 4.0 * axes_[d].sigma;
+    from[d] = core::index4(std::max(0.0, std::ceil((s[d] - cut - axes_[d].min) / spacing[d])));
+    const core::real last = std::floor((s[d] + cut - axes_[d].min) / spacing[d]);
+    to[d] = (last < 0) ? 0 : std::min(core::index4(last), core::index4(n_points[d] - 1));
+  }
+
+  std::vector<double> g0(n_points[0]);
+  for (core::index4 i = from[0]; i <= to[0]; ++i) {
+    const double dx = (axes_[0].min + i * spacing[0] - s[0]) / axes_[0].sigma;
+    g0[i] = exp(-0.5 * dx * dx);
+  }
+  if (axes_.size() == 1) {
+    for (core::index4 i = from[0]; i <= to[0]; ++i) grid[i] += h * g0[i];
+  } else {
+    for (core::index4 j = from[1]; j <= to[1]; ++j) {
+      const double dy = (axes_[1].min + j * spacing[1] - s[1]) / axes_[1].sigma;
+      const double g1 = h * exp(-0.5 * dy * dy);
+      double *row = &grid[j * n_points[0]];
+      for (core::index4 i = from[0]; i <= to[0]; ++i) row[i] += g0[i] * g1;
+    }
+  }
+  ++n_hills;
+
+  if (logger.is_logable(utils::LogLevel::FINE))
+    logger << utils::LogLevel::FINE << utils::string_format("hill %d of height %.4f deposited at %.3f %.3f\n",
+                                                            n_hills, h, s[0], s[1]);
+  return h;
+}
+
+void MetadynamicsBias::write_state(std::ostream &out) const {
+
+  out << "# metadynamics " << axes_.size() << " " << n_hills << "\n";
+  for (const auto &a : axes_)
+    out << "# " << a.cv->name() << " " << a.min << " " << a.max << " " << a.n_points << " " << a.sigma << "\n";
+  out << std::setprecision(12);
+  for (core::index4 j = 0; j < n_points[1]; ++j) {
+    for (core::index4 i = 0; i < n_points[0]; ++i) out << ' ' << grid[j * n_points[0] + i];
+    out << "\n";
+  }
+  out.flush();
+}
+
+void MetadynamicsBias::read_state(std::istream &in) {
+
+  std::string hash, keyword, cv_name;
+  core::index2 n_dim;
+  core::index4 hills;
+  in >> hash >> keyword >> n_dim >> hills;
+  if ((keyword != "metadynamics") || (n_dim != axes_.size()))
+    throw std::invalid_argument("Metadynamics state does not match the number of collective variables\n");
+  // --- the state is written with 6 significant digits, so real values are compared with a relative tolerance
+  auto differ = [](const core::real stored, const core::real current) {
+    return fabs(stored - current) > 1.0e-5 * std::max(core::real(1.0), fabs(current));
+  };
+  for (const auto &a : axes_) {
+    core::real min, max, sigma;
+    core::index2 n;
+    in >> hash >> cv_name >> min >> max >> n >> sigma;
+    if ((cv_name != a.cv->name()) || (n != a.n_points) || differ(min, a.min) || differ(max, a.max)
+        || differ(sigma, a.sigma))
+      throw std::invalid_argument(utils::string_format(
+        "Metadynamics state for %s (grid %g..%g, %d points, sigma %g) does not match %s (grid %g..%g, %d points, sigma %g)\n",
+        cv_name.c_str(), min, max, int(n), sigma, a.cv->name().c_str(), a.min, a.max, int(a.n_points), a.sigma));
+  }
+  for (double &v : grid) in >> v;
+  if (!in) throw std::invalid_argument("Metadynamics state is incomplete\n");
+  n_hills = hills;
+  logger << utils::LogLevel::INFO << "bias restored from " << size_t(n_hills) << " hills\n";
+}
+
+void MetadynamicsBias::write_fes(std::ostream &out) const {
+
+  const double factor = (bias_factor_ > 1.0) ? -bias_factor_ / (bias_factor_ - 1.0) : -1.0;
+  double min_f = std::numeric_limits<double>::max();
+  for (double v : grid) min_f = std::min(min_f, factor * v);
+
+  out << "#";
+  for (const auto &a : axes_) out << std::setw(10) << a.cv->name();
+  out << "          F          V\n";
+  for (core::index4 j = 0; j < n_points[1]; ++j) {
+    for (core::index4 i = 0; i < n_points[0]; ++i) {
+      const double v = grid[j * n_points[0] + i];
+      out << utils::string_format("%10.4f", axes_[0].min + i * spacing[0]);
+      if (axes_.size() == 2) out << utils::string_format("%10.4f", axes_[1].min + j * spacing[1]);
+      out << utils::string_format(" %10.4f %10.4f\n", factor * v - min_f, v);
+    }
+    if (axes_.size() == 2) out << "\n";
+  }
+  out.flush();
+}
+
+} // ~ forcefields
+} // ~ simulations
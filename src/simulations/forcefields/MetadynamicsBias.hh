@@ -0,0 +1,159 @@
+/** @file MetadynamicsBias.hh
+ * @brief Provides MetadynamicsBias: well-tempered metadynamics potential stored on a grid
+ */
+#ifndef SIMULATIONS_FORCEFIELDS_MetadynamicsBias_HH
+#define SIMULATIONS_FORCEFIELDS_MetadynamicsBias_HH
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <core/real.hh>
+#include <core/index.hh>
+
+#include <utils/Logger.hh>
+
+#include <simulations/forcefields/ByResidueEnergy.hh>
+#include <simulations/systems/ResidueChain.hh>
+#include <simulations/evaluators/cv/CollectiveVariable.hh>
+
+namespace simulations {
+namespace forcefields {
+
+/// Defines a collective variable biased by metadynamics and the grid the bias is tabulated on
+struct MetadynamicsAxis {
+  evaluators::cv::CollectiveVariable_SP cv; ///< the collective variable
+  core::real min; ///< the first grid point
+  core::real max; ///< the last grid point
+  core::index2 n_points; ///< the number of grid points (at least 2)
+  core::real sigma; ///< width of Gaussian hills along this CV
+};
+
+/** @brief Well-tempered metadynamics bias in one or two collective variables.
+ *
+ * The bias potential \f$ V(s) \f$ is tabulated on a regular grid. Evaluation is a bilinear interpolation
+ * between the grid points surrounding the current CV value, which takes a constant time regardless of how many
+ * hills have been deposited. Outside the grid the bias is clamped to its value at the border.
+ *
+ * A new Gaussian hill is added to the grid by <code>deposit()</code>; its height is scaled down according
+ * to the well-tempered scheme:
+ * \f[
+ *    w = w_0 \exp\left(-\frac{V(s)}{k_B \Delta T}\right) \qquad \Delta T = T(\gamma - 1)
+ * \f]
+ * where \f$ \gamma \f$ is the bias factor. Deposition must not happen between the two energy evaluations made by a mover,
+ * so it is called from an observer (see ObserveMetadynamics) every N Monte Carlo cycles.
+ *
+ * As any other CV bias, <code>calculate_by_residue()</code> and <code>calculate_by_chunk()</code> return the whole
+ * bias energy, so their difference before and after a move is the energy change.
+ */
+class MetadynamicsBias : public ByResidueEnergy {
+public:
+
+  /** @brief Creates a metadynamics bias with no hills deposited yet.
+   *
+   * @param system - the biased system; used to map residue indexes to atom indexes
+   * @param axes - definition of one or two collective variables
+   * @param height - initial height \f$ w_0 \f$ of a Gaussian hill
+   * @param bias_factor - well-tempered bias factor \f$ \gamma \f$; value not greater than 1.0 turns off well-tempering
+   * @param temperature - simulation temperature
+   */
+  template<typename C>
+  MetadynamicsBias(const systems::ResidueChain<C> &system, const std::vector<MetadynamicsAxis> &axes,
+                   const core::real height, const core::real bias_factor, const core::real temperature) :
+    axes_(axes), height_(height), bias_factor_(bias_factor), temperature_(temperature), logger("MetadynamicsBias") {
+
+    for (core::index2 i = 0; i < system.count_residues(); ++i) {
+      first_atom.push_back(system.atoms_for_residue(i).first_atom);
+      last_atom.push_back(system.atoms_for_residue(i).last_atom);
+    }
+    setup_grid();
+  }
+
+  /// Virtual destructor
+  virtual ~MetadynamicsBias() {}
+
+  /// Computes the bias energy from scratch
+  virtual double calculate();
+
+  /// Returns the bias energy after the given residue could have been moved
+  virtual double calculate_by_residue(const core::index2 which_residue) {
+    return calculate_by_atoms(first_atom[which_residue], last_atom[which_residue]);
+  }
+
+  /// Returns the bias energy after the given range of residues could have been moved
+  virtual double calculate_by_chunk(const core::index2 chunk_from, const core::index2 chunk_to) {
+    return calculate_by_atoms(first_atom[chunk_from], last_atom[chunk_to]);
+  }
+
+  /** @brief Evaluates the bias potential at a given point of the CV space.
+   * @param s - values of the collective variables (the second value is ignored for a 1D bias)
+   * @return bias energy interpolated from the grid
+   */
+  double bias(const core::real *s) const;
+
+  /** @brief Adds a Gaussian hill centered at the current values of the collective variables.
+   * @return height of the deposited hill
+   */
+  double deposit();
+
+  /// Returns the number of hills deposited so far
+  core::index4 count_hills() const { return n_hills; }
+
+  /// Returns the number of collective variables (1 or 2)
+  core::index2 count_dimensions() const { return axes_.size(); }
+
+  /// Returns the definition of the collective variables
+  const std::vector<MetadynamicsAxis> &axes() const { return axes_; }
+
+  /** @brief Writes the complete state of the bias (grid definition, hills count and the grid itself) to a stream.
+   *
+   * The state may be loaded back with <code>read_state()</code> to continue a simulation
+   * @param out - output stream
+   */
+  void write_state(std::ostream &out) const;
+
+  /** @brief Loads the state written by <code>write_state()</code>.
+   *
+   * @param in - input stream
+   * @throw std::invalid_argument when the CVs, grid ranges, numbers of grid points or hill widths stored in the stream
+   *    differ from those of this object
+   */
+  void read_state(std::istream &in);
+
+  /** @brief Writes the free energy surface estimated from the bias.
+   *
+   * For well-tempered metadynamics \f$ F(s) = -\frac{\gamma}{\gamma-1} V(s) \f$, otherwise \f$ F(s) = -V(s) \f$.
+   * The surface is shifted so its minimum is zero. Each row of the output holds CV value(s), F and V.
+   * @param out - output stream
+   */
+  void write_fes(std::ostream &out) const;
+
+  virtual const std::string &name() const { return name_; }
+
+private:
+  std::vector<MetadynamicsAxis> axes_;
+  core::real height_;
+  core::real bias_factor_;
+  core::real temperature_;
+  core::index4 n_hills = 0;
+  core::real spacing[2] = {1.0, 1.0};
+  core::index2 n_points[2] = {1, 1};
+  std::vector<double> grid; ///< bias values; the first CV index runs fastest
+  std::vector<core::index4> first_atom;
+  std::vector<core::index4> last_atom;
+  utils::Logger logger;
+  static const std::string name_;
+
+  void setup_grid();
+
+  double calculate_by_atoms(const core::index4 atom_from, const core::index4 atom_to);
+};
+
+/// Declares a shared pointer to MetadynamicsBias type
+typedef std::shared_ptr<MetadynamicsBias> MetadynamicsBias_SP;
+
+} // ~ forcefields
+} // ~ simulations
+
+#endif
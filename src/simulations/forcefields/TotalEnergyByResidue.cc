@@ -1,3 +1,5 @@
+#include <stdexcept>
+
 #include <core/index.hh>
 
 #include <simulations/forcefields/TotalEnergyByResidue.hh>
@@ -7,6 +9,14 @@ namespace forcefields {
 
 double TotalEnergyByResidue::calculate_by_residue(const core::index2 which_residue) {
   double en = 0.0;
+  if (profiler) {
+    for (core::index2 i = 0; i < components.size(); ++i) {
+      profiler->start(sections[i]);
+      en += components[i]->calculate_by_residue(which_residue) * factors[i];
+      profiler->stop(sections[i]);
+    }
+    return en;
+  }
   for (core::index2 i = 0; i < components.size(); ++i)
     en += components[i]->calculate_by_residue(which_residue) * factors[i];
   return en;
@@ -14,11 +24,92 @@ double TotalEnergyByResidue::calculate_by_residue(const core::index2 which_resid
 
 double TotalEnergyByResidue::calculate_by_chunk(const core::index2 chunk_from, const core::index2 chunk_to) {
   double en = 0.0;
+  if (profiler) {
+    for (core::index2 i = 0; i < components.size(); ++i) {
+      profiler->start(sections[i]);
+      en += components[i]->calculate_by_chunk(chunk_from, chunk_to) * factors[i];
+      profiler->stop(sections[i]);
+    }
+    return en;
+  }
   for (core::index2 i = 0; i < components.size(); ++i)
     en += components[i]->calculate_by_chunk(chunk_from, chunk_to) * factors[i];
   return en;
 }
 
+double TotalEnergyByResidue::calculate_by_residue_without_delta(const core::index2 which_residue) {
+
+  double en = 0.0;
+  for (core::index2 i = 0; i < components.size(); ++i) {
+    if (components[i]->has_delta() || is_surrogate(i)) continue;
+    if (profiler) profiler->start(sections[i]);
+    en += components[i]->calculate_by_residue(which_residue) * factors[i];
+    if (profiler) profiler->stop(sections[i]);
+  }
+  return en;
+}
+
+double TotalEnergyByResidue::calculate_by_chunk_without_delta(const core::index2 chunk_from, const core::index2 chunk_to) {
+
+  double en = 0.0;
+  for (core::index2 i = 0; i < components.size(); ++i) {
+    if (components[i]->has_delta() || is_surrogate(i)) continue;
+    if (profiler) profiler->start(sections[i]);
+    en += components[i]->calculate_by_chunk(chunk_from, chunk_to) * factors[i];
+    if (profiler) profiler->stop(sections[i]);
+  }
+  return en;
+}
+
+void TotalEnergyByResidue::surrogate(const std::vector<std::string> &term_names) {
+
+  in_surrogate.assign(components.size(), false);
+  n_surrogate_terms = 0;
+  for (const std::string &name : term_names) {
+    core::index2 i = 0;
+    while ((i < components.size()) && (components[i]->name() != name)) ++i;
+    if (i == components.size())
+      throw std::invalid_argument("Can't use " + name + " as a surrogate energy: no such term in the force field\n");
+    if (in_surrogate[i]) continue;
+    in_surrogate[i] = true;
+    ++n_surrogate_terms;
+    logger << utils::LogLevel::INFO << name << " used as a surrogate energy for delayed acceptance\n";
+  }
+  n_screened = n_passed = 0;
+}
+
+double TotalEnergyByResidue::calculate_surrogate_by_residue(const core::index2 which_residue) {
+
+  double en = 0.0;
+  for (core::index2 i = 0; i < components.size(); ++i) {
+    if (!is_surrogate(i)) continue;
+    if (profiler) profiler->start(sections[i]);
+    en += components[i]->calculate_by_residue(which_residue) * factors[i];
+    if (profiler) profiler->stop(sections[i]);
+  }
+  return en;
+}
+
+double TotalEnergyByResidue::calculate_surrogate_by_chunk(const core::index2 chunk_from, const core::index2 chunk_to) {
+
+  double en = 0.0;
+  for (core::index2 i = 0; i < components.size(); ++i) {
+    if (!is_surrogate(i)) continue;
+    if (profiler) profiler->start(sections[i]);
+    en += components[i]->calculate_by_chunk(chunk_from, chunk_to) * factors[i];
+    if (profiler) profiler->stop(sections[i]);
+  }
+  return en;
+}
+
+void TotalEnergyByResidue::profile(std::shared_ptr<utils::PerfCounters> counters) {
+
+  profiler = counters;
+  sections.clear();
+  if (profiler)
+    for (const auto &c : components) sections.push_back(profiler->section("energy:" + c->name()));
+}
+
 const std::string TotalEnergyByResidue::name_ = "TotalEnergyByResidue";
 
 std::string TotalEnergyByResidue::header_string() const {
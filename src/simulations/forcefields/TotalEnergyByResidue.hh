@@ -8,9 +8,11 @@
 #include <core/data/basic/Array2D.hh>
 
 #include <utils/Logger.hh>
+#include <utils/PerfCounters.hh>
 
 #include <simulations/forcefields/TotalEnergy.hh>
 #include <simulations/forcefields/ByResidueEnergy.hh>
+#include <simulations/forcefields/ByResidueDeltaEnergy.hh>
 #include <simulations/evaluators/Evaluator.hh>
 
 namespace simulations {
@@ -41,10 +43,104 @@ public:
 
   virtual double calculate_by_chunk(const core::index2 chunk_from, const core::index2 chunk_to);
 
+  /** @brief Selects the components that make a cheap surrogate energy for delayed-acceptance Monte Carlo.
+   *
+   * When a surrogate is defined, a mover first evaluates a move with the surrogate terms only and tests it
+   * with the Metropolis criterion. A move that passes this test is evaluated again with the remaining terms
+   * and must pass the second test on the remaining energy change. Since the total energy change is the sum
+   * of the two, the product of the two acceptance probabilities satisfies detailed balance for the total energy,
+   * exactly as the single-stage test does. Moves rejected by the first test never pay for the expensive terms.
+   * @param term_names - names of energy terms, as returned by their <code>name()</code> methods; an empty vector
+   *    turns the delayed acceptance off
+   */
+  void surrogate(const std::vector<std::string> &term_names);
+
+  /// Returns true if a surrogate energy has been defined
+  bool has_surrogate() const { return n_surrogate_terms > 0; }
+
+  /// Energy of a given residue evaluated by the surrogate terms only
+  double calculate_surrogate_by_residue(const core::index2 which_residue);
+
+  /// Energy of a given chunk evaluated by the surrogate terms only
+  double calculate_surrogate_by_chunk(const core::index2 chunk_from, const core::index2 chunk_to);
+
+  /** @brief Records the outcome of a first-stage (surrogate) test; called by movers
+   * @param passed - true if the move has been passed to the full evaluation
+   */
+  void count_screening(const bool passed) {
+    ++n_screened;
+    if (passed) ++n_passed;
+  }
+
+  /// The number of moves tested with the surrogate energy
+  core::index4 count_screened() const { return n_screened; }
+
+  /// The number of moves that passed the surrogate test and were evaluated with the remaining terms
+  core::index4 count_passed() const { return n_passed; }
+
+  /** @brief Same as <code>calculate_by_residue()</code>, but skips the components that evaluate a move directly.
+   *
+   * Components of a surrogate energy are skipped as well, if the surrogate has been defined.
+   *
+   * Together with <code>calculate_delta()</code> this allows a mover to evaluate a move in a single pass over partners
+   * for the terms that support it, and before and after the move for all the other terms:
+   * @code
+   * double before = energy.calculate_by_residue_without_delta(i);
+   * // --- backup coordinates of the residue i and move it
+   * double after = energy.calculate_by_residue_without_delta(i) + energy.calculate_delta(i, i, backup);
+   * @endcode
+   * @param which_residue - the residue of interest
+   * @return energy for a given residue
+   */
+  double calculate_by_residue_without_delta(const core::index2 which_residue);
+
+  /** @brief Same as <code>calculate_by_chunk()</code>, but skips the components that evaluate a move directly.
+   * @see calculate_by_residue_without_delta(const core::index2)
+   */
+  double calculate_by_chunk_without_delta(const core::index2 chunk_from, const core::index2 chunk_to);
+
+  /** @brief Weighted sum of energy changes of the components that evaluate a move directly.
+   * @param chunk_from - index of the first moved residue
+   * @param chunk_to  - index of the last moved residue (inclusive)
+   * @param old_coordinates - coordinates before the move; only the moved range is read
+   * @tparam C - the type used to express coordinates
+   * @return energy change; 0.0 if none of the components <code>has_delta()</code>
+   */
+  template<class C>
+  double calculate_delta(const core::index2 chunk_from, const core::index2 chunk_to, const C *old_coordinates) {
+
+    double en = 0.0;
+    for (core::index2 i = 0; i < components.size(); ++i) {
+      if ((!components[i]->has_delta()) || is_surrogate(i)) continue;
+      if (profiler) profiler->start(sections[i]);
+      en += dynamic_cast<ByResidueDeltaEnergy<C> &>(*components[i]).calculate_delta(chunk_from, chunk_to,
+        old_coordinates) * factors[i];
+      if (profiler) profiler->stop(sections[i]);
+    }
+    return en;
+  }
+
+  /** @brief Measures time and hardware events spent by every energy term.
+   *
+   * Every call of <code>calculate_by_residue()</code> and <code>calculate_by_chunk()</code> will be attributed
+   * to a section named after the energy term. Components must be added before this call.
+   * @param counters - counters used to measure the terms; <code>nullptr</code> turns the measurements off
+   */
+  void profile(std::shared_ptr<utils::PerfCounters> counters);
+
 private:
   utils::Logger logger;
+  std::shared_ptr<utils::PerfCounters> profiler = nullptr;
+  std::vector<core::index2> sections; ///< index of the profiler section for every component
+  std::vector<bool> in_surrogate; ///< true for the components that make the surrogate energy
+  core::index2 n_surrogate_terms = 0;
+  core::index4 n_screened = 0, n_passed = 0;
   static const std::string name_;
 
+  bool is_surrogate(const core::index2 which_component) const {
+    return (which_component < in_surrogate.size()) && in_surrogate[which_component];
+  }
+
   friend std::ostream &operator<<(std::ostream &out, const TotalEnergyByResidue &e);
 };
 
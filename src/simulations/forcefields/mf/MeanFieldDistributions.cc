@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <mutex>
 
 #include <core/SURPASSenvironment.hh>
 #include <core/calc/numeric/interpolators.hh>
@@ -21,9 +22,19 @@ using namespace core::calc::numeric;
 
 std::shared_ptr<MeanFieldDistributions> load_1D_distributions(const std::string & ff_file, const core::real pseudocounts_fraction) {
 
+  // --- Distributions are never modified once loaded, so every energy term created by this process may share them
+  static std::map<std::pair<std::string, core::real>, std::shared_ptr<MeanFieldDistributions>> loaded;
+  static std::mutex loaded_mutex;
+
+  const std::string fname = core::SURPASSenvironment::from_file_or_db(ff_file);
+  std::lock_guard<std::mutex> lock(loaded_mutex);
+  const auto file_key = std::make_pair(fname, pseudocounts_fraction);
+  auto cached = loaded.find(file_key);
+  if (cached != loaded.end()) return cached->second;
+
   utils::Logger logger("load_1D_distributions");
   logger << utils::LogLevel::FILE << "Reading ff file: " << ff_file << "\n";
-  std::ifstream in(core::SURPASSenvironment::from_file_or_db(ff_file));
+  std::ifstream in(fname);
   std::string line, key;
   std::vector<double> x;
   std::vector<double> y;
@@ -78,6 +89,7 @@ std::shared_ptr<MeanFieldDistributions> load_1D_distributions(const std::string
         << keys.size() << "\n";
   }
 
+  loaded[file_key] = mf_sp;
   return mf_sp;
 }
 
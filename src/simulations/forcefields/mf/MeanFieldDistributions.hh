@@ -100,7 +100,8 @@ private:
 /** @brief Loads the components from a file.
  *
  * This method can also convert probabilities to energies. The conversion is done always when the given
- * pseudocounts fraction is non-negative. By default it <strong>is</strong> set to <code>-1</code>, so no conversion is applied
+ * pseudocounts fraction is non-negative. By default it <strong>is</strong> set to <code>-1</code>, so no conversion is applied.
+ * A file is parsed only once per process: subsequent calls with the same arguments return the same (shared) object.
  *
  * @param ff_file - the name of file with energy functions
  * @param pseudocounts - pseudocounts fraction used to convert probabilities into energy values
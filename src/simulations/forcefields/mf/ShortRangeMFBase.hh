@@ -71,6 +71,10 @@ public:
 
   core::real score_property(core::index2 which_residue,core::real value) const {
 
+    if (table_ != nullptr) { // --- tabulation mode: energy for every HEC combination is stored rather than summed
+      for (int j = 0; j < 9; ++j) (*table_)[which_residue * 9 + j] += (*ff_for_sequence_[j][which_residue])(value);
+      return 0.0;
+    }
     const core::data::sequence::HecFractions ss_first = sequence()->fractions(which_residue + first_aa_pos);
     const core::data::sequence::HecFractions ss_secnd = sequence()->fractions(which_residue + second_aa_pos);
 
@@ -84,6 +88,46 @@ public:
     return en;
   }
 
+  /** @brief Tabulates the energy of the current conformation as a function of secondary structure.
+   *
+   * The energy evaluated by <code>calculate()</code> is a bilinear form in the secondary structure fractions:
+   * \f[ E = \sum_i \sum_{j,k} T_{i,3j+k} f_j(i+a) f_k(i+b) \f]
+   * where \f$ f_j(i) \f$ is the fraction of H, E or C at position \f$ i \f$ and \f$ a, b \f$ are
+   * <code>first_aa_pos</code> and <code>second_aa_pos</code>. This method computes the coefficients \f$ T \f$ for the
+   * current conformation, so the energy may be evaluated for any secondary structure profile by <code>score_table()</code>
+   * without touching the coordinates.
+   * @param table - the coefficients; the vector is resized to <code>9 * (last_positions_scored + 1)</code>
+   */
+  void tabulate(std::vector<core::real> &table) {
+
+    table.assign(9 * (ShortRangeEnergyBase<C>::last_positions_scored + 1), 0.0);
+    table_ = &table;
+    ShortRangeEnergyBase<C>::calculate();
+    table_ = nullptr;
+  }
+
+  /** @brief Evaluates energy from coefficients computed by <code>tabulate()</code>.
+   *
+   * @param table - coefficients of the bilinear form
+   * @param h - fraction of helix at every position of the SURPASS chain
+   * @param e - fraction of strand at every position of the SURPASS chain
+   * @param c - fraction of coil at every position of the SURPASS chain
+   * @return energy the conformation would have if it had the given secondary structure
+   */
+  core::real score_table(const std::vector<core::real> &table, const core::real *h, const core::real *e,
+                         const core::real *c) const {
+
+    core::real en = 0.0;
+    const core::index4 n = table.size() / 9;
+    for (core::index4 i = 0; i < n; ++i) {
+      const core::real *t = &table[i * 9];
+      const core::index4 a = i + first_aa_pos, b = i + second_aa_pos;
+      en += h[a] * (t[0] * h[b] + t[1] * e[b] + t[2] * c[b]) + e[a] * (t[3] * h[b] + t[4] * e[b] + t[5] * c[b]) +
+            c[a] * (t[6] * h[b] + t[7] * e[b] + t[8] * c[b]);
+    }
+    return en;
+  }
+
 protected:
   const core::data::sequence::SecondaryStructure_SP scored_secondary;
   std::vector<std::vector<EnergyComponent_SP>> ff_for_sequence_; // 9 elements for each HEC combination
@@ -119,6 +163,7 @@ protected:
   }
 
 private:
+  std::vector<core::real> *table_ = nullptr; ///< when not null, score_property() fills this table instead of scoring
 
   inline core::index1 ss_to_index(const core::index1 first_ss,const core::index1 second_ss) const { return first_ss * 3 + second_ss; }
 
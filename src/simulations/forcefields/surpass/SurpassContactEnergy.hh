@@ -4,6 +4,7 @@
 #include <core/real.hh>
 #include <core/index.hh>
 
+#include <core/SURPASSenvironment.hh>
 #include <core/data/io/DataTable.hh>
 #include <simulations/systems/surpass/SurpassModel.hh>
 #include <simulations/forcefields/LongRangeByResidues.hh>
@@ -90,6 +91,81 @@ public:
     return true;
   }
 
+  /// This term evaluates a move in a single pass over partner residues
+  virtual bool has_delta() const { return true; }
+
+  /** @brief Evaluates the change of the contact energy between two residues, one pass for the old and the new positions.
+   *
+   * Interaction parameters of the pair are found once and the two squared distances are compared against them;
+   * the result is the same as the difference of two <code>energy_kernel()</code> calls.
+   */
+  bool delta_kernel(const core::index2 moved_residue, const core::index2 the_other_residue, const C &moved_before,
+                    const C &other_before, double &delta) {
+
+    real shortest2, premium2, longest2, premium_energy;
+    if (!pair_parameters(moved_residue, the_other_residue, shortest2, premium2, longest2, premium_energy)) return true;
+
+    C o_i, o_j;
+    the_system[moved_residue].wrap(o_i);
+    the_system[the_other_residue].wrap(o_j);
+    delta += contact_energy(o_i, o_j, shortest2, premium2, longest2, premium_energy);
+    moved_before.wrap(o_i);
+    other_before.wrap(o_j);
+    delta -= contact_energy(o_i, o_j, shortest2, premium2, longest2, premium_energy);
+
+    return true;
+  }
+
+  /** @brief Parameters of the interaction between two residues, as evaluated by <code>energy_kernel()</code>.
+   *
+   * The returned distances are squared, so they can be compared directly with a squared distance between the two residues.
+   * These parameters depend only on the secondary structure of the system, therefore they may be tabulated
+   * once for the whole simulation.
+   * @param moved_residue - index of the first residue
+   * @param the_other_residue - index of the second residue
+   * @param shortest2 - below this squared distance <code>high_energy_level</code> is added
+   * @param premium2 - above this squared distance <code>premium_energy</code> is added
+   * @param longest2 - above this squared distance the two residues do not interact
+   * @param premium_energy - energy of a contact: <code>low_energy_level</code> or 0.0 if the contact is not allowed
+   * @return false if the two residues never interact; the remaining parameters are not set then
+   */
+  bool pair_parameters(const core::index2 moved_residue, const core::index2 the_other_residue, real &shortest2,
+                       real &premium2, real &longest2, real &premium_energy) const {
+
+    if (the_system.ss_element_for_atoms()[moved_residue] == the_system.ss_element_for_atoms()[the_other_residue])
+      return false;
+    if ((the_other_residue >= moved_residue - 4) && (the_other_residue <= moved_residue + 4)) return false;
+    const core::index2 atom_type_i = the_system[moved_residue].atom_type;
+    const core::index2 atom_type_j = the_system[the_other_residue].atom_type;
+    bool is_OK = !((atom_type_i == 2) || (atom_type_j == 2));
+    if (atom_type_i == atom_type_j) {
+      if ((atom_type_i == 0) && ((the_other_residue >= moved_residue - 5) && (the_other_residue <= moved_residue + 5)))
+        return false;
+      if (atom_type_i == 1) {
+        unsigned int i1 = (unsigned char) the_system.beta_index_for_atoms()[moved_residue];
+        unsigned int i2 = (unsigned char) the_system.beta_index_for_atoms()[the_other_residue];
+        if (HB.union_find_sheets().find_set(i1) == HB.union_find_sheets().find_set(i2)) is_OK = false;
+      }
+    }
+    const core::index1 id = (atom_type_i << 2) + atom_type_j;
+    shortest2 = contact_shift_ + contact_min_distance_[id] * 0.05;
+    shortest2 *= shortest2;
+    premium2 = real(contact_ave_distance_[id]) * contact_ave_distance_[id];
+    longest2 = real(contact_max_distance_[id]) * contact_max_distance_[id];
+    premium_energy = (is_OK) ? low_energy_level_ : 0.0;
+    return true;
+  }
+
+  /** @brief Assigns beta strands to sheets again, based on the current conformation of the system.
+   *
+   * Sheets are found when this energy term is created. Call this method when the conformation has been replaced
+   * by an unrelated one, e.g. when a set of decoys is scored with the same energy object.
+   */
+  void update_sheets() { HB.find_hydrogen_bonds(); }
+
+  /// Energy added when two residues are too close to each other
+  real high_energy_level() const { return high_energy_level_; }
+
   virtual const std::string &name() const { return name_; }
 
 protected:
@@ -103,10 +179,29 @@ protected:
 private:
   utils::Logger logger;
   const systems::surpass::SurpassModel<C> &the_system; ///< the system whose energy will be evaluated
-  const SurpassHydrogenBond <C> HB;
+  SurpassHydrogenBond <C> HB;
 
   void init(const real high_energy_level, const real low_energy_level, const real contact_shift);
 
+  /// Square-well energy of two wrapped positions, for parameters given by <code>pair_parameters()</code>
+  inline double contact_energy(const C &o_i, const C &o_j, const real shortest2, const real premium2,
+                               const real longest2, const real premium_energy) const {
+
+    double d = o_i.x - o_j.x;
+    double r2 = d * d;
+    if (r2 > longest2) return 0.0;
+    d = o_i.y - o_j.y;
+    r2 += d * d;
+    if (r2 > longest2) return 0.0;
+    d = o_i.z - o_j.z;
+    r2 += d * d;
+    if (r2 >= longest2) return 0.0;
+    double en = 0.0;
+    if (r2 < shortest2) en += high_energy_level_;
+    if (r2 > premium2) en += premium_energy;
+    return en;
+  }
+
   void load_surpass_cutoffs();
 
   static const std::string name_;
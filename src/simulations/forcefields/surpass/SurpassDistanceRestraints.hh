@@ -0,0 +1,200 @@
+#ifndef SIMULATIONS_CARTESIAN_FF_SurpassDistanceRestraints_HH
+#define SIMULATIONS_CARTESIAN_FF_SurpassDistanceRestraints_HH
+
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+#include <math.h>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <utils/string_utils.hh>
+#include <utils/io_utils.hh>
+#include <utils/Logger.hh>
+
+#include <simulations/systems/surpass/SurpassModel.hh>
+#include <simulations/forcefields/ByResidueEnergy.hh>
+
+namespace simulations {
+namespace forcefields {
+namespace surpass {
+
+/** @brief Distance restraints, e.g. derived from predicted residue-residue contacts.
+ *
+ * Restraints are given for residues of a protein; each residue is mapped on a SURPASS bead. Since a bead \f$ k \f$
+ * is the average of CA atoms of residues \f$ k \dots k+3 \f$, a residue \f$ r \f$ (0-based) is assigned to the bead
+ * \f$ r - 1 \f$ (clamped to the valid range), whose averaging window is the most centered on that residue.
+ *
+ * Two functional forms are available:
+ *   - <code>flat</code> (the default): \f$ k (d - d_{max})^2 \f$ above the upper bound, \f$ k (d_{min} - d)^2 \f$ below the lower bound
+ *     and zero in between
+ *   - <code>lorentz</code>: \f$ -w \f$ below the upper bound and \f$ -w / (1 + ((d-d_{max})/\sigma)^2) \f$ above it;
+ *     this bounded form tolerates false positives in predicted contacts
+ *
+ * Restraints are stored as a CSR adjacency (compressed sparse rows): for every bead the list of its restraints.
+ * The cost of <code>calculate_by_residue()</code> is therefore proportional to the number of restraints of the moved bead.
+ *
+ * Each line of a restraint file gives: <code>residue_i residue_j [d_min [d_max [weight]]]</code>
+ * where residues are numbered from 1; defaults are 0.0, 8.0 and 1.0, respectively. This covers the five-column CASP RR format.
+ * Lines that do not start with a number (e.g. headers) are skipped. A line referring to a residue the chain does not have
+ * (e.g. numbered in another way) is skipped with a warning.
+ * @tparam C - the type used to express coordinates
+ */
+template<class C>
+class SurpassDistanceRestraints : public ByResidueEnergy {
+public:
+
+  /** @brief Creates restraints energy based on string parameters, as given in a scoring config file.
+   *
+   * @param system - the system whose energy will be evaluated
+   * @param parameters - the name of a restraints file, optionally followed by the shape (<code>flat</code> or <code>lorentz</code>)
+   *    and a constant: the force constant \f$ k \f$ of a flat-bottom potential or the width \f$ \sigma \f$ of a Lorentzian
+   */
+  SurpassDistanceRestraints(const systems::surpass::SurpassModel<C> &system, const std::vector<std::string> &parameters) :
+    SurpassDistanceRestraints(system, parameters.at(0), (parameters.size() > 1) && (parameters[1] == "lorentz"),
+                              (parameters.size() > 2) ? utils::from_string<core::real>(parameters[2]) : 1.0) {}
+
+  /** @brief Creates restraints energy.
+   *
+   * @param system - the system whose energy will be evaluated
+   * @param fname - name of the restraints file
+   * @param lorentzian - if true, Lorentzian form is used; flat-bottom harmonic otherwise
+   * @param constant - the force constant (flat-bottom) or the width (Lorentzian)
+   */
+  SurpassDistanceRestraints(const systems::surpass::SurpassModel<C> &system, const std::string &fname,
+                            const bool lorentzian, const core::real constant) :
+    the_system(system), lorentzian_(lorentzian), constant_(constant), logger("SurpassDistanceRestraints") {
+
+    std::vector<Restraint> restraints;
+    std::stringstream in(utils::load_text_file(fname));
+    std::string line;
+    const int n_beads = the_system.n_atoms;
+    const int n_residues = n_beads + 3; // --- every bead averages four consecutive residues
+    core::index4 line_no = 0;
+    while (std::getline(in, line)) {
+      ++line_no;
+      std::vector<std::string> tokens;
+      std::replace(line.begin(), line.end(), '\t', ' ');
+      utils::split(utils::trim(line), tokens, ' ');
+      if ((tokens.size() < 2) || (!isdigit(tokens[0][0])) || (!isdigit(tokens[1][0]))) continue;
+      const int res_i = utils::from_string<int>(tokens[0]);
+      const int res_j = utils::from_string<int>(tokens[1]);
+      if ((res_i < 1) || (res_i > n_residues) || (res_j < 1) || (res_j > n_residues)) {
+        logger << utils::LogLevel::WARNING << utils::string_format(
+          "line %d of %s skipped: residues %d and %d must be within 1..%d\n", int(line_no), fname.c_str(), res_i, res_j,
+          n_residues);
+        continue;
+      }
+      Restraint r;
+      r.i = std::min(std::max(res_i - 2, 0), n_beads - 1);
+      r.j = std::min(std::max(res_j - 2, 0), n_beads - 1);
+      r.d_min = (tokens.size() > 2) ? utils::from_string<core::real>(tokens[2]) : 0.0;
+      r.d_max = (tokens.size() > 3) ? utils::from_string<core::real>(tokens[3]) : 8.0;
+      r.weight = (tokens.size() > 4) ? utils::from_string<core::real>(tokens[4]) : 1.0;
+      if (r.i == r.j) continue;
+      restraints.push_back(r);
+      std::swap(r.i, r.j);
+      restraints.push_back(r);
+    }
+
+    // --- Build CSR: each restraint is stored twice, once for each of its beads
+    std::sort(restraints.begin(), restraints.end(),
+              [](const Restraint &a, const Restraint &b) { return (a.i < b.i) || ((a.i == b.i) && (a.j < b.j)); });
+    row_start.assign(n_beads + 1, 0);
+    for (const Restraint &r : restraints) ++row_start[r.i + 1];
+    for (int k = 0; k < n_beads; ++k) row_start[k + 1] += row_start[k];
+    for (const Restraint &r : restraints) {
+      partner.push_back(r.j);
+      d_min.push_back(r.d_min);
+      d_max.push_back(r.d_max);
+      weight.push_back(r.weight);
+    }
+    logger << utils::LogLevel::INFO << restraints.size() / 2 << " restraints loaded from " << fname << " ("
+           << (lorentzian_ ? "Lorentzian" : "flat-bottom") << " form)\n";
+  }
+
+  /// Empty virtual destructor to satisfy the compiler
+  virtual ~SurpassDistanceRestraints() {}
+
+  /// Returns the name of this energy term, which is "SurpassDistanceRestraints"
+  const std::string &name() const { return name_; }
+
+  /// Returns the number of restraints acting on a given bead
+  core::index4 count_restraints(const core::index2 which_residue) const {
+    return row_start[which_residue + 1] - row_start[which_residue];
+  }
+
+  /// Energy of all restraints of a given bead
+  virtual double calculate_by_residue(const core::index2 which_residue) {
+
+    double en = 0.0;
+    for (core::index4 k = row_start[which_residue]; k < row_start[which_residue + 1]; ++k)
+      en += restraint_energy(which_residue, k);
+    return en;
+  }
+
+  /** @brief Energy of all restraints of beads from a given range.
+   *
+   * A restraint between two beads of the chunk is counted once.
+   */
+  virtual double calculate_by_chunk(const core::index2 chunk_from, const core::index2 chunk_to) {
+
+    double en = 0.0;
+    for (core::index2 i = chunk_from; i <= chunk_to; ++i)
+      for (core::index4 k = row_start[i]; k < row_start[i + 1]; ++k) {
+        if ((partner[k] >= chunk_from) && (partner[k] <= chunk_to) && (partner[k] < i)) continue;
+        en += restraint_energy(i, k);
+      }
+    return en;
+  }
+
+  /// Energy of all restraints; each restraint is counted once
+  virtual double calculate() {
+
+    double en = 0.0;
+    for (core::index4 i = 0; i + 1 < row_start.size(); ++i)
+      for (core::index4 k = row_start[i]; k < row_start[i + 1]; ++k)
+        if (partner[k] > i) en += restraint_energy(i, k);
+    return en;
+  }
+
+private:
+  struct Restraint {
+    core::index2 i, j;
+    core::real d_min, d_max, weight;
+  };
+
+  const systems::surpass::SurpassModel<C> &the_system;
+  const bool lorentzian_;
+  const core::real constant_;
+  std::vector<core::index4> row_start; ///< restraints of bead i are stored at [row_start[i], row_start[i+1])
+  std::vector<core::index2> partner;
+  std::vector<core::real> d_min;
+  std::vector<core::real> d_max;
+  std::vector<core::real> weight;
+  utils::Logger logger;
+  static const std::string name_;
+
+  inline double restraint_energy(const core::index2 i, const core::index4 k) const {
+
+    const core::real d = the_system[i].distance_to(the_system[partner[k]]);
+    if (lorentzian_) {
+      if (d <= d_max[k]) return -weight[k];
+      const core::real x = (d - d_max[k]) / constant_;
+      return -weight[k] / (1.0 + x * x);
+    }
+    if (d > d_max[k]) return weight[k] * constant_ * (d - d_max[k]) * (d - d_max[k]);
+    if (d < d_min[k]) return weight[k] * constant_ * (d_min[k] - d) * (d_min[k] - d);
+    return 0.0;
+  }
+};
+
+template<typename C>
+const std::string SurpassDistanceRestraints<C>::name_ = "SurpassDistanceRestraints";
+
+} // ~ surpass
+} // ~ forcefields
+} // ~ simulations
+
+#endif
@@ -309,7 +309,7 @@ private:
   core::algorithms::UnionFind<unsigned int, unsigned int> union_find_sheets_; ///< binds beta strands into sheets
 
 
-  inline void vec_along(core::index4 i_atom, Vec3 &output) {
+  inline void vec_along(core::index4 i_atom, core::data::basic::Vec3 &output) {
 
     if (i_atom == the_system.atoms_for_chain(0).first_atom) {
       output.set(the_system[i_atom + 2]);
@@ -331,7 +331,7 @@ private:
     core::index2 ss = the_system.ss_element_for_atoms()[the_system.atoms_in_beta()[0]];
     core::index4 ID_j = n_atoms;
 
-    Vec3 H1, H2, H3;
+    core::data::basic::Vec3 H1, H2, H3;
 //--2-- From all possible ACCEPTORS select one the best for each B-strand (if applicable)
     for (auto &j : the_system.atoms_in_beta()) {                        //the second atom in hydrogen bond (ACCEPTOR_id, core::index2)
       if (the_system.ss_element_for_atoms()[y] !=
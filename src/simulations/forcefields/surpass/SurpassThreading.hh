@@ -0,0 +1,116 @@
+/** @file SurpassThreading.hh
+ * @brief Provides SurpassThreading: fast evaluation of a fixed SURPASS conformation with many secondary structure profiles
+ */
+#ifndef SIMULATIONS_CARTESIAN_FF_SurpassThreading_HH
+#define SIMULATIONS_CARTESIAN_FF_SurpassThreading_HH
+
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/data/sequence/SecondaryStructure.hh>
+#include <utils/string_utils.hh>
+
+#include <simulations/forcefields/TotalEnergyByResidue.hh>
+#include <simulations/forcefields/mf/ShortRangeMFBase.hh>
+#include <simulations/representations/surpass_utils.hh>
+
+namespace simulations {
+namespace forcefields {
+namespace surpass {
+
+/** @brief Scores a single SURPASS conformation against many secondary structure profiles (threading mode).
+ *
+ * Secondary structure dependent terms of SURPASS force field (R12 - R15 distances, A13 angles) are derived from
+ * <code>mf::ShortRangeMFBase</code>. Their energy is a bilinear form in the H/E/C fractions of a profile, whose coefficients
+ * depend only on the conformation (see <code>mf::ShortRangeMFBase::tabulate()</code>). The coefficients are computed once
+ * by <code>update()</code>; then every profile is scored by a simple loop over the chain, without evaluating
+ * any distance or spline function. Since the SURPASS representation does not carry amino acid identity, these terms
+ * are the only ones that react to a change of a profile. Other energy terms (contacts, hydrogen bonds, etc.) depend
+ * on the bead types of the system itself; they are evaluated by <code>update()</code> and reported as constants.
+ *
+ * @code
+ * SurpassThreading<Vec3> threading(*energy);
+ * std::vector<double> components;
+ * for (const auto & ss2 : profiles) std::cout << threading.score(*ss2, components) << "\n";
+ * @endcode
+ */
+template<typename C>
+class SurpassThreading {
+public:
+
+  /** @brief Prepares threading for the current conformation of a system.
+   *
+   * @param energy - SURPASS energy function of the scored system; must live as long as this object is used
+   */
+  SurpassThreading(TotalEnergyByResidue &energy) : energy_(energy), mf_terms(energy.count_components()),
+                                                   tables(energy.count_components()),
+                                                   constant(energy.count_components(), 0.0) {
+    for (core::index2 i = 0; i < energy_.count_components(); ++i)
+      mf_terms[i] = std::dynamic_pointer_cast<mf::ShortRangeMFBase<C>>(energy_.get_component(i));
+    update();
+  }
+
+  /// Tabulates energy terms for the current conformation; call it whenever the coordinates have changed
+  void update() {
+    for (core::index2 i = 0; i < energy_.count_components(); ++i) {
+      if (mf_terms[i] != nullptr) mf_terms[i]->tabulate(tables[i]);
+      else constant[i] = energy_.calculate_component(i) * energy_.get_factors()[i];
+    }
+  }
+
+  /// Returns true if a given energy component depends on secondary structure profile
+  bool is_profile_dependent(const core::index2 which_component) const { return mf_terms[which_component] != nullptr; }
+
+  /** @brief Evaluates the energy of the conformation given a secondary structure profile.
+   *
+   * @param ss2_aa - secondary structure of the all-atom chain, e.g. as read from an SS2 file; it is converted into
+   *    the SURPASS representation, so it must be three residues longer than the SURPASS chain
+   * @param components - weighted value of every energy term (resized as needed)
+   * @return the total energy
+   */
+  double score(const core::data::sequence::SecondaryStructure &ss2_aa, std::vector<double> &components) {
+
+    core::data::sequence::SecondaryStructure_SP ss = simulations::representations::surpass_representation(ss2_aa);
+    const core::index2 n = ss->length();
+    for (core::index2 i = 0; i < mf_terms.size(); ++i) {
+      if ((mf_terms[i] != nullptr) && (mf_terms[i]->n_residues != n))
+        throw std::invalid_argument(utils::string_format(
+          "Secondary structure profile converted to %d SURPASS positions while the system has %d residues\n", int(n),
+          int(mf_terms[i]->n_residues)));
+    }
+    h.resize(n);
+    e.resize(n);
+    c.resize(n);
+    for (core::index2 i = 0; i < n; ++i) {
+      h[i] = ss->fraction_H(i);
+      e[i] = ss->fraction_E(i);
+      c[i] = ss->fraction_C(i);
+    }
+
+    components.resize(mf_terms.size());
+    double total = 0.0;
+    for (core::index2 i = 0; i < mf_terms.size(); ++i) {
+      components[i] = (mf_terms[i] != nullptr) ?
+                      mf_terms[i]->score_table(tables[i], h.data(), e.data(), c.data()) * energy_.get_factors()[i] :
+                      constant[i];
+      total += components[i];
+    }
+    return total;
+  }
+
+private:
+  TotalEnergyByResidue &energy_;
+  std::vector<std::shared_ptr<mf::ShortRangeMFBase<C>>> mf_terms; ///< nullptr for terms that do not depend on a profile
+  std::vector<std::vector<core::real>> tables; ///< coefficients computed by mf::ShortRangeMFBase::tabulate()
+  std::vector<double> constant; ///< weighted energy of terms that do not depend on a profile
+  std::vector<core::real> h, e, c; ///< H, E and C fractions of the profile being scored
+};
+
+}
+}
+}
+
+#endif
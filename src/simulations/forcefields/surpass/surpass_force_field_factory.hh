@@ -21,6 +21,7 @@
 #include <simulations/forcefields/surpass/SurpassCentrosymetricEnergy.hh>
 #include <simulations/forcefields/surpass/SurpassLocalRepulsionEnergy.hh>
 #include <simulations/forcefields/surpass/SurpassHelixStifnessEnergy.hh>
+#include <simulations/forcefields/surpass/SurpassDistanceRestraints.hh>
 
 namespace simulations {
 namespace forcefields {
@@ -121,6 +122,12 @@ std::shared_ptr<TotalEnergyByResidue> create_surpass_energy(systems::surpass::Su
       continue;
     }
 
+    if (score_name.compare("SurpassDistanceRestraints") == 0) {
+      en = std::static_pointer_cast<ByResidueEnergy>(std::make_shared<SurpassDistanceRestraints<C>>(system, tokens));
+      out->add_component(en, factor);
+      continue;
+    }
+
     if (score_name.compare("SurpassA13") == 0) {
       en = std::static_pointer_cast<ByResidueEnergy>(std::make_shared<SurpassA13<C>>(system, ss2, tokens));
       out->add_component(en, factor);
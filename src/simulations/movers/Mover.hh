@@ -8,6 +8,7 @@
 
 #include <core/real.hh>
 #include <core/index.hh>
+#include <core/calc/statistics/Random.hh>
 #include <simulations/sampling/AbstractAcceptanceCriterion.hh>
 
 namespace simulations {
@@ -43,6 +44,14 @@ public:
   /// Returns the name of this mover, so the name may appear in the output when required
   virtual const std::string &  name() const = 0;
 
+  /** @brief Sets the random engine this mover draws its moves from.
+   *
+   * By default movers use the <code>Random::get()</code> singleton. Concurrent simulations must however use separate
+   * engines. Movers that make random decisions should override this method; the default implementation does nothing.
+   * @param generator - random engine; must live as long as this mover is used
+   */
+  virtual void random_generator(core::calc::statistics::Random & generator) {}
+
   /// Virtual destructor (empty)
   virtual ~Mover() { }
 
@@ -85,10 +94,32 @@ public:
     return s;
   }
 
+  /** @brief Adds a squared displacement made by an accepted move.
+   * This method is called by <code>move()</code>, so the sampling efficiency of this mover may be measured
+   */
+  inline void add_displacement(const core::real d2) { displacement_ += d2; }
+
+  /// Adds CPU time (in seconds) spent on moves; called by a sampler that measures efficiency of movers
+  inline void add_time(const double seconds) { time_ += seconds; }
+
+  /// Sum of squared displacements made by accepted moves since the last <code>clear_efficiency_counters()</code> call
+  inline core::real get_displacement() const { return displacement_; }
+
+  /// CPU time (in seconds) spent on moves since the last <code>clear_efficiency_counters()</code> call
+  inline double get_time() const { return time_; }
+
+  /// Clears the counters of displacement and time
+  inline void clear_efficiency_counters() {
+    displacement_ = 0.0;
+    time_ = 0.0;
+  }
+
 private:
 
   int n_attempted = 0;
   int n_successful = 0;
+  core::real displacement_ = 0.0;
+  double time_ = 0.0;
 };
 
 /// Type representing a shared pointer to a Mover
@@ -27,7 +27,65 @@ void MoversSet::add_mover(Mover_SP mover, const size_t moves_each_step) {
 
 core::calc::statistics::RandomSequenceIterator<Mover_SP> MoversSet::begin() {
 
-  return core::calc::statistics::RandomSequenceIterator<Mover_SP>::begin(sweep,sweep.size());
+  return core::calc::statistics::RandomSequenceIterator<Mover_SP>::begin(sweep,sweep.size(), *generator_);
+}
+
+void MoversSet::random_generator(core::calc::statistics::Random & generator) {
+
+  generator_ = &generator;
+  for (Mover_SP m : movers) m->random_generator(generator);
+}
+
+void MoversSet::moves_each_step(const core::index2 which, const size_t moves_each_step) {
+
+  factors[which] = std::max(size_t(1), moves_each_step);
+  sweep.clear();
+  for (size_t i = 0; i < movers.size(); ++i)
+    for (size_t j = 0; j < factors[i]; ++j) sweep.push_back(movers[i]);
+}
+
+void MoversSet::adaptive_mix(const core::index4 n_updates) {
+
+  n_updates_left = n_updates;
+  for (Mover_SP m : movers) m->clear_efficiency_counters();
+  logger << utils::LogLevel::INFO << "mover mix will be adapted " << int(n_updates) << " times\n";
+}
+
+void MoversSet::update_mix() {
+
+  if (n_updates_left == 0) return;
+
+  // --- efficiency of every mover: displacement per CPU-second; cost of a single move in seconds
+  const size_t n = movers.size();
+  std::vector<double> efficiency(n, 0.0), cost(n, 0.0);
+  double total_efficiency = 0.0, total_time = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    const double t = movers[i]->get_time();
+    if (t <= 0.0) return; // --- nothing measured yet; counters are kept for the next call
+    efficiency[i] = movers[i]->get_displacement() / t;
+    cost[i] = t / factors[i];
+    total_efficiency += efficiency[i];
+    total_time += t;
+  }
+  --n_updates_left; // --- only updates based on measured times count
+  for (Mover_SP m : movers) m->clear_efficiency_counters();
+  if (total_efficiency <= 0.0) return;
+
+  // --- share of CPU time for every mover, with a floor; the new mix is averaged with the old one to damp the noise
+  const double min_share = std::min(0.05, 1.0 / n);
+  for (size_t i = 0; i < n; ++i) {
+    const double share = min_share + (1.0 - n * min_share) * efficiency[i] / total_efficiency;
+    const double new_factor = share * total_time / cost[i];
+    moves_each_step(i, size_t(0.5 * (factors[i] + new_factor) + 0.5));
+  }
+
+  if (logger.is_logable(utils::LogLevel::FINE) || (n_updates_left == 0)) {
+    logger << ((n_updates_left == 0) ? utils::LogLevel::INFO : utils::LogLevel::FINE)
+           << ((n_updates_left == 0) ? "mover mix frozen:" : "mover mix updated:");
+    for (size_t i = 0; i < n; ++i)
+      logger << utils::string_format(" %s %d (%.3g/s)", movers[i]->name().c_str(), int(factors[i]), efficiency[i]);
+    logger << "\n";
+  }
 }
 
 const std::string MoversSet::header_string() const {
@@ -65,13 +65,54 @@ public:
    */
   const std::string header_string() const;
 
+  /// Returns the number of distinct movers in this set
+  core::index2 count_movers() const { return movers.size(); }
+
+  /// Returns a requested mover
+  const Mover_SP get_mover(const core::index2 id) const { return movers[id]; }
+
   /// Returns the size of each sweep i.e. how many movers are called
   core::index2 sweep_size() const { return sweep.size(); }
 
+  /** @brief Sets the random engine used to order the movers of a sweep and by every mover of this set.
+   * @param generator - random engine; must live as long as this set is used
+   */
+  void random_generator(core::calc::statistics::Random & generator);
+
+  /// Returns how many times a given mover is called within a single MC sweep
+  size_t moves_each_step(const core::index2 which) const { return factors[which]; }
+
+  /** @brief Changes how many times a given mover is called within a single MC sweep
+   * @param which - index of a mover (in the order of <code>add_mover()</code> calls)
+   * @param moves_each_step - new number of moves; at least one move is always attempted
+   */
+  void moves_each_step(const core::index2 which, const size_t moves_each_step);
+
+  /** @brief Turns on adaptation of the mover mix to measured sampling efficiency.
+   *
+   * While adapting, a sampler measures the CPU time spent by every mover and each mover accumulates
+   * the squared displacement of the atoms it moved in accepted moves. At every <code>update_mix()</code> call
+   * the mix is changed so the share of CPU time given to a mover is proportional to its efficiency,
+   * i.e. displacement per CPU-second. Every mover keeps at least 5% of the time, so its efficiency
+   * is still measured. After <code>n_updates</code> updates the mix is frozen, which restores detailed balance
+   * for the rest of a simulation; only the frozen part should be used for analysis.
+   * @param n_updates - number of updates before the mix is frozen; an <code>update_mix()</code> call made before
+   *    any time was measured doesn't count
+   */
+  void adaptive_mix(const core::index4 n_updates);
+
+  /// True when this set still adapts its mover mix; a sampler should then measure CPU time of every move
+  bool is_adapting() const { return n_updates_left > 0; }
+
+  /// Changes the mover mix according to the efficiency measured since the previous call (see <code>adaptive_mix()</code>)
+  void update_mix();
+
 private:
+  core::index4 n_updates_left = 0;
   std::vector<size_t> factors;
   std::vector<Mover_SP> sweep;
   std::vector<Mover_SP> movers;
+  core::calc::statistics::Random *generator_ = &core::calc::statistics::Random::get();
   static utils::Logger logger;
   static const core::index1 precision;
   std::vector<core::index2> sw;
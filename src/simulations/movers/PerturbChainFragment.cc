@@ -11,6 +11,7 @@ template<class C>
 PerturbChainFragment<C>::PerturbChainFragment(systems::ResidueChain<C> &system, core::index2 n_moved,
                                               forcefields::ByResidueEnergy &energy) :
   max_step_(0.5), n_moved_(n_moved), the_system(system), the_energy(energy),
+  delta_energy(dynamic_cast<forcefields::TotalEnergyByResidue *>(&energy)),
   rand_bead_index(1, the_system.count_residues() - n_moved - 1), rand_coordinate(-max_step_, max_step_),
   backup(new C[the_system.n_atoms]), logger("PerturbChainFragment") {}
 
@@ -34,15 +35,20 @@ void PerturbChainFragment<C>::max_move_range(core::real step) {
 template<class C>
 bool PerturbChainFragment<C>::move(simulations::sampling::AbstractAcceptanceCriterion &mc_scheme) {
 
-  last_moved_from = rand_bead_index(generator);
+  last_moved_from = rand_bead_index(*generator_);
   last_moved_to = last_moved_from + n_moved_ - 1;
   core::real f = 2.0 / (1.0 + n_moved_);
-  core::real dx = rand_coordinate(generator) * f;
-  core::real dy = rand_coordinate(generator) * f;
-  core::real dz = rand_coordinate(generator) * f;
+  core::real dx = rand_coordinate(*generator_) * f;
+  core::real dy = rand_coordinate(*generator_) * f;
+  core::real dz = rand_coordinate(*generator_) * f;
   logger << utils::LogLevel::FINER << "moving the beads : " << (int) last_moved_from << " - " << (int) last_moved_to << "\n";
 
-  core::real before = the_energy.calculate_by_chunk(last_moved_from, last_moved_to);
+  // --- delayed acceptance: terms of a surrogate energy screen the move before the remaining terms are evaluated
+  const bool screen = (delta_energy != nullptr) && delta_energy->has_surrogate();
+  // --- terms that evaluate the move directly are skipped here; they compute the energy change after the move
+  core::real before = (delta_energy == nullptr) ? the_energy.calculate_by_chunk(last_moved_from, last_moved_to) :
+                      (screen ? delta_energy->calculate_surrogate_by_chunk(last_moved_from, last_moved_to)
+                              : delta_energy->calculate_by_chunk_without_delta(last_moved_from, last_moved_to));
   for (core::index4 i = last_moved_from; i <= last_moved_to; ++i) backup[i].set(the_system.coordinates[i]);
 
   for (core::index4 i = 0; i < n_moved_ / 2; ++i) {
@@ -59,8 +65,22 @@ bool PerturbChainFragment<C>::move(simulations::sampling::AbstractAcceptanceCrit
     the_system.coordinates[ii].y += dy / f;
     the_system.coordinates[ii].z += dz / f;
   }
-  core::real after = the_energy.calculate_by_chunk(last_moved_from, last_moved_to);
   inc_move_counter();
+  if (screen) {
+    const bool passed = mc_scheme.test(before, delta_energy->calculate_surrogate_by_chunk(last_moved_from, last_moved_to));
+    delta_energy->count_screening(passed);
+    if (!passed) {
+      undo();
+      return false;
+    }
+    swap_with_backup();
+    before = delta_energy->calculate_by_chunk_without_delta(last_moved_from, last_moved_to);
+    swap_with_backup();
+  }
+  core::real after = (delta_energy != nullptr)
+                     ? delta_energy->calculate_by_chunk_without_delta(last_moved_from, last_moved_to) +
+                       delta_energy->calculate_delta(last_moved_from, last_moved_to, backup.get())
+                     : the_energy.calculate_by_chunk(last_moved_from, last_moved_to);
   if (!mc_scheme.test(before, after)) {
     undo();
     if (logger.is_logable(utils::LogLevel::FINEST))
@@ -69,6 +89,8 @@ bool PerturbChainFragment<C>::move(simulations::sampling::AbstractAcceptanceCrit
                after - before);
     return false;
   } else {
+    for (core::index4 i = last_moved_from; i <= last_moved_to; ++i)
+      add_displacement(the_system.coordinates[i].distance_square_to(backup[i]));
     if (logger.is_logable(utils::LogLevel::FINEST))
       logger << utils::LogLevel::FINEST
              << utils::string_format("move cancelled: beads %d - %d; delta(Energy): %f\n", last_moved_from,
@@ -83,6 +105,17 @@ void PerturbChainFragment<C>::undo() {
   for (size_t i = last_moved_from; i <= last_moved_to; i++) the_system.coordinates[i].set(backup[i]);
 }
 
+template<class C>
+void PerturbChainFragment<C>::swap_with_backup() {
+
+  C tmp;
+  for (size_t i = last_moved_from; i <= last_moved_to; i++) {
+    tmp.set(the_system.coordinates[i]);
+    the_system.coordinates[i].set(backup[i]);
+    backup[i].set(tmp);
+  }
+}
+
 template<class C>
 const std::string PerturbChainFragment<C>::name_ = "PerturbChainFragment";
 
@@ -10,6 +10,7 @@ template<class C>
 PerturbResidue<C>::PerturbResidue(systems::ResidueChain<C> &system,
                                   forcefields::ByResidueEnergy &energy) :
   max_step_(0.3), the_system(system), the_energy(energy),
+  delta_energy(dynamic_cast<forcefields::TotalEnergyByResidue *>(&energy)),
   rand_residue_index(0, the_system.count_residues() - 1), rand_coordinate(-max_step_, max_step_),
   backup(new C[the_system.n_atoms]), logger("PerturbResidue") {}
 
@@ -32,19 +33,37 @@ void PerturbResidue<C>::max_move_range(core::real step) {
 template<class C>
 bool PerturbResidue<C>::move(simulations::sampling::AbstractAcceptanceCriterion &mc_scheme) {
 
-  i_moved = rand_residue_index(generator);
+  i_moved = rand_residue_index(*generator_);
   const systems::AtomRange<C> &last = the_system.atoms_for_residue(i_moved);
-  core::real before = the_energy.calculate_by_residue(i_moved);
+  // --- delayed acceptance: terms of a surrogate energy screen the move before the remaining terms are evaluated
+  const bool screen = (delta_energy != nullptr) && delta_energy->has_surrogate();
+  // --- terms that evaluate the move directly are skipped here; they compute the energy change after the move
+  core::real before = (delta_energy == nullptr) ? the_energy.calculate_by_residue(i_moved) :
+                      (screen ? delta_energy->calculate_surrogate_by_residue(i_moved)
+                              : delta_energy->calculate_by_residue_without_delta(i_moved));
   for (core::index4 i = last.first_atom; i <= last.last_atom; ++i) {
     backup[i].set(the_system.coordinates[i]);
-    the_system.coordinates[i].x += rand_coordinate(generator);
-    the_system.coordinates[i].y += rand_coordinate(generator);
-    the_system.coordinates[i].z += rand_coordinate(generator);
+    the_system.coordinates[i].x += rand_coordinate(*generator_);
+    the_system.coordinates[i].y += rand_coordinate(*generator_);
+    the_system.coordinates[i].z += rand_coordinate(*generator_);
   }
-  core::real after = the_energy.calculate_by_residue(i_moved);
   inc_move_counter();
   last_moved_from = last.first_atom;
   last_moved_to = last.last_atom;
+  if (screen) {
+    const bool passed = mc_scheme.test(before, delta_energy->calculate_surrogate_by_residue(i_moved));
+    delta_energy->count_screening(passed);
+    if (!passed) {
+      undo();
+      return false;
+    }
+    swap_with_backup();
+    before = delta_energy->calculate_by_residue_without_delta(i_moved);
+    swap_with_backup();
+  }
+  core::real after = (delta_energy != nullptr) ? delta_energy->calculate_by_residue_without_delta(i_moved) +
+                                                 delta_energy->calculate_delta(i_moved, i_moved, backup.get())
+                                               : the_energy.calculate_by_residue(i_moved);
   if (!mc_scheme.test(before, after)) {
     undo();
     if (logger.is_logable(utils::LogLevel::FINEST))
@@ -52,6 +71,8 @@ bool PerturbResidue<C>::move(simulations::sampling::AbstractAcceptanceCriterion
              utils::string_format("move accepted: residue %d; delta(Energy): %f\n", i_moved, after - before);
     return false;
   } else {
+    for (core::index4 i = last_moved_from; i <= last_moved_to; ++i)
+      add_displacement(the_system.coordinates[i].distance_square_to(backup[i]));
     if (logger.is_logable(utils::LogLevel::FINEST))
       logger << utils::LogLevel::FINEST
              << utils::string_format("move cancelled: residue %d; delta(Energy): %f\n", i_moved, after - before);
@@ -67,6 +88,17 @@ void PerturbResidue<C>::undo() {
 }
 
 
+template<class C>
+void PerturbResidue<C>::swap_with_backup() {
+
+  C tmp;
+  for (size_t i = last_moved_from; i <= last_moved_to; i++) {
+    tmp.set(the_system.coordinates[i]);
+    the_system.coordinates[i].set(backup[i]);
+    backup[i].set(tmp);
+  }
+}
+
 template<class C>
 const std::string PerturbResidue<C>::name_ = "PerturbResidue";
 
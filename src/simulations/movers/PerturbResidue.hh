@@ -10,6 +10,7 @@
 #include <utils/Logger.hh>
 
 #include <simulations/forcefields/ByResidueEnergy.hh>
+#include <simulations/forcefields/TotalEnergyByResidue.hh>
 #include <simulations/movers/Mover.hh>
 #include <simulations/sampling/AbstractAcceptanceCriterion.hh>
 
@@ -68,6 +69,9 @@ public:
   /// Returns the name of this mover
   virtual const std::string &  name() const { return name_; }
 
+  /// Sets the random engine this mover draws its moves from
+  virtual void random_generator(core::calc::statistics::Random & generator) { generator_ = &generator; }
+
 private:
   /// Maximum range of a move for each coordinate.
   core::real max_step_;
@@ -75,12 +79,16 @@ private:
   core::index4 last_moved_from = 0, last_moved_to = 0;
   systems::ResidueChain<C> & the_system;
   forcefields::ByResidueEnergy & the_energy;
+  forcefields::TotalEnergyByResidue *delta_energy; ///< the_energy cast to a total energy, where terms may evaluate a move directly; nullptr otherwise
   std::uniform_int_distribution<int> rand_residue_index;
   std::uniform_real_distribution<core::real> rand_coordinate;
-  core::calc::statistics::Random & generator = core::calc::statistics::Random::get();
+  core::calc::statistics::Random *generator_ = &core::calc::statistics::Random::get();
   std::unique_ptr<C[]> backup;
   static const std::string name_;
   utils::Logger logger;
+
+  /// Exchanges coordinates of the moved atoms with their backup copy, so the energy may be evaluated before the move
+  void swap_with_backup();
 };
 
 
@@ -0,0 +1,41 @@
+#include <fstream>
+#include <cstdio>
+
+#include <simulations/observers/ObserveMetadynamics.hh>
+
+namespace simulations {
+namespace observers {
+
+bool ObserveMetadynamics::observe() {
+
+  ++cnt;
+  if (!trigger->operator()()) return false;
+
+  bias->deposit();
+  if ((checkpoint_every > 0) && (bias->count_hills() % checkpoint_every == 0)) checkpoint();
+
+  return true;
+}
+
+void ObserveMetadynamics::checkpoint() const {
+
+  // --- write to a temporary file first, so a crash can't leave a broken checkpoint
+  const std::string tmp_fname = checkpoint_fname + ".tmp";
+  std::ofstream out(tmp_fname);
+  bias->write_state(out);
+  out.close();
+  std::rename(tmp_fname.c_str(), checkpoint_fname.c_str());
+}
+
+void ObserveMetadynamics::finalize() {
+
+  checkpoint();
+  std::ofstream out(fes_fname);
+  bias->write_fes(out);
+  out.close();
+  logger << utils::LogLevel::INFO << size_t(bias->count_hills()) << " hills deposited, free energy surface written to "
+         << fes_fname << "\n";
+}
+
+} // ~ observers
+} // ~ simulations
@@ -0,0 +1,65 @@
+/** @file ObserveMetadynamics.hh
+ *  @brief Provides ObserveMetadynamics observer that deposits metadynamics hills and checkpoints the bias
+ */
+#ifndef SIMULATIONS_OBSERVERS_ObserveMetadynamics_HH
+#define SIMULATIONS_OBSERVERS_ObserveMetadynamics_HH
+
+#include <string>
+#include <memory>
+
+#include <core/index.hh>
+#include <utils/Logger.hh>
+
+#include <simulations/observers/ObserverInterface.hh>
+#include <simulations/forcefields/MetadynamicsBias.hh>
+
+namespace simulations {
+namespace observers {
+
+/** @brief Deposits a new metadynamics hill at every observation.
+ *
+ * Register this observer as an inner cycle observer of a sampler; set a TriggerEveryN trigger
+ * to deposit hills every N inner cycles. Deposition happens between MC cycles, therefore never between
+ * the two energy evaluations made by a mover. Every <code>checkpoint_every</code> hills the bias state is written
+ * to a file, which may be used to restart the simulation. <code>finalize()</code> writes the final checkpoint
+ * and the free energy surface.
+ */
+class ObserveMetadynamics : public ObserverInterface {
+public:
+
+  /** @brief Creates an observer that drives metadynamics deposition
+   *
+   * @param bias - the bias to be built
+   * @param checkpoint_fname - name of the checkpoint file (overwritten at every checkpoint)
+   * @param fes_fname - name of the file for the free energy surface
+   * @param checkpoint_every - write a checkpoint every that many hills
+   */
+  ObserveMetadynamics(forcefields::MetadynamicsBias_SP bias, const std::string &checkpoint_fname,
+                      const std::string &fes_fname, const core::index4 checkpoint_every = 100) :
+    bias(bias), checkpoint_fname(checkpoint_fname), fes_fname(fes_fname), checkpoint_every(checkpoint_every),
+    logger("ObserveMetadynamics") {}
+
+  /// Deposits a new hill
+  virtual bool observe();
+
+  /// Writes the checkpoint and the free energy surface
+  virtual void finalize();
+
+  /// Writes the current bias state to the checkpoint file
+  void checkpoint() const;
+
+  virtual core::index4 count_observe_calls() const { return cnt; }
+
+private:
+  forcefields::MetadynamicsBias_SP bias;
+  const std::string checkpoint_fname;
+  const std::string fes_fname;
+  const core::index4 checkpoint_every;
+  core::index4 cnt = 0;
+  utils::Logger logger;
+};
+
+} // ~ observers
+} // ~ simulations
+
+#endif
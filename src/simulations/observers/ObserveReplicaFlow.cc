@@ -9,6 +9,8 @@ namespace observers {
 ObserveReplicaFlow::ObserveReplicaFlow(const sampling::ReplicaExchangeMC & replicas, std::string file_name) :
   fname(file_name), replicas_(replicas) {
   std::ofstream out(fname);
+  out << "#time replica_at_temperature[0.." << replicas_.temperatures().size() - 1
+      << "] boundary_flags n_exchanges exchange\n";
   out.close();
 }
 
@@ -30,9 +32,11 @@ bool ObserveReplicaFlow::observe() {
 
   for(core::index2 i=0;i<replicas_.temperatures().size();++i)
     out << std::setw(4) << replicas_.n_successful_exchanges[i] << " ";
+  out << "  " << std::setw(6) << replicas_.count_exchanges_done(); // --- last, so the older columns keep their positions
 
   out << "\n";
   out.close();
+  ++cnt;
 
   return true;
 }
@@ -8,6 +8,13 @@
 namespace simulations {
 namespace observers {
 
+/** @brief Records the permutation of replicas between temperatures.
+ *
+ * Every row of the output file provides: time, index of the replica that currently occupies each temperature,
+ * boundary-hit flags, the number of successful exchanges at every temperature and, in the last column, the number
+ * of exchange attempts made so far. Since the observer is called after every exchange, the file holds the complete permutation history
+ * of a REMC run.
+ */
 class ObserveReplicaFlow : public ObserverInterface {
 public:
 
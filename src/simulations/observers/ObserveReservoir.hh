@@ -0,0 +1,57 @@
+#ifndef SIMULATIONS_OBSERVERS_ObserveReservoir_HH
+#define SIMULATIONS_OBSERVERS_ObserveReservoir_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <simulations/observers/ObserverInterface.hh>
+#include <simulations/sampling/ReplicaExchangeMC.hh>
+#include <simulations/sampling/ConformationReservoir.hh>
+
+namespace simulations {
+namespace observers {
+
+/** @brief Records conformations of the highest temperature replica into a reservoir.
+ *
+ * The observer is called after every replica exchange; the reservoir is written to a binary file by
+ * <code>finalize()</code>, so it may be used by another REMC run (see ReplicaExchangeMC::reservoir()).
+ */
+template<typename C>
+class ObserveReservoir : public ObserverInterface {
+public:
+
+  /** @brief Creates an observer recording the top of the temperature ladder
+   * @param replicas - replica exchange sampler
+   * @param systems - system of every replica, indexed as replicas of the sampler
+   * @param file_name - where the reservoir is written
+   */
+  ObserveReservoir(const sampling::ReplicaExchangeMC & replicas,
+                   const std::vector<std::shared_ptr<systems::CartesianAtomsSimple<C>>> & systems,
+                   const std::string & file_name) : fname(file_name), replicas_(replicas), systems_(systems),
+    reservoir_(replicas.temperatures().back(), systems[0]->n_atoms) {}
+
+  /// Adds the conformation currently at the highest temperature to the reservoir
+  virtual bool observe() {
+    const auto & top = replicas_.get_replicas().back();
+    reservoir_.add(*systems_[top->replica_index()], top->energy->calculate());
+    return true;
+  }
+
+  /// Writes the reservoir to the file
+  virtual void finalize() { reservoir_.write(fname); }
+
+  /// Provides the reservoir recorded so far
+  const sampling::ConformationReservoir & reservoir() const { return reservoir_; }
+
+private:
+  std::string fname;
+  const sampling::ReplicaExchangeMC & replicas_;
+  std::vector<std::shared_ptr<systems::CartesianAtomsSimple<C>>> systems_;
+  sampling::ConformationReservoir reservoir_;
+};
+
+} // ~ observers
+} // ~ simulations
+
+#endif
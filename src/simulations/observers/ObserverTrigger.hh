@@ -22,7 +22,7 @@ public:
   core::index4 count_observe_calls() const { return count_observe_calls_; }
 
 protected:
-  core::index4 count_observe_calls_;
+  core::index4 count_observe_calls_ = 0;
 };
 
 typedef std::shared_ptr<ObserverTrigger> ObserverTrigger_SP;
@@ -12,7 +12,16 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cerrno>
 
+#include <core/index.hh>
 #include <core/data/basic/Vec3.hh>
 #include <simulations/systems/CartesianAtomsSimple.hh>
 #include <simulations/observers/cartesian/AbstractPdbObserver.hh>
@@ -23,40 +32,68 @@ namespace cartesian {
 
 /** @brief Sends a conformation to PyMol program.
  *
- * Inside PyMol you must start a UDP server that listens to a port where the data is sent.
+ * Inside PyMol you must start a UDP server that listens to a port where the data is sent. The server receives
+ * PDB-formatted text; a datagram holding the single letter "Q" closes every frame.
+ *
+ * Sampling is never stalled by this observer: <code>observe()</code> renders a frame into a buffer only when
+ * the requested frame rate allows it, and hands the buffer over to a background thread, which sends it in a few
+ * large datagrams (whole lines only) with non-blocking calls. When the sender falls behind, a stale frame
+ * waiting to be sent is replaced by the newer one; a frame interrupted by a busy socket is sent truncated.
+ * Text sent by <code>observe(text)</code> or <code>bond()</code> is not dropped while the observer works: when
+ * the socket is busy, the unsent part of the text is kept and retried (before any new frame). The only exception
+ * is the end of a run: text that still can't be sent after <code>max_retries</code> attempts at destruction is dropped.
  * @param observed_object - system whose coordinates will be stored in the file
  * @param pdb_format_source - biomolecular structure that corresponds to the system.
  * @param address - address of the UDP server that listens to the PDB data (usually this is "127.0.0.1")
  * @param port - port to listen to , by default 65000
+ * @param frame_rate - the maximum number of frames sent per second
  * @see AbstractPdbObserver<C>
  */
 template<typename C>
 class PymolObserver : public AbstractPdbObserver<C> {
 public:
 
+  /// The largest datagram sent to the server
+  static const size_t max_datagram = 8192;
+
+  /// The number of attempts to send queued text when the observer is destroyed and the socket stays busy
+  static const core::index2 max_retries = 100;
+
   PymolObserver(const systems::CartesianAtomsSimple <C> &observed_object,
                 const core::data::structural::Structure &pdb_format_source, const std::string address =
-  "127.0.0.1", const size_t port = 65000) :
-    AbstractPdbObserver<C>(observed_object, pdb_format_source) {
+  "127.0.0.1", const size_t port = 65000, const double frame_rate = 10.0) :
+    AbstractPdbObserver<C>(observed_object, pdb_format_source),
+    frame_interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / frame_rate))) {
 
     sockfd = socket(AF_INET, SOCK_DGRAM, 0);
     serv.sin_family = AF_INET;
-    serv.sin_port = htons(65000);
+    serv.sin_port = htons(port);
     serv.sin_addr.s_addr = inet_addr(address.c_str());
     m = sizeof(serv);
+    last_frame = std::chrono::steady_clock::now() - frame_interval;
+    sender = std::thread(&PymolObserver<C>::send_loop, this);
   }
 
-  virtual ~PymolObserver() {}
+  /// Sends what has been already queued and stops the sender thread
+  virtual ~PymolObserver() {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      stop = true;
+    }
+    queue_ready.notify_one();
+    sender.join();
+    close(sockfd);
+  }
 
-  /// Sends conformation to pymol as PDB formatted text
+  /// Sends conformation to pymol as PDB formatted text, unless the previous frame has been sent too recently
   virtual bool observe();
 
   /// Send some text to the server (server must be able to understand it!)
   bool observe(const std::string text);
 
   void bond(const core::index4 i_atom, const core::index4 j_atom) {
-    send_line(utils::string_format("BOND bond id#%d, id#%d", i_atom, j_atom));
-    sendto(sockfd, "Q", 1, 0, (struct sockaddr *) &serv, m);
+    observe(utils::string_format("BOND bond id#%d, id#%d", i_atom, j_atom));
   }
 
   /// The virtual method does nothing in this class
@@ -66,48 +103,153 @@ public:
 
   virtual void output_stream(std::shared_ptr<std::ostream> out) {}
 
+  /// The number of frames sent to the server so far
+  core::index4 count_sent() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return n_sent;
+  }
+
+  /// The number of frames rendered but replaced by a newer one before they could be sent
+  core::index4 count_dropped() const {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    return n_dropped;
+  }
+
 private:
   int sockfd;
   struct sockaddr_in serv;
   socklen_t m = 0;
   core::index4  cnt = 0;
+  const std::chrono::steady_clock::duration frame_interval;
+  std::chrono::steady_clock::time_point last_frame;
+  std::stringstream frame_buffer; ///< reused by every frame rendered by the sampling thread
 
-  void send_line(const std::string &line) {
+  mutable std::mutex queue_mutex;
+  std::condition_variable queue_ready;
+  std::string pending_frame; ///< the most recent frame, not sent yet
+  std::deque<std::string> pending_text; ///< text messages, sent in order
+  bool stop = false;
+  core::index4 n_sent = 0;
+  core::index4 n_dropped = 0;
+  std::thread sender;
+  const std::chrono::milliseconds retry_interval{10}; ///< pause before sending to a busy socket again
 
-    sendto(sockfd, line.c_str(), line.length(), 0, (struct sockaddr *) &serv, m);
-    if (line.back() != '\n') sendto(sockfd, "\n", 1, 0, (struct sockaddr *) &serv, m);
-  }
+  void send_loop();
+
+  /** @brief Sends a message in datagrams of at most max_datagram bytes, each holding whole lines.
+   * @param text - the message
+   * @param from - the first byte to be sent; bytes before it have been sent by a previous call
+   * @return the first byte not sent because the socket was busy, or the size of the message
+   */
+  size_t send_message(const std::string &text, size_t from = 0);
+
+  /// Closes a message: sends the final end of line if the message lacks it, then "Q"
+  void close_message(const std::string &text);
 };
 
 template<typename C>
 bool PymolObserver<C>::observe() {
 
+  const auto now = std::chrono::steady_clock::now();
+  if (now - last_frame < frame_interval) return true;
+  last_frame = now;
   ++cnt;
 
-  std::stringstream oss;
-  AbstractPdbObserver<C>::observed_object.write_pdb(oss, AbstractPdbObserver<C>::format_lines, cnt);
-  while (!oss.eof()) {
-    std::string line;
-    getline(oss, line);
-    send_line(line);
+  frame_buffer.str("");
+  AbstractPdbObserver<C>::observed_object.write_pdb(frame_buffer, AbstractPdbObserver<C>::format_lines, cnt);
+  std::string frame = frame_buffer.str();
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    if (!pending_frame.empty()) ++n_dropped;
+    pending_frame.swap(frame);
   }
-  sendto(sockfd, "Q", 1, 0, (struct sockaddr *) &serv, m);
+  queue_ready.notify_one();
   return true;
 }
 
 template<typename C>
 bool PymolObserver<C>::observe(const std::string text) {
 
-  std::stringstream iss(text);
-  while (!iss.eof()) {
-    std::string line;
-    getline(iss, line);
-    send_line(line);
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    pending_text.push_back(text);
   }
-  sendto(sockfd, "Q", 1, 0, (struct sockaddr *) &serv, m);
+  queue_ready.notify_one();
   return true;
 }
 
+template<typename C>
+void PymolObserver<C>::send_loop() {
+
+  std::string frame;
+  std::deque<std::string> texts; // --- text taken from the queue but not sent yet
+  size_t text_sent = 0; // --- the number of bytes of texts.front() already sent
+  core::index2 n_retries = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      queue_ready.wait(lock, [&]() {
+        return stop || (!texts.empty()) || (!pending_frame.empty()) || (!pending_text.empty());
+      });
+      if (stop && pending_frame.empty() && pending_text.empty() && (texts.empty() || n_retries >= max_retries)) return;
+      if (!pending_frame.empty()) {
+        if (!frame.empty()) ++n_dropped; // --- a frame held back by unsent text is replaced by the newer one
+        frame.swap(pending_frame);
+        pending_frame.clear();
+      }
+      for (std::string &t : pending_text) texts.push_back(std::move(t));
+      pending_text.clear();
+    }
+    while (!texts.empty()) {
+      text_sent = send_message(texts.front(), text_sent);
+      if (text_sent < texts.front().size()) break;
+      close_message(texts.front());
+      texts.pop_front();
+      text_sent = 0;
+      n_retries = 0;
+    }
+    if (!texts.empty()) { // --- the socket is busy: try again a bit later, keeping the frame until the text is sent
+      if (n_retries < max_retries) ++n_retries;
+      std::this_thread::sleep_for(retry_interval);
+      continue;
+    }
+    if (!frame.empty()) {
+      send_message(frame);
+      close_message(frame);
+      frame.clear();
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      ++n_sent;
+    }
+  }
+}
+
+template<typename C>
+size_t PymolObserver<C>::send_message(const std::string &text, size_t from) {
+
+  while (from < text.size()) {
+    size_t to = from + max_datagram;
+    if (to >= text.size()) to = text.size();
+    else { // --- break the datagram after the last complete line, unless a single line is longer than a datagram
+      const size_t eol = text.rfind('\n', to - 1);
+      if ((eol != std::string::npos) && (eol >= from)) to = eol + 1;
+    }
+    if (sendto(sockfd, text.data() + from, to - from, MSG_DONTWAIT, (struct sockaddr *) &serv, m) < 0) {
+      if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS)) return from; // --- the socket is busy
+      return text.size(); // --- any other error won't go away by retrying: the rest of the message is dropped
+    }
+    from = to;
+  }
+  return text.size();
+}
+
+template<typename C>
+void PymolObserver<C>::close_message(const std::string &text) {
+
+  if (text.empty()) return;
+  if (text.back() != '\n') sendto(sockfd, "\n", 1, MSG_DONTWAIT, (struct sockaddr *) &serv, m);
+  sendto(sockfd, "Q", 1, MSG_DONTWAIT, (struct sockaddr *) &serv, m);
+}
+
 }
 }
 }
@@ -0,0 +1,215 @@
+/** @file ObserveLowEnergyArchive.hh
+ *  @brief Provides ObserveLowEnergyArchive observer that keeps unique low-energy conformations
+ */
+#ifndef SIMULATIONS_OBSERVERS_SURPASS_ObserveLowEnergyArchive_HH
+#define SIMULATIONS_OBSERVERS_SURPASS_ObserveLowEnergyArchive_HH
+
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <algorithm>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/calc/structural/transformations/Crmsd.hh>
+#include <utils/string_utils.hh>
+#include <utils/Logger.hh>
+
+#include <simulations/forcefields/CalculateEnergyBase.hh>
+#include <simulations/systems/surpass/SurpassModel.hh>
+#include <simulations/observers/cartesian/AbstractPdbObserver.hh>
+
+namespace simulations {
+namespace observers {
+
+/** @brief Keeps an archive of unique low-energy conformations and writes it in PDB format at the end of a simulation.
+ *
+ * Which observations are low enough in energy is decided by a trigger, e.g. TriggerLowEnergy. Every accepted
+ * conformation is described by a fingerprint: distances between centers of secondary structure elements
+ * (or between centers of consecutive chain fragments for a chain with less than three elements), quantized
+ * with a given bin width. Only archived conformations whose fingerprint differs by at most one bin in every
+ * distance are compared with crmsd, the most similar first and no more than <code>max_crmsd_checks</code> of them.
+ * A conformation closer than <code>crmsd_cutoff</code> to an archived one is a duplicate: it replaces the archived
+ * one when its energy is lower, otherwise it is discarded. A new conformation is added to the archive;
+ * when the archive is full, its highest-energy member is removed.
+ */
+template<typename C>
+class ObserveLowEnergyArchive : public cartesian::AbstractPdbObserver<C> {
+public:
+
+  /** @brief Creates an archive observer.
+   *
+   * @param system - the observed system
+   * @param pdb_format_source - biomolecular structure that corresponds to the system, used to format the PDB output
+   * @param energy - energy of the observed system
+   * @param out_fname - the archive is written to this file by <code>finalize()</code>
+   * @param crmsd_cutoff - two conformations closer than this are considered duplicates
+   * @param max_size - the maximum number of conformations kept
+   */
+  ObserveLowEnergyArchive(const systems::surpass::SurpassModel<C> &system,
+                          const core::data::structural::Structure &pdb_format_source,
+                          forcefields::CalculateEnergyBase &energy, const std::string &out_fname,
+                          const core::real crmsd_cutoff = 2.0, const core::index4 max_size = 1000);
+
+  /// Adds the current conformation to the archive if it's unique, or replaces its higher-energy duplicate
+  virtual bool observe();
+
+  /// Writes the archived conformations, from the lowest energy to the highest, as PDB models
+  virtual void finalize();
+
+  virtual std::shared_ptr<std::ostream> output_stream() { return nullptr; }
+
+  virtual void output_stream(std::shared_ptr<std::ostream> out) {}
+
+  /// The number of conformations currently archived
+  core::index4 count_conformations() const { return archive.size(); }
+
+  /// The number of conformations accepted by the trigger but found to be duplicates of archived ones
+  core::index4 count_duplicates() const { return n_duplicates; }
+
+  /// Width of a fingerprint bin in Angstroms (4.0 by default)
+  void bin_width(const core::real width) { bin_width_ = width; }
+
+  /// The maximum number of crmsd calculations made for a single observation (3 by default)
+  void max_crmsd_checks(const core::index2 n) { max_crmsd_checks_ = n; }
+
+private:
+  struct Entry {
+    double energy;
+    std::vector<core::index1> fingerprint;
+    std::vector<C> coordinates;
+  };
+
+  const systems::surpass::SurpassModel<C> &system_;
+  forcefields::CalculateEnergyBase &energy_;
+  std::string out_fname;
+  core::real crmsd_cutoff_;
+  core::index4 max_size_;
+  core::real bin_width_ = 4.0;
+  core::index2 max_crmsd_checks_ = 3;
+  std::vector<std::pair<core::index4, core::index4>> groups; ///< atom ranges whose centers define a fingerprint
+  std::vector<Entry> archive;
+  std::vector<core::index1> current_fingerprint;
+  std::vector<C> centers;
+  core::index4 n_duplicates = 0;
+  core::calc::structural::transformations::Crmsd<std::unique_ptr<C[]>, std::vector<C>> rms;
+  utils::Logger logs;
+
+  void fingerprint(std::vector<core::index1> &destination);
+};
+
+template<typename C>
+ObserveLowEnergyArchive<C>::ObserveLowEnergyArchive(const systems::surpass::SurpassModel<C> &system,
+    const core::data::structural::Structure &pdb_format_source, forcefields::CalculateEnergyBase &energy,
+    const std::string &out_fname, const core::real crmsd_cutoff, const core::index4 max_size) :
+  cartesian::AbstractPdbObserver<C>(system, pdb_format_source), system_(system), energy_(energy),
+  out_fname(out_fname), crmsd_cutoff_(crmsd_cutoff), max_size_(max_size), logs("ObserveLowEnergyArchive") {
+
+  const std::vector<core::index2> &sse = system.ss_element_for_atoms();
+  for (core::index4 i = 0; i < system.n_atoms; ++i) {
+    if (sse[i] == 0) continue;
+    if ((groups.empty()) || (sse[groups.back().second] != sse[i]) || (groups.back().second + 1 != i))
+      groups.emplace_back(i, i);
+    else groups.back().second = i;
+  }
+  if (groups.size() < 3) { // --- too few secondary structure elements: the chain is split into fragments
+    const core::index4 fragment = 8;
+    groups.clear();
+    for (core::index4 i = 0; i < system.n_atoms; i += fragment)
+      groups.emplace_back(i, std::min(i + fragment, core::index4(system.n_atoms)) - 1);
+  }
+  centers.resize(groups.size());
+}
+
+template<typename C>
+void ObserveLowEnergyArchive<C>::fingerprint(std::vector<core::index1> &destination) {
+
+  for (core::index4 k = 0; k < groups.size(); ++k) {
+    C &c = centers[k];
+    c.x = c.y = c.z = 0.0;
+    for (core::index4 i = groups[k].first; i <= groups[k].second; ++i) c += system_.coordinates[i];
+    c /= core::real(groups[k].second - groups[k].first + 1);
+  }
+  destination.clear();
+  for (core::index4 i = 1; i < groups.size(); ++i)
+    for (core::index4 j = 0; j < i; ++j)
+      destination.push_back(core::index1(std::min(255.0, centers[i].distance_to(centers[j]) / bin_width_)));
+}
+
+template<typename C>
+bool ObserveLowEnergyArchive<C>::observe() {
+
+  if (!ObserverInterface::trigger->operator()()) return false;
+
+  const double en = energy_.calculate();
+  fingerprint(current_fingerprint);
+
+  // --- candidates: archived conformations whose fingerprint differs by at most one bin at every position
+  std::vector<std::pair<core::index4, core::index4>> candidates; // --- (L1 distance between fingerprints, entry)
+  for (core::index4 e = 0; e < archive.size(); ++e) {
+    const std::vector<core::index1> &f = archive[e].fingerprint;
+    core::index4 l1 = 0;
+    bool close = true;
+    for (core::index4 k = 0; k < f.size(); ++k) {
+      const int d = std::abs(int(f[k]) - int(current_fingerprint[k]));
+      if (d > 1) {
+        close = false;
+        break;
+      }
+      l1 += d;
+    }
+    if (close) candidates.emplace_back(l1, e);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  if (candidates.size() > max_crmsd_checks_) candidates.resize(max_crmsd_checks_);
+
+  for (const auto &c : candidates) {
+    Entry &entry = archive[c.second];
+    if (rms.crmsd(system_.coordinates, entry.coordinates, system_.n_atoms) < crmsd_cutoff_) {
+      ++n_duplicates;
+      if (en < entry.energy) { // --- the better representative of the basin replaces the archived one
+        entry.energy = en;
+        entry.fingerprint.swap(current_fingerprint);
+        system_.snapshot(entry.coordinates);
+      }
+      return true;
+    }
+  }
+
+  if (archive.size() >= max_size_) {
+    auto worst = std::max_element(archive.begin(), archive.end(),
+      [](const Entry &a, const Entry &b) { return a.energy < b.energy; });
+    if (worst->energy <= en) return true;
+    archive.erase(worst);
+  }
+  archive.emplace_back();
+  archive.back().energy = en;
+  archive.back().fingerprint.swap(current_fingerprint);
+  system_.snapshot(archive.back().coordinates);
+
+  return true;
+}
+
+template<typename C>
+void ObserveLowEnergyArchive<C>::finalize() {
+
+  std::sort(archive.begin(), archive.end(), [](const Entry &a, const Entry &b) { return a.energy < b.energy; });
+  std::ofstream out(out_fname);
+  core::index4 model_id = 0;
+  for (const Entry &e : archive) {
+    out << utils::string_format("MODEL    %7d\n", ++model_id);
+    out << utils::string_format("REMARK   1 ENERGY %12.3f\n", e.energy);
+    for (core::index4 i = 0; i < e.coordinates.size(); ++i)
+      out << utils::string_format(cartesian::AbstractPdbObserver<C>::format_lines[i], e.coordinates[i].x,
+        e.coordinates[i].y, e.coordinates[i].z);
+    out << "ENDMDL\n";
+  }
+  logs << utils::LogLevel::INFO << utils::string_format("%d unique low-energy conformations written to %s, %d duplicates\n",
+    int(archive.size()), out_fname.c_str(), int(n_duplicates));
+}
+
+}
+}
+
+#endif
@@ -5,12 +5,13 @@
 #include <memory>
 #include <iostream>
 #include <iomanip>
-#include <unordered_map>
+#include <functional>
 
 #include <utils/Logger.hh>
 
 #include <simulations/evaluators/Evaluator.hh>
 #include <simulations/observers/ToStreamObserver.hh>
+#include <simulations/observers/surpass/TopologyRegistry.hh>
 #include <simulations/forcefields/surpass/SurpassHydrogenBond.hh>
 
 namespace simulations {
@@ -18,7 +19,10 @@ namespace observers {
 
 /** @brief Creates an observer which for each observation writes topology matrix of a surpass model
  *
- * At every <code>observe()</code> call this object will write topology matrix : all its elements in a single line
+ * At every <code>observe()</code> call this object will write topology matrix : all its elements in a single line,
+ * followed by the topology ID. IDs are assigned by a TopologyRegistry; when observers of all replicas share
+ * a registry, a topology has the same ID in every replica and the registry accumulates populations
+ * and transitions between topologies at every temperature.
  */
 template <typename C>
 class ObserveTopologyMatrix : public virtual ToStreamObserver {
@@ -29,9 +33,8 @@ public:
    * @param out - output stream where the data will be written
    */
   ObserveTopologyMatrix(std::shared_ptr<simulations::forcefields::surpass::SurpassHydrogenBond<C>> hb_energy,
-    std::shared_ptr<std::ostream> out) : system_(hb_energy), logger("ObserveTopologyMatrix"), outstream(out), is_file_(false) {
-    n_topologies_ = 0;
-  }
+    std::shared_ptr<std::ostream> out) : system_(hb_energy), logger("ObserveTopologyMatrix"), outstream(out), is_file_(false),
+    registry_(std::make_shared<TopologyRegistry>()), temperature_([]() { return 0.0; }) {}
 
   /** @brief Creates an observer that writes topology matrix elements into a given file
  *
@@ -40,6 +43,19 @@ public:
   ObserveTopologyMatrix(std::shared_ptr<simulations::forcefields::surpass::SurpassHydrogenBond<C>> hb_energy, std::string out_fname)
     : ObserveTopologyMatrix(hb_energy,std::make_shared<std::ofstream>(out_fname)) { is_file_ = true; }
 
+  /** @brief Creates an observer that writes topology matrix elements into a given file and registers them in a shared registry
+   *
+   * @param out_fname - name of the output file
+   * @param registry - registry of topologies, possibly shared by observers of other replicas
+   * @param temperature - returns the current temperature of the observed replica
+   */
+  ObserveTopologyMatrix(std::shared_ptr<simulations::forcefields::surpass::SurpassHydrogenBond<C>> hb_energy,
+    std::string out_fname, TopologyRegistry_SP registry, std::function<core::real()> temperature)
+    : ObserveTopologyMatrix(hb_energy, out_fname) {
+    registry_ = registry;
+    temperature_ = temperature;
+  }
+
   /// Virtual destructor
   virtual ~ObserveTopologyMatrix() {}
 
@@ -53,14 +69,17 @@ public:
 
   virtual core::index4 count_observe_calls() const { return cnt; }
 
+  /// The registry that assigns topology IDs
+  TopologyRegistry_SP registry() const { return registry_; }
+
 private:
-  std::unordered_map<std::string,core::index4> observed_topologies;
-  std::vector<core::index4> topology_counts;
-  core::index4 n_topologies_;
   std::shared_ptr<simulations::forcefields::surpass::SurpassHydrogenBond<C>> system_;
   utils::Logger logger;
   std::shared_ptr<std::ostream> outstream;
   bool is_file_;
+  TopologyRegistry_SP registry_;
+  std::function<core::real()> temperature_;
+  core::index4 previous_id = TopologyRegistry::no_topology; ///< topology of the most recent observation
   core::index4 cnt = 0;
 };
 
@@ -79,21 +98,12 @@ bool ObserveTopologyMatrix<C>::observe() {
   ++cnt;
   if (!trigger->operator()()) return false;
 
-  std::stringstream topo_stream;
-  for (core::index1 i = 0; i < system_->beta_topology_matrix().count_rows(); ++i)
-    for (core::index1 j = 0; j < system_->beta_topology_matrix().count_columns(); ++j) topo_stream << int(
-        system_->beta_topology_matrix()(i, j));
-
-  std::string topo = topo_stream.str();
-  if (observed_topologies.find(topo) == observed_topologies.end()) {
-    observed_topologies[topo] = n_topologies_;
-    topology_counts.push_back(1);
-    ++n_topologies_;
-  }
-  else
-    topology_counts[observed_topologies[topo]]++;
+  const TopologyFingerprint fingerprint(system_->beta_topology_matrix());
+  const core::index4 id = registry_->id(fingerprint);
+  registry_->record(temperature_(), previous_id, id);
+  previous_id = id;
 
-  (*outstream) << std::setw(6) << cnt << " " << topo << " " << observed_topologies[topo] << "\n";
+  (*outstream) << std::setw(6) << cnt << " " << fingerprint.str() << " " << id << "\n";
   outstream->flush();
 
   return true;
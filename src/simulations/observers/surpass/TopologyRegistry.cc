@@ -0,0 +1,114 @@
+#include <limits>
+#include <iomanip>
+#include <algorithm>
+
+#include <utils/string_utils.hh>
+
+#include <simulations/observers/surpass/TopologyRegistry.hh>
+
+namespace simulations {
+namespace observers {
+
+const core::index4 TopologyRegistry::no_topology = std::numeric_limits<core::index4>::max();
+
+TopologyFingerprint::TopologyFingerprint(const core::data::basic::Array2D<core::index1> &matrix) :
+  n_elements(matrix.count_rows() * matrix.count_columns()), bits((n_elements + 31) / 32, 0) {
+
+  core::index4 k = 0;
+  for (core::index4 i = 0; i < matrix.count_rows(); ++i)
+    for (core::index4 j = 0; j < matrix.count_columns(); ++j, ++k)
+      bits[k / 32] |= uint64_t(std::min(matrix(i, j), core::index1(3))) << (2 * (k % 32));
+
+  uint64_t h = n_elements;
+  for (uint64_t w : bits) { // --- splitmix64 finalizer mixes every word into the hash
+    h ^= w + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+  }
+  hash_ = size_t(h);
+}
+
+std::string TopologyFingerprint::str() const {
+
+  std::string s(n_elements, '0');
+  for (core::index4 k = 0; k < n_elements; ++k) s[k] = char('0' + ((bits[k / 32] >> (2 * (k % 32))) & 3));
+  return s;
+}
+
+core::index4 TopologyRegistry::id(const TopologyFingerprint &fingerprint) {
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto it = ids.find(fingerprint);
+  if (it != ids.end()) return it->second;
+  const core::index4 new_id = topologies.size();
+  ids.insert(std::make_pair(fingerprint, new_id));
+  topologies.push_back(fingerprint.str());
+  return new_id;
+}
+
+void TopologyRegistry::record(const core::real temperature, const core::index4 previous_id,
+                              const core::index4 current_id) {
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  std::vector<core::index4> &counts = populations[temperature];
+  if (counts.size() <= current_id) counts.resize(current_id + 1, 0);
+  ++counts[current_id];
+  if (previous_id != no_topology) ++transition_counts[temperature][std::make_pair(previous_id, current_id)];
+}
+
+core::index4 TopologyRegistry::count_topologies() const {
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  return topologies.size();
+}
+
+std::string TopologyRegistry::topology(const core::index4 id) const {
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  return topologies.at(id);
+}
+
+core::index4 TopologyRegistry::population(const core::real temperature, const core::index4 id) const {
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto it = populations.find(temperature);
+  if ((it == populations.end()) || (it->second.size() <= id)) return 0;
+  return it->second[id];
+}
+
+core::index4 TopologyRegistry::transitions(const core::real temperature, const core::index4 from,
+                                           const core::index4 to) const {
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  auto it = transition_counts.find(temperature);
+  if (it == transition_counts.end()) return 0;
+  auto c = it->second.find(std::make_pair(from, to));
+  return (c == it->second.end()) ? 0 : c->second;
+}
+
+void TopologyRegistry::write_populations(std::ostream &out) const {
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  out << "#   id";
+  for (const auto &p : populations) out << utils::string_format(" %9.3f", p.first);
+  out << " topology\n";
+  for (core::index4 id = 0; id < topologies.size(); ++id) {
+    out << std::setw(6) << id;
+    for (const auto &p : populations) out << " " << std::setw(9) << ((id < p.second.size()) ? p.second[id] : 0);
+    out << " " << topologies[id] << "\n";
+  }
+}
+
+void TopologyRegistry::write_transitions(std::ostream &out) const {
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  out << "# temperature   from     to  count\n";
+  for (const auto &t : transition_counts)
+    for (const auto &c : t.second)
+      out << utils::string_format("%13.3f %6d %6d %6d\n", t.first, int(c.first.first), int(c.first.second),
+                                  int(c.second));
+}
+
+} // ~ observers
+} // ~ simulations
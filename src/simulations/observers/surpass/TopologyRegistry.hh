@@ -0,0 +1,105 @@
+/** \file TopologyRegistry.hh
+ * @brief Provides TopologyFingerprint and TopologyRegistry: sheet topologies identified across replicas
+ */
+#ifndef SIMULATIONS_OBSERVERS_SURPASS_TopologyRegistry_HH
+#define SIMULATIONS_OBSERVERS_SURPASS_TopologyRegistry_HH
+
+#include <map>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <memory>
+#include <iostream>
+#include <unordered_map>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/data/basic/Array2D.hh>
+
+namespace simulations {
+namespace observers {
+
+/** @brief Compact, hashable form of a beta-sheet topology matrix.
+ *
+ * Every element of the matrix (0, 1 or 2) is packed into two bits, 32 elements per 64-bit word.
+ * The hash of the packed words is computed once, so the fingerprint may be used directly as a key of a hash map.
+ */
+class TopologyFingerprint {
+public:
+
+  /// Packs the given topology matrix
+  TopologyFingerprint(const core::data::basic::Array2D<core::index1> &matrix);
+
+  /// Returns the matrix elements as a single string of digits, row by row
+  std::string str() const;
+
+  /// Hash value of this fingerprint
+  size_t hash() const { return hash_; }
+
+  bool operator==(const TopologyFingerprint &other) const { return (n_elements == other.n_elements) && (bits == other.bits); }
+
+private:
+  core::index4 n_elements;
+  std::vector<uint64_t> bits;
+  size_t hash_;
+};
+
+/** @brief Assigns integer IDs to sheet topologies and collects their statistics online.
+ *
+ * A single registry may be shared by all replicas of a REMC simulation (every method is thread-safe),
+ * so a topology has the same ID in every replica. For every temperature the registry counts how many times
+ * each topology was observed, and how many times a replica moved from one topology to another between
+ * its two consecutive observations. Such statistics define a Markov state model over sheet topologies.
+ */
+class TopologyRegistry {
+public:
+
+  /// Returns the ID of a topology, registering it when seen for the first time
+  core::index4 id(const TopologyFingerprint &fingerprint);
+
+  /** @brief Records a single observation of a replica
+   * @param temperature - temperature of the replica at the moment of the observation
+   * @param previous_id - topology observed in this replica previously; <code>no_topology</code> for the first observation
+   * @param current_id - topology observed now
+   */
+  void record(const core::real temperature, const core::index4 previous_id, const core::index4 current_id);
+
+  /// Returns the number of distinct topologies
+  core::index4 count_topologies() const;
+
+  /// Returns the topology matrix of a given topology as a string of digits
+  std::string topology(const core::index4 id) const;
+
+  /// How many times a topology was observed at a given temperature
+  core::index4 population(const core::real temperature, const core::index4 id) const;
+
+  /// How many times a replica at a given temperature moved from topology <code>from</code> to topology <code>to</code>
+  core::index4 transitions(const core::real temperature, const core::index4 from, const core::index4 to) const;
+
+  /// Writes a table of populations: a row for every topology, a column for every temperature
+  void write_populations(std::ostream &out) const;
+
+  /// Writes non-zero transition counts, one per line: temperature, from, to, count
+  void write_transitions(std::ostream &out) const;
+
+  /// Marks the lack of a previous observation
+  static const core::index4 no_topology;
+
+private:
+  struct FingerprintHash {
+    size_t operator()(const TopologyFingerprint &f) const { return f.hash(); }
+  };
+
+  mutable std::mutex registry_mutex;
+  std::unordered_map<TopologyFingerprint, core::index4, FingerprintHash> ids;
+  std::vector<std::string> topologies; ///< string form of every topology, indexed by ID
+  std::map<core::real, std::vector<core::index4>> populations; ///< per temperature, indexed by ID
+  std::map<core::real, std::map<std::pair<core::index4, core::index4>, core::index4>> transition_counts;
+};
+
+typedef std::shared_ptr<TopologyRegistry> TopologyRegistry_SP;
+
+} // ~ observers
+} // ~ simulations
+
+#endif
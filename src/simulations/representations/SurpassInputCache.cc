@@ -0,0 +1,177 @@
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <cstring>
+#include <cstdio>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <core/SURPASSversion.hh>
+#include <core/data/io/Pdb.hh>
+#include <core/data/structural/Chain.hh>
+#include <core/data/structural/Residue.hh>
+#include <core/data/structural/PdbAtom.hh>
+#include <utils/io_utils.hh>
+#include <utils/string_utils.hh>
+
+#include <simulations/representations/surpass_utils.hh>
+#include <simulations/representations/SurpassInputCache.hh>
+
+namespace simulations {
+namespace representations {
+
+using namespace core::data::structural;
+
+utils::Logger SurpassInputCache::logs("SurpassInputCache");
+
+/// Identifies a cache file; must be changed whenever the layout of BeadRecord changes
+static const char cache_magic[8] = {'S', 'U', 'R', 'P', 'C', 'A', '0', '1'};
+
+/// A single SURPASS bead, as stored in a cache file
+struct BeadRecord {
+  double x, y, z, occupancy, b_factor;
+  core::index4 residue_id;
+  core::index4 atom_id;
+  char atom_name[4];
+  char chain_id;
+  char ss;
+};
+
+/// 64-bit FNV-1a hash, continued from the given value
+static uint64_t fnv1a(const std::string &data, uint64_t h = 14695981039346656037ULL) {
+
+  for (unsigned char c : data) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+SurpassInputCache::SurpassInputCache(const std::string &directory) : directory(directory) {
+
+  if ((mkdir(directory.c_str(), 0777) != 0) && (errno != EEXIST))
+    throw std::runtime_error("Can't create a cache directory: " + directory + "\n");
+}
+
+std::string SurpassInputCache::key(const std::string &pdb_text, const core::data::sequence::SecondaryStructure &ss2_aa) {
+
+  uint64_t h = fnv1a(pdb_text);
+  h = fnv1a(ss2_aa.sequence, fnv1a("\n", h));
+  h = fnv1a(ss2_aa.str(), fnv1a("\n", h));
+  h = fnv1a(core::SURPASSversion::GIT_HASH, fnv1a("\n", h));
+  return utils::string_format("%016llx", (unsigned long long) h);
+}
+
+bool SurpassInputCache::load(const std::string &key, std::vector<Structure_SP> &structures) const {
+
+  std::ifstream in(utils::join_paths(directory, key + ".bin"), std::ios::binary);
+  if (!in) return false;
+  char magic[8];
+  core::index4 n_structures = 0;
+  if ((!in.read(magic, 8)) || (memcmp(magic, cache_magic, 8) != 0)) return false;
+  if (!in.read(reinterpret_cast<char *>(&n_structures), sizeof(n_structures))) return false;
+
+  std::vector<Structure_SP> loaded;
+  std::vector<BeadRecord> beads;
+  for (core::index4 i = 0; i < n_structures; ++i) {
+    core::index4 code_size = 0, n_beads = 0;
+    if (!in.read(reinterpret_cast<char *>(&code_size), sizeof(code_size))) return false;
+    std::string code(code_size, ' ');
+    if (!in.read(&code[0], code_size)) return false;
+    if (!in.read(reinterpret_cast<char *>(&n_beads), sizeof(n_beads))) return false;
+    beads.resize(n_beads);
+    if (!in.read(reinterpret_cast<char *>(beads.data()), n_beads * sizeof(BeadRecord))) return false;
+
+    Structure_SP s = std::make_shared<Structure>(code);
+    Chain_SP chain;
+    for (const BeadRecord &b : beads) {
+      if ((!chain) || (chain->id() != b.chain_id)) {
+        chain = std::make_shared<Chain>(b.chain_id);
+        s->push_back(chain);
+      }
+      Residue_SP r = std::make_shared<Residue>(b.residue_id, core::chemical::Monomer::GLY);
+      r->push_back(std::make_shared<PdbAtom>(b.atom_id, std::string(b.atom_name, 4), b.x, b.y, b.z, b.occupancy,
+                                             b.b_factor));
+      r->ss(b.ss);
+      chain->push_back(r);
+    }
+    loaded.push_back(s);
+  }
+  structures.insert(structures.end(), loaded.begin(), loaded.end());
+  ++n_hits;
+  return true;
+}
+
+void SurpassInputCache::store(const std::string &key, const std::vector<Structure_SP> &structures) const {
+
+  // --- A unique temporary name: concurrent writers of the same entry do not overwrite each other's partial files
+  std::ostringstream tmp_name;
+  tmp_name << utils::join_paths(directory, key) << ".tmp." << getpid() << "." << std::this_thread::get_id();
+  {
+    std::ofstream out(tmp_name.str(), std::ios::binary);
+    out.write(cache_magic, 8);
+    const core::index4 n_structures = structures.size();
+    out.write(reinterpret_cast<const char *>(&n_structures), sizeof(n_structures));
+    std::vector<BeadRecord> beads;
+    for (const Structure_SP &s : structures) {
+      beads.clear();
+      for (auto it = s->first_const_atom(); it != s->last_const_atom(); ++it) {
+        const PdbAtom &a = **it;
+        BeadRecord b;
+        memset(&b, 0, sizeof(BeadRecord)); // --- no random bytes in the padding
+        b.x = a.x;
+        b.y = a.y;
+        b.z = a.z;
+        b.occupancy = a.occupancy();
+        b.b_factor = a.b_factor();
+        b.residue_id = a.owner()->id();
+        b.atom_id = a.id();
+        memcpy(b.atom_name, a.atom_name().c_str(), 4);
+        b.chain_id = a.owner()->owner()->id();
+        b.ss = a.owner()->ss();
+        beads.push_back(b);
+      }
+      const core::index4 code_size = s->code().size(), n_beads = beads.size();
+      out.write(reinterpret_cast<const char *>(&code_size), sizeof(code_size));
+      out.write(s->code().c_str(), code_size);
+      out.write(reinterpret_cast<const char *>(&n_beads), sizeof(n_beads));
+      out.write(reinterpret_cast<const char *>(beads.data()), n_beads * sizeof(BeadRecord));
+    }
+    if (!out) {
+      std::remove(tmp_name.str().c_str());
+      logs << utils::LogLevel::WARNING << "Can't write a cache entry " << key << "\n";
+      return;
+    }
+  }
+  if (std::rename(tmp_name.str().c_str(), utils::join_paths(directory, key + ".bin").c_str()) != 0) {
+    std::remove(tmp_name.str().c_str());
+    logs << utils::LogLevel::WARNING << "Can't rename a cache entry " << key << "\n";
+  }
+}
+
+std::vector<Structure_SP> SurpassInputCache::surpass_structures(const std::string &pdb_fname,
+                                                                const core::data::sequence::SecondaryStructure &ss2_aa) const {
+
+  std::vector<Structure_SP> structures;
+  const std::string k = key(utils::load_text_file(pdb_fname), ss2_aa);
+  if (load(k, structures)) {
+    logs << utils::LogLevel::INFO << "input structures of " << pdb_fname << " found in the cache: " << k << "\n";
+    return structures;
+  }
+
+  core::data::io::Pdb reader(pdb_fname, core::data::io::is_not_alternative, true);
+  reader.create_structures(structures);
+  for (Structure_SP &s : structures) {
+    if (is_surpass_model(*s)) continue;
+    core::index2 res_cnt = 0;
+    for (auto res_it = s->first_residue(); res_it != s->last_residue(); ++res_it) (*res_it)->ss(ss2_aa.ss(res_cnt++));
+    s = surpass_representation(*s);
+  }
+  store(k, structures);
+  logs << utils::LogLevel::INFO << "input structures of " << pdb_fname << " stored in the cache: " << k << "\n";
+  return structures;
+}
+
+} // ~ representations
+} // ~ simulations
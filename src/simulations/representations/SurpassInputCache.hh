@@ -0,0 +1,81 @@
+/** \file SurpassInputCache.hh
+ * @brief Provides an on-disk cache of starting structures already converted to SURPASS representation
+ */
+#ifndef SIMULATIONS_REPRESENTATIONS_SurpassInputCache_HH
+#define SIMULATIONS_REPRESENTATIONS_SurpassInputCache_HH
+
+#include <string>
+#include <vector>
+
+#include <core/index.hh>
+#include <core/data/sequence/SecondaryStructure.hh>
+#include <core/data/structural/Structure.hh>
+#include <utils/Logger.hh>
+
+namespace simulations {
+namespace representations {
+
+/** @brief Stores starting structures in SURPASS representation, so the same inputs are not preprocessed again.
+ *
+ * Preparing a SURPASS run from an all-atom PDB file requires parsing the file, assigning secondary structure
+ * from an SS2 profile to every residue and converting the result with <code>surpass_representation()</code>.
+ * This cache keeps the outcome in a compact binary file, whose name is a hash of the PDB file content,
+ * the secondary structure string and the version of this program. The example below loads the structures
+ * from the cache when possible, otherwise prepares and stores them:
+ * @code
+ * SurpassInputCache cache("./surpass_cache");
+ * std::vector<core::data::structural::Structure_SP> structures = cache.surpass_structures("2gb1.pdb", *ss2_aa);
+ * @endcode
+ * Files are written under a temporary name and then renamed, so any number of processes may share a cache directory:
+ * a reader finds either a complete file or none at all.
+ */
+class SurpassInputCache {
+public:
+
+  /** @brief Uses the given directory as a cache; it is created when necessary
+   * @param directory - where cached structures are stored
+   */
+  SurpassInputCache(const std::string &directory);
+
+  /** @brief Computes the name of a cache entry
+   * @param pdb_text - content of the input PDB file
+   * @param ss2_aa - secondary structure assigned to the all-atom input
+   * @return hexadecimal hash string
+   */
+  static std::string key(const std::string &pdb_text, const core::data::sequence::SecondaryStructure &ss2_aa);
+
+  /** @brief Loads structures from the cache
+   * @param key - name of the entry, as returned by <code>key()</code>
+   * @param structures - destination for the structures (in SURPASS representation)
+   * @return false when the entry is missing or unreadable
+   */
+  bool load(const std::string &key, std::vector<core::data::structural::Structure_SP> &structures) const;
+
+  /** @brief Stores structures in the cache; an existing entry is replaced atomically
+   * @param key - name of the entry, as returned by <code>key()</code>
+   * @param structures - structures in SURPASS representation (one bead per residue)
+   */
+  void store(const std::string &key, const std::vector<core::data::structural::Structure_SP> &structures) const;
+
+  /** @brief Returns all models found in a PDB file, converted to SURPASS representation.
+   *
+   * The structures are loaded from the cache if possible; otherwise they are prepared and stored in the cache.
+   * @param pdb_fname - input PDB file, all-atom or already in SURPASS representation
+   * @param ss2_aa - secondary structure of the all-atom chain
+   */
+  std::vector<core::data::structural::Structure_SP> surpass_structures(const std::string &pdb_fname,
+                                                                       const core::data::sequence::SecondaryStructure &ss2_aa) const;
+
+  /// Returns the number of structure sets found in the cache by this object
+  core::index4 count_hits() const { return n_hits; }
+
+private:
+  std::string directory;
+  mutable core::index4 n_hits = 0;
+  static utils::Logger logs;
+};
+
+} // ~ representations
+} // ~ simulations
+
+#endif
@@ -1,3 +1,5 @@
+#include <cstdlib>
+
 #include <utils/io_utils.hh>
 #include <utils/string_utils.hh>
 #include <core/data/io/Pdb.hh>
@@ -184,6 +186,51 @@ core::data::sequence::SecondaryStructure_SP surpass_representation(
   return out;
 }
 
+core::index4 surpass_beads_from_pdb(const std::string &pdb_text, std::vector<core::data::basic::Vec3> &beads) {
+
+  using core::data::basic::Vec3;
+
+  beads.clear();
+  std::vector<Vec3> ca, other;
+  std::vector<char> ca_chain;
+  size_t pos = 0;
+  while (pos < pdb_text.size()) {
+    size_t end = pdb_text.find('\n', pos);
+    if (end == std::string::npos) end = pdb_text.size();
+    if ((end - pos >= 54) && (pdb_text.compare(pos, 6, "ATOM  ") == 0) &&
+        ((pdb_text[pos + 16] == ' ') || (pdb_text[pos + 16] == 'A'))) {
+      const char *line = pdb_text.c_str() + pos;
+      const Vec3 v(strtod(std::string(line + 30, 8).c_str(), nullptr), strtod(std::string(line + 38, 8).c_str(), nullptr),
+                   strtod(std::string(line + 46, 8).c_str(), nullptr));
+      if (pdb_text.compare(pos + 12, 4, " CA ") == 0) {
+        ca.push_back(v);
+        ca_chain.push_back(line[21]);
+      } else other.push_back(v);
+    }
+    pos = end + 1;
+  }
+
+  if (ca.empty()) {
+    beads.swap(other);
+    return beads.size();
+  }
+  // --- Average four consecutive CA atoms of each chain
+  size_t chain_start = 0;
+  for (size_t i = 0; i <= ca.size(); ++i) {
+    if ((i < ca.size()) && (ca_chain[i] == ca_chain[chain_start])) continue;
+    for (size_t k = chain_start; k + 3 < i; ++k) {
+      Vec3 b(ca[k]);
+      b += ca[k + 1];
+      b += ca[k + 2];
+      b += ca[k + 3];
+      b /= 4.0;
+      beads.push_back(b);
+    }
+    chain_start = i;
+  }
+  return beads.size();
+}
+
 bool is_surpass_model(const core::data::structural::Structure &strctr) {
 
   using namespace core::data::structural;
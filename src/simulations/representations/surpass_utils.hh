@@ -4,6 +4,11 @@
 #ifndef SIMULATIONS_REPRESENTATIONS_surpass_utils_HH
 #define SIMULATIONS_REPRESENTATIONS_surpass_utils_HH
 
+#include <vector>
+#include <string>
+
+#include <core/index.hh>
+#include <core/data/basic/Vec3.hh>
 #include <core/data/structural/Structure.hh>
 
 namespace simulations {
@@ -43,6 +48,19 @@ core::data::sequence::SecondaryStructure_SP surpass_representation(const core::d
  */
 bool is_surpass_model(const core::data::structural::Structure & strctr);
 
+/** @brief Computes positions of SURPASS beads directly from PDB records of a single model.
+ *
+ * This is a fast path meant for scoring large sets of models: only ATOM lines are parsed and no Structure object is created.
+ * If CA atoms are found, every bead is the average of four consecutive CA atoms of a chain, so a chain of N residues
+ * gives N-3 beads. Unlike <code>surpass_representation()</code>, this function does not check for missing residues.
+ * If there are no CA atoms, the model is assumed to be in the SURPASS representation already and every atom becomes a bead.
+ * Only the first variant of an atom with alternate locations is used.
+ * @param pdb_text - PDB-formatted text of a single model
+ * @param beads - resulting bead positions (the vector is cleared first)
+ * @return the number of beads
+ */
+core::index4 surpass_beads_from_pdb(const std::string & pdb_text, std::vector<core::data::basic::Vec3> & beads);
+
 }
 }
 
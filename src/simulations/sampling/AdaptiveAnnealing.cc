@@ -0,0 +1,90 @@
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+#include <utils/string_utils.hh>
+
+#include <simulations/sampling/AdaptiveAnnealing.hh>
+
+namespace simulations {
+namespace sampling {
+
+/// Average and standard deviation of energy values in the range [from, to)
+static void mean_sd(const std::vector<double> &energies, const size_t from, const size_t to, double &mean,
+                    double &sd) {
+
+  mean = 0.0;
+  for (size_t i = from; i < to; ++i) mean += energies[i];
+  mean /= (to - from);
+  double var = 0.0;
+  for (size_t i = from; i < to; ++i) var += (energies[i] - mean) * (energies[i] - mean);
+  sd = (to - from > 1) ? sqrt(var / (to - from - 1)) : 0.0;
+}
+
+AdaptiveAnnealing::AdaptiveAnnealing(movers::MoversSet_SP ms, forcefields::CalculateEnergyBase &energy,
+                                     const core::real t_start, const core::real t_end) :
+  IsothermalMC(ms, t_start), logger("AdaptiveAnnealing"), energy_(energy), t_start_(t_start), t_end_(t_end),
+  min_step_((t_start - t_end) * 0.01) {
+
+  if (t_end > t_start)
+    throw std::invalid_argument(utils::string_format(
+      "Annealing must cool a system down, but the final temperature %f is higher than the initial %f\n", t_end, t_start));
+}
+
+bool AdaptiveAnnealing::is_relaxed(const std::vector<double> &energies) const {
+
+  const size_t half = energies.size() / 2;
+  if (half < 2) return false;
+  double mean_1, sd_1, mean_2, sd_2;
+  mean_sd(energies, 0, half, mean_1, sd_1);
+  mean_sd(energies, half, energies.size(), mean_2, sd_2);
+
+  return fabs(mean_1 - mean_2) <= speed_ * sd_2;
+}
+
+void AdaptiveAnnealing::run() {
+
+  schedule_.clear();
+  const core::index4 block = std::max(n_outer_cycles, core::index4(1));
+  n_outer_cycles = 1; // --- energy is recorded after every outer cycle
+  std::vector<double> energies;
+  core::real t = t_start_;
+  while (true) {
+    temperature_ = t;
+    logger << utils::LogLevel::INFO << "Temperature set to " << t << "\n";
+    energies.clear();
+    do {
+      for (core::index4 i = 0; i < block; ++i) {
+        IsothermalMC::run();
+        energies.push_back(energy_.calculate());
+      }
+    } while ((energies.size() < max_dwell_ * block) && (!is_relaxed(energies)));
+
+    Stage s;
+    s.temperature = t;
+    s.outer_cycles = energies.size();
+    mean_sd(energies, energies.size() / 2, energies.size(), s.mean_energy, s.sd_energy);
+    s.heat_capacity = s.sd_energy * s.sd_energy / (t * t);
+    schedule_.push_back(s);
+    logger << utils::LogLevel::INFO << utils::string_format(
+      "T = %.3f: %d outer cycles, <E> = %.2f, sd(E) = %.2f, heat capacity = %.3f\n", t, int(s.outer_cycles),
+      s.mean_energy, s.sd_energy, s.heat_capacity);
+
+    if (t <= t_end_) break;
+    core::real dt = (s.sd_energy > 0) ? speed_ * t * t / s.sd_energy : max_step_fraction_ * t;
+    dt = std::max(min_step_, std::min(dt, max_step_fraction_ * t));
+    t = std::max(t - dt, t_end_);
+  }
+  n_outer_cycles = block;
+}
+
+void AdaptiveAnnealing::write_schedule(std::ostream &out) const {
+
+  out << "# temperature outer_cycles  mean_energy    sd_energy heat_capacity\n";
+  for (const Stage &s : schedule_)
+    out << utils::string_format("%13.4f %12d %12.3f %12.3f %13.4f\n", s.temperature, int(s.outer_cycles), s.mean_energy,
+                                s.sd_energy, s.heat_capacity);
+}
+
+} // ~ sampling
+} // ~ simulations
@@ -0,0 +1,120 @@
+/** @file AdaptiveAnnealing.hh
+ * @brief Provides AdaptiveAnnealing protocol: simulated annealing at a constant thermodynamic speed
+ */
+#ifndef SIMULATIONS_SAMPLING_AdaptiveAnnealing_HH
+#define SIMULATIONS_SAMPLING_AdaptiveAnnealing_HH
+
+#include <vector>
+#include <memory>
+#include <iostream>
+
+#include <core/real.hh>
+#include <core/index.hh>
+
+#include <utils/Logger.hh>
+
+#include <simulations/forcefields/CalculateEnergyBase.hh>
+#include <simulations/sampling/IsothermalMC.hh>
+
+namespace simulations {
+namespace sampling {
+
+/** @brief Simulated annealing which adjusts its schedule to energy fluctuations measured on the fly.
+ *
+ * A plain SimulatedAnnealing spends the same number of cycles at every temperature of a fixed, evenly spaced list,
+ * while only the temperatures close to a folding transition really matter. This protocol starts at
+ * <code>t_start</code> and measures the mean energy \f$ \langle E \rangle \f$ and its standard deviation
+ * \f$ \sigma_E \f$ at every temperature. The heat capacity \f$ C = \sigma_E^2 / T^2 \f$ tells how fast the mean energy
+ * changes with temperature, so the next temperature is lower by
+ * \f[
+ *    \Delta T = v \frac{\sigma_E}{C} = v \frac{T^2}{\sigma_E}
+ * \f]
+ * which shifts the mean energy by \f$ v \f$ standard deviations, i.e. the system moves at a constant thermodynamic
+ * speed \f$ v \f$. Steps are therefore small around a transition (large fluctuations) and large elsewhere.
+ *
+ * A dwell time at a temperature is <code>outer_cycles()</code> at least. The simulation stays longer
+ * (up to <code>max_dwell()</code> times more) until the mean energy of the first half of the samples differs from
+ * the mean of the second half by less than \f$ v \sigma_E \f$, i.e. until the energy has relaxed.
+ * The energy is sampled once per outer cycle.
+ *
+ * The realized schedule is available from <code>schedule()</code> and may be written to a file; its first two columns
+ * (temperature, the number of outer cycles) can be replayed by SimulatedAnnealing.
+ */
+class AdaptiveAnnealing : public IsothermalMC {
+public:
+
+  /// Statistics collected at a single temperature of the schedule
+  struct Stage {
+    core::real temperature; ///< temperature of this stage
+    core::index4 outer_cycles; ///< the number of outer cycles spent at this temperature
+    double mean_energy; ///< average energy (from the second half of the stage)
+    double sd_energy; ///< standard deviation of energy (from the second half of the stage)
+    double heat_capacity; ///< \f$ \sigma_E^2 / T^2 \f$
+  };
+
+  /** @brief Creates the protocol.
+   *
+   * @param ms - set of movers used for sampling
+   * @param energy - energy function of the sampled system, used to measure energy fluctuations
+   * @param t_start - the initial (the highest) temperature
+   * @param t_end - the final temperature
+   */
+  AdaptiveAnnealing(movers::MoversSet_SP ms, forcefields::CalculateEnergyBase &energy, const core::real t_start,
+                    const core::real t_end);
+
+  /// Virtual destructor
+  ~AdaptiveAnnealing() {}
+
+  /// Runs the whole protocol, from <code>t_start</code> down to <code>t_end</code>
+  void run();
+
+  /// Sets the thermodynamic speed: how many standard deviations the mean energy may shift between two temperatures
+  void thermodynamic_speed(const core::real speed) { speed_ = speed; }
+
+  /// Returns the thermodynamic speed
+  core::real thermodynamic_speed() const { return speed_; }
+
+  /// Sets the maximum dwell time at a temperature, as a multiple of <code>outer_cycles()</code>
+  void max_dwell(const core::index2 n_blocks) { max_dwell_ = std::max(n_blocks, core::index2(1)); }
+
+  /// Returns the maximum dwell time at a temperature, as a multiple of <code>outer_cycles()</code>
+  core::index2 max_dwell() const { return max_dwell_; }
+
+  /** @brief Sets the limits of a temperature decrement.
+   *
+   * @param min_step - the smallest decrement; by default 1% of the whole temperature range
+   * @param max_step_fraction - the largest decrement, as a fraction of the current temperature
+   */
+  void temperature_step_limits(const core::real min_step, const core::real max_step_fraction) {
+    min_step_ = min_step;
+    max_step_fraction_ = max_step_fraction;
+  }
+
+  /// Returns current simulation temperature
+  core::real temperature() const { return temperature_; }
+
+  /// The schedule realized by the most recent <code>run()</code>
+  const std::vector<Stage> &schedule() const { return schedule_; }
+
+  /// Writes the realized schedule as a table: temperature, outer cycles, mean energy, sd(energy), heat capacity
+  void write_schedule(std::ostream &out) const;
+
+private:
+  utils::Logger logger;
+  forcefields::CalculateEnergyBase &energy_;
+  const core::real t_start_;
+  const core::real t_end_;
+  core::real speed_ = 0.5;
+  core::index2 max_dwell_ = 4;
+  core::real min_step_;
+  core::real max_step_fraction_ = 0.25;
+  std::vector<Stage> schedule_;
+
+  /// True if the mean energy of the first half of the samples is close enough to the mean of the second half
+  bool is_relaxed(const std::vector<double> &energies) const;
+};
+
+} // ~ sampling
+} // ~ simulations
+
+#endif
@@ -0,0 +1,104 @@
+#include <cmath>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <algorithm>
+
+#include <utils/string_utils.hh>
+
+#include <simulations/sampling/AnnealingPortfolio.hh>
+
+namespace simulations {
+namespace sampling {
+
+AnnealingPortfolio::AnnealingPortfolio(std::vector<SimulatedAnnealing_SP> &runs, const ScoreFunction &score,
+                                       const core::index2 n_threads) :
+  runs_(runs), score_(score), active_(runs.size(), true),
+  scores_(runs.size(), std::numeric_limits<double>::infinity()),
+  pool((n_threads == 0) ? 0 : std::min(n_threads, core::index2(runs.size()))), logs("AnnealingPortfolio") {
+
+  if (runs_.empty()) throw std::invalid_argument("Annealing portfolio requires at least one run\n");
+  for (const auto &r : runs_)
+    if (r->count_temperatures() != runs_[0]->count_temperatures())
+      throw std::invalid_argument("All runs of an annealing portfolio must use the same number of temperatures\n");
+
+  // --- Separate random stream for every run; seeds come from the global engine so a simulation is repeatable
+  core::calc::statistics::Random &global = core::calc::statistics::Random::get();
+  for (auto &r : runs_) {
+    streams.emplace_back(new core::calc::statistics::Random(global()));
+    r->random_generator(*streams.back());
+  }
+  logs << utils::LogLevel::INFO << runs_.size() << " annealing runs will be executed on " << pool.size()
+       << " threads\n";
+}
+
+core::index2 AnnealingPortfolio::best() const {
+
+  core::index2 b = 0;
+  for (core::index2 i = 1; i < runs_.size(); ++i)
+    if (active_[i] && ((!active_[b]) || (scores_[i] < scores_[b]))) b = i;
+  return b;
+}
+
+void AnnealingPortfolio::run() {
+
+  const core::index2 n_temps = runs_[0]->count_temperatures();
+  core::index2 n_stages = n_stages_;
+  if (n_stages == 0) {
+    n_stages = 1;
+    if ((keep_fraction_ > 0.0) && (keep_fraction_ < 1.0))
+      n_stages += core::index2(std::ceil(log(double(runs_.size())) / -log(keep_fraction_) - 1e-9));
+  }
+  n_stages = std::max(core::index2(1), std::min(n_stages, n_temps));
+  logs << utils::LogLevel::INFO << "annealing schedule of " << n_temps << " temperatures split into " << n_stages
+       << " stages\n";
+
+  for (core::index2 stage = 0; stage < n_stages; ++stage) {
+    const core::index2 first = core::index4(stage) * n_temps / n_stages;
+    const core::index2 last = core::index4(stage + 1) * n_temps / n_stages;
+    std::vector<std::future<void>> jobs;
+    for (core::index2 i = 0; i < runs_.size(); ++i) {
+      if (!active_[i]) continue;
+      SimulatedAnnealing_SP r = runs_[i];
+      jobs.push_back(pool.submit([r, first, last]() { r->run(first, last); }));
+    }
+    for (auto &j : jobs) j.get();
+    checkpoint(stage + 1 < n_stages);
+  }
+}
+
+void AnnealingPortfolio::checkpoint(const bool prune) {
+
+  std::vector<core::index2> ranked;
+  for (core::index2 i = 0; i < runs_.size(); ++i)
+    if (active_[i]) ranked.push_back(i);
+  pool.parallel_for(0, ranked.size(), [&](core::index4 k) { scores_[ranked[k]] = score_(ranked[k]); });
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [this](const core::index2 a, const core::index2 b) { return scores_[a] < scores_[b]; });
+
+  if (logs.is_logable(utils::LogLevel::INFO)) {
+    logs << utils::LogLevel::INFO << "scores at checkpoint:";
+    for (core::index2 i : ranked) logs << utils::string_format(" %d:%.2f", i, scores_[i]);
+    logs << "\n";
+  }
+  if (!prune) return;
+
+  const core::index2 n_keep = std::max(core::index2(1),
+                                       core::index2(std::ceil(ranked.size() * keep_fraction_ - 1e-9)));
+  for (core::index2 k = n_keep; k < ranked.size(); ++k) {
+    const core::index2 pruned = ranked[k];
+    if (clone_) {
+      const core::index2 source = ranked[(k - n_keep) % n_keep];
+      clone_(source, pruned);
+      scores_[pruned] = scores_[source];
+      logs << utils::LogLevel::FINE << "run " << pruned << " replaced by a copy of run " << source << "\n";
+    } else {
+      active_[pruned] = false;
+      logs << utils::LogLevel::FINE << "run " << pruned << " stopped\n";
+    }
+  }
+}
+
+} // ~ sampling
+} // ~ simulations
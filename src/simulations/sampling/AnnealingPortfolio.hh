@@ -0,0 +1,109 @@
+/** @file AnnealingPortfolio.hh
+ * @brief Provides AnnealingPortfolio protocol: concurrent annealing runs pruned by successive halving
+ */
+#ifndef SIMULATIONS_SAMPLING_AnnealingPortfolio_HH
+#define SIMULATIONS_SAMPLING_AnnealingPortfolio_HH
+
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/calc/statistics/Random.hh>
+
+#include <utils/Logger.hh>
+#include <utils/ThreadPool.hh>
+
+#include <simulations/sampling/SimulatedAnnealing.hh>
+
+namespace simulations {
+namespace sampling {
+
+/// Declares a shared pointer to SimulatedAnnealing type
+typedef std::shared_ptr<SimulatedAnnealing> SimulatedAnnealing_SP;
+
+/** @brief A portfolio of simulated annealing runs, where unpromising runs are stopped early.
+ *
+ * All the runs follow the same annealing schedule, which is split into a number of stages. The stages are executed
+ * concurrently by all active runs on a thread pool. At the end of every stage (a checkpoint) the active runs are ranked
+ * by a score (the lower the better, e.g. the total energy) and only the best <code>keep_fraction()</code> of them continue
+ * (successive halving). Computer time is therefore spent mostly on the trajectories that turned out to be the most promising.
+ *
+ * When a clone function is provided, pruned runs are not stopped: their systems are overwritten by copies of the best
+ * ones, so the pool stays full and the search focuses around the best conformations.
+ *
+ * Every run gets its own random engine (seeded from the <code>Random::get()</code> singleton), so the results
+ * are repeatable for a given seed regardless of the number of threads.
+ */
+class AnnealingPortfolio {
+public:
+
+  /// Score of a run given by its index; the lower the better
+  typedef std::function<double(const core::index2)> ScoreFunction;
+
+  /// Copies the state of the <code>from</code> run onto the <code>to</code> run
+  typedef std::function<void(const core::index2 from, const core::index2 to)> CloneFunction;
+
+  /** @brief Creates the protocol.
+   *
+   * @param runs - annealing samplers; all of them must use the same number of temperatures
+   * @param score - function that evaluates the current state of a run
+   * @param n_threads - the number of threads used to run the samplers; 0 means all hardware threads
+   */
+  AnnealingPortfolio(std::vector<SimulatedAnnealing_SP> &runs, const ScoreFunction &score,
+                     const core::index2 n_threads = 0);
+
+  /// Returns the number of annealing runs
+  core::index2 count_runs() const { return runs_.size(); }
+
+  /// Sets the fraction of active runs that survive a checkpoint (0.5 by default)
+  void keep_fraction(const core::real fraction) { keep_fraction_ = fraction; }
+
+  /// Returns the fraction of active runs that survive a checkpoint
+  core::real keep_fraction() const { return keep_fraction_; }
+
+  /** @brief Sets the number of stages the annealing schedule is split into.
+   *
+   * By default the number of stages is the smallest one that leaves a single run active at the end of the protocol;
+   * it can't be larger than the number of temperatures.
+   */
+  void count_stages(const core::index2 n_stages) { n_stages_ = n_stages; }
+
+  /** @brief Makes the protocol refill the pool with copies of the best runs.
+   * @param clone - function copying one run onto another; <code>nullptr</code> turns cloning off
+   */
+  void clone_best(const CloneFunction &clone) { clone_ = clone; }
+
+  /// Runs the whole protocol
+  void run();
+
+  /// Returns true if a given run survived all the checkpoints so far
+  bool is_active(const core::index2 which_run) const { return active_[which_run]; }
+
+  /// Returns the score of a given run evaluated at the most recent checkpoint
+  double score(const core::index2 which_run) const { return scores_[which_run]; }
+
+  /// Returns the index of a run that has the best score at the most recent checkpoint
+  core::index2 best() const;
+
+private:
+  std::vector<SimulatedAnnealing_SP> runs_;
+  ScoreFunction score_;
+  CloneFunction clone_ = nullptr;
+  std::vector<std::unique_ptr<core::calc::statistics::Random>> streams;
+  std::vector<bool> active_;
+  std::vector<double> scores_;
+  core::real keep_fraction_ = 0.5;
+  core::index2 n_stages_ = 0;
+  utils::ThreadPool pool;
+  utils::Logger logs;
+
+  /// Scores active runs; if <code>prune</code> is true, keeps only the best of them
+  void checkpoint(const bool prune);
+};
+
+} // ~ sampling
+} // ~ simulations
+
+#endif
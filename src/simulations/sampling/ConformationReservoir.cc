@@ -0,0 +1,58 @@
+#include <fstream>
+#include <cstring>
+
+#include <simulations/sampling/ConformationReservoir.hh>
+
+namespace simulations {
+namespace sampling {
+
+/// Identifies a reservoir file; must be changed whenever the file layout changes
+static const char reservoir_magic[8] = {'S', 'U', 'R', 'P', 'R', 'S', 'V', '1'};
+
+ConformationReservoir::ConformationReservoir(const std::string &fname) {
+
+  std::ifstream in(fname, std::ios::binary);
+  char magic[8];
+  double t = 0;
+  core::index4 n_conformations = 0;
+  if ((!in.read(magic, 8)) || (memcmp(magic, reservoir_magic, 8) != 0))
+    throw std::runtime_error("Not a reservoir file: " + fname + "\n");
+  in.read(reinterpret_cast<char *>(&t), sizeof(t));
+  in.read(reinterpret_cast<char *>(&n_atoms_), sizeof(n_atoms_));
+  in.read(reinterpret_cast<char *>(&n_conformations), sizeof(n_conformations));
+  if (!in) throw std::runtime_error("Truncated reservoir file: " + fname + "\n");
+
+  // --- the header must agree with the size of the file before any memory is allocated for the data
+  const std::streamoff data_start = in.tellg();
+  in.seekg(0, std::ios::end);
+  const std::streamoff data_size = in.tellg() - data_start;
+  in.seekg(data_start);
+  if ((n_atoms_ == 0) ||
+      (double(data_size) != double(n_conformations) * (1.0 + 3.0 * n_atoms_) * sizeof(double)))
+    throw std::runtime_error(utils::string_format(
+      "Corrupted reservoir file: %s; its size doesn't match %d conformations of %d atoms\n",
+      fname.c_str(), int(n_conformations), int(n_atoms_)));
+  temperature_ = t;
+  energies_.resize(n_conformations);
+  xyz_.resize(3 * size_t(n_atoms_) * n_conformations);
+  in.read(reinterpret_cast<char *>(energies_.data()), n_conformations * sizeof(double));
+  in.read(reinterpret_cast<char *>(xyz_.data()), xyz_.size() * sizeof(double));
+  if (!in) throw std::runtime_error("Truncated reservoir file: " + fname + "\n");
+}
+
+void ConformationReservoir::write(const std::string &fname) const {
+
+  std::ofstream out(fname, std::ios::binary);
+  const double t = temperature_;
+  const core::index4 n_conformations = energies_.size();
+  out.write(reservoir_magic, 8);
+  out.write(reinterpret_cast<const char *>(&t), sizeof(t));
+  out.write(reinterpret_cast<const char *>(&n_atoms_), sizeof(n_atoms_));
+  out.write(reinterpret_cast<const char *>(&n_conformations), sizeof(n_conformations));
+  out.write(reinterpret_cast<const char *>(energies_.data()), n_conformations * sizeof(double));
+  out.write(reinterpret_cast<const char *>(xyz_.data()), xyz_.size() * sizeof(double));
+  if (!out) throw std::runtime_error("Can't write a reservoir file: " + fname + "\n");
+}
+
+}
+}
@@ -0,0 +1,109 @@
+/** @file ConformationReservoir.hh
+ *  @brief Provides ConformationReservoir: conformations with their energies, stored in a binary file
+ */
+#ifndef SIMULATIONS_SAMPLING_ConformationReservoir_HH
+#define SIMULATIONS_SAMPLING_ConformationReservoir_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <utils/string_utils.hh>
+
+#include <simulations/systems/CartesianAtomsSimple.hh>
+
+namespace simulations {
+namespace sampling {
+
+/** @brief A set of conformations of a system, sampled at a single temperature, with their energies.
+ *
+ * A reservoir is recorded during a simulation, e.g. from the highest temperature of a replica exchange run,
+ * written to a binary file and loaded by another run to be used by ReplicaExchangeMC::reservoir().
+ * Only the positions of atoms are stored, so a conformation may be copied into any system of the same size.
+ */
+class ConformationReservoir {
+public:
+
+  /** @brief Creates an empty reservoir
+   * @param temperature - temperature the conformations are sampled at
+   * @param n_atoms - size of the system
+   */
+  ConformationReservoir(const core::real temperature, const core::index4 n_atoms) :
+    temperature_(temperature), n_atoms_(n_atoms) {}
+
+  /** @brief Loads a reservoir from a file written by <code>write()</code>
+   * @param fname - input file name
+   * @throw std::runtime_error when the file can't be read or its size doesn't match its header
+   */
+  ConformationReservoir(const std::string &fname);
+
+  /// Temperature the conformations have been sampled at
+  core::real temperature() const { return temperature_; }
+
+  /// The number of atoms of every conformation
+  core::index4 count_atoms() const { return n_atoms_; }
+
+  /// The number of conformations in this reservoir
+  core::index4 count_conformations() const { return energies_.size(); }
+
+  /// Energies of the conformations, in the order they were added
+  const std::vector<double> &energies() const { return energies_; }
+
+  /** @brief Adds the current conformation of a system
+   * @param system - a system of <code>count_atoms()</code> atoms
+   * @param energy - energy of the system
+   */
+  template<class C>
+  void add(const systems::CartesianAtomsSimple<C> &system, const double energy) {
+
+    check_size(system.n_atoms);
+    for (core::index4 i = 0; i < n_atoms_; ++i) {
+      xyz_.push_back(system.coordinates[i].x);
+      xyz_.push_back(system.coordinates[i].y);
+      xyz_.push_back(system.coordinates[i].z);
+    }
+    energies_.push_back(energy);
+  }
+
+  /** @brief Copies a conformation into a system; other properties of its atoms remain unchanged
+   * @param which - index of a conformation
+   * @param system - a system of <code>count_atoms()</code> atoms
+   */
+  template<class C>
+  void copy_to(const core::index4 which, systems::CartesianAtomsSimple<C> &system) const {
+
+    check_size(system.n_atoms);
+    const double *p = xyz_.data() + 3 * size_t(n_atoms_) * which;
+    for (core::index4 i = 0; i < n_atoms_; ++i, p += 3) {
+      system.coordinates[i].x = p[0];
+      system.coordinates[i].y = p[1];
+      system.coordinates[i].z = p[2];
+    }
+  }
+
+  /// Writes this reservoir to a binary file
+  void write(const std::string &fname) const;
+
+private:
+  core::real temperature_;
+  core::index4 n_atoms_;
+  std::vector<double> energies_;
+  std::vector<double> xyz_; ///< coordinates of all the conformations, one after another
+
+  void check_size(const core::index4 n_atoms) const {
+    if (n_atoms != n_atoms_)
+      throw std::invalid_argument(utils::string_format("The reservoir holds conformations of %d atoms, the system has %d\n",
+        int(n_atoms_), int(n_atoms)));
+  }
+};
+
+/// Shared pointer to a ConformationReservoir
+typedef std::shared_ptr<ConformationReservoir> ConformationReservoir_SP;
+
+}
+}
+
+#endif
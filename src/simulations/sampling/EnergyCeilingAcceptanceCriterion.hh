@@ -0,0 +1,96 @@
+#ifndef SIMULATIONS_GENERIC_SAMPLING_EnergyCeilingAcceptanceCriterion_HH
+#define SIMULATIONS_GENERIC_SAMPLING_EnergyCeilingAcceptanceCriterion_HH
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/calc/statistics/Random.hh>
+
+#include <simulations/sampling/AbstractAcceptanceCriterion.hh>
+
+namespace simulations {
+namespace sampling {
+
+/** @brief Accepts only moves that keep the total energy of a system below a ceiling.
+ *
+ * Movers test energy of the moved part of a system only, so this criterion keeps track of the total energy:
+ * it must be given the energy of the system with <code>energy()</code> before the first move; every accepted
+ * move then updates it by the energy change. Below the ceiling moves are accepted with the Metropolis criterion
+ * at the prior temperature, which is infinite by default (every move below the ceiling is accepted).
+ * Since the total energy is updated after every positive test, the criterion can't be used with a surrogate energy
+ * (delayed acceptance), which tests a single move twice.
+ */
+class EnergyCeilingAcceptanceCriterion : public AbstractAcceptanceCriterion {
+public:
+
+  /** @brief Creates an acceptance criterion
+   *
+   * @param ceiling - the highest energy allowed (exclusive)
+   * @param generator - random engine used for the Monte Carlo test
+   */
+  EnergyCeilingAcceptanceCriterion(const core::real ceiling,
+      core::calc::statistics::Random &generator = core::calc::statistics::Random::get()) :
+    ceiling_(ceiling), generator(generator), rando(0.0, 1.0) {}
+
+  /// Returns the energy ceiling
+  core::real ceiling() const { return ceiling_; }
+
+  /// Sets the new energy ceiling
+  void ceiling(const core::real new_ceiling) { ceiling_ = new_ceiling; }
+
+  /// Returns the total energy of the system, as updated by accepted moves
+  core::real energy() const { return energy_; }
+
+  /// Sets the total energy of the system
+  void energy(const core::real total_energy) { energy_ = total_energy; }
+
+  /// Sets the temperature of the Metropolis test made below the ceiling; infinity turns the test off
+  void prior_temperature(const core::real temperature) { prior_temperature_ = temperature; }
+
+  /// Returns the temperature of the Metropolis test made below the ceiling
+  core::real prior_temperature() const { return prior_temperature_; }
+
+  /// The number of tests made since the last <code>reset_counters()</code> call
+  core::index4 count_tests() const { return n_tests; }
+
+  /// The number of moves accepted since the last <code>reset_counters()</code> call
+  core::index4 count_accepted() const { return n_accepted; }
+
+  /// Resets counters of tests and accepted moves
+  void reset_counters() { n_tests = n_accepted = 0; }
+
+  /** @brief Performs the Monte Carlo test
+   *
+   * @param old_energy - energy before the considered move
+   * @param new_energy - energy after the considered move
+   * @return true if the move should be accepted; false otherwise
+   */
+  inline bool test(const core::real old_energy, const core::real new_energy) {
+
+    ++n_tests;
+    const core::real delta_E = new_energy - old_energy;
+    if (energy_ + delta_E >= ceiling_) return false;
+    if ((delta_E > 0) && (prior_temperature_ < std::numeric_limits<core::real>::infinity()))
+      if (rando(generator) > exp(-delta_E / prior_temperature_)) return false;
+    energy_ += delta_E;
+    ++n_accepted;
+    return true;
+  }
+
+private:
+  core::real ceiling_;
+  core::real energy_ = 0.0;
+  core::real prior_temperature_ = std::numeric_limits<core::real>::infinity();
+  core::index4 n_tests = 0;
+  core::index4 n_accepted = 0;
+  core::calc::statistics::Random &generator;
+  std::uniform_real_distribution<float> rando;
+};
+
+} // ~ sampling
+} // ~ simulations
+
+#endif
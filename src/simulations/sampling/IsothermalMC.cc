@@ -1,3 +1,5 @@
+#include <chrono>
+
 #include <simulations/movers/Mover.hh>
 #include <simulations/sampling/IsothermalMC.hh>
 #include <simulations/sampling/MetropolisAcceptanceCriterion.hh>
@@ -7,20 +9,43 @@ namespace sampling {
 
 void IsothermalMC::run() {
 
-  MetropolisAcceptanceCriterion mc(temperature_);
+  MetropolisAcceptanceCriterion mc(temperature_, *generator_);
 
   for (core::index4 i = 0; i < n_outer_cycles; i++) {
+    const bool adapting = movers->is_adapting(); // --- CPU time of every mover is measured to adapt the mover mix
     for (core::index2 j = 0; j < n_inner_cycles; j++) {
       for (core::index4 k = 0; k < n_cycle_size; ++k) {
-        for (movers::MoversIterator m_it = movers->begin(); m_it != movers->end(); ++m_it) (*m_it)->move(mc);
+        for (movers::MoversIterator m_it = movers->begin(); m_it != movers->end(); ++m_it) {
+          if (!(profiler || adapting)) {
+            (*m_it)->move(mc);
+            continue;
+          }
+          const core::index2 s = (profiler) ? mover_sections[(*m_it).get()] : 0;
+          if (profiler) profiler->start(s);
+          const auto start = std::chrono::steady_clock::now();
+          (*m_it)->move(mc);
+          if (adapting)
+            (*m_it)->add_time(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+          if (profiler) profiler->stop(s);
+        }
       }
       call_inner_cycle_evaluators();
       call_inner_cycle_observers();
     }
+    if (adapting) movers->update_mix();
     call_outer_cycle_evaluators();
     call_outer_cycle_observers();
   }
 }
 
+void IsothermalMC::profile(std::shared_ptr<utils::PerfCounters> counters) {
+
+  SamplingProtocolBase::profile(counters);
+  mover_sections.clear();
+  if (counters)
+    for (core::index2 i = 0; i < movers->count_movers(); ++i)
+      mover_sections[movers->get_mover(i).get()] = counters->section("mover:" + movers->get_mover(i)->name());
+}
+
 }
 }
@@ -1,7 +1,10 @@
 #ifndef SIMULATIONS_GENERIC_SAMPLING_IsothermalMC_HH
 #define SIMULATIONS_GENERIC_SAMPLING_IsothermalMC_HH
 
+#include <unordered_map>
+
 #include <core/real.hh>
+#include <core/calc/statistics/Random.hh>
 
 #include <simulations/movers/MoversSet.hh>
 #include <simulations/sampling/SamplingProtocolBase.hh>
@@ -43,9 +46,28 @@ public:
   /// Sets the new value of the simulation temperature
   void temperature(const core::real new_temperature) { temperature_ = new_temperature; }
 
+  /** @brief Sets the random engine used by this sampler: by the Metropolis criterion and by all its movers.
+   *
+   * Samplers running concurrently must not share a random engine.
+   * @param generator - random engine; must live as long as this sampler is used
+   */
+  void random_generator(core::calc::statistics::Random &generator) {
+    generator_ = &generator;
+    movers->random_generator(generator);
+  }
+
+  /** @brief Measures time and hardware events spent by every mover and every observer of this sampler.
+   *
+   * A mover section includes the energy evaluated by the mover.
+   * @param counters - counters used for the measurements; <code>nullptr</code> turns the measurements off
+   */
+  virtual void profile(std::shared_ptr<utils::PerfCounters> counters);
+
 protected:
+  std::unordered_map<const movers::Mover *, core::index2> mover_sections; ///< profiler section of every mover
   movers::MoversSet_SP movers; ///< Movers to be called to sample
   core::real temperature_ = 0; ///< Current temperature
+  core::calc::statistics::Random *generator_ = &core::calc::statistics::Random::get(); ///< random engine of this sampler
 };
 
 typedef std::shared_ptr<IsothermalMC> IsothermalMC_SP;
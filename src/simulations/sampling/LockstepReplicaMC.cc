@@ -0,0 +1,158 @@
+#include <cmath>
+#include <stdexcept>
+
+#include <utils/string_utils.hh>
+
+#include <simulations/forcefields/surpass/SurpassContactEnergy.hh>
+#include <simulations/sampling/LockstepReplicaMC.hh>
+
+namespace simulations {
+namespace sampling {
+
+using core::data::basic::Vec3;
+
+LockstepReplicaMC::LockstepReplicaMC(std::vector<std::shared_ptr<systems::surpass::SurpassModel<Vec3>>> &systems,
+                                     std::vector<std::shared_ptr<forcefields::TotalEnergyByResidue>> &energies,
+                                     const std::vector<core::real> &temperatures) :
+  n_lanes(systems.size()), n_residues(systems.at(0)->count_residues()), systems_(systems),
+  temperatures_(temperatures), before(systems.size()), after(systems.size()), backup(systems.size()),
+  n_accepted(systems.size(), 0),
+  rand_residue(0, systems[0]->count_residues() - 1), rand_coordinate(-0.5, 0.5), rando(0.0, 1.0),
+  logs("LockstepReplicaMC") {
+
+  if ((energies.size() != n_lanes) || (temperatures.size() != n_lanes))
+    throw std::invalid_argument(utils::string_format("%d systems given for %d energy functions and %d temperatures\n",
+                                                     int(n_lanes), int(energies.size()), int(temperatures.size())));
+
+  // --- Split every total energy into the contact term, evaluated in lock-step, and the other terms
+  std::vector<std::shared_ptr<forcefields::surpass::SurpassContactEnergy<Vec3>>> contact(n_lanes);
+  for (core::index2 l = 0; l < n_lanes; ++l) {
+    if (systems_[l]->count_residues() != n_residues)
+      throw std::invalid_argument("All replicas advanced in lock-step must have the same number of residues\n");
+    other_terms.push_back(std::make_shared<forcefields::TotalEnergyByResidue>());
+    for (core::index2 i = 0; i < energies[l]->count_components(); ++i) {
+      auto c = std::dynamic_pointer_cast<forcefields::surpass::SurpassContactEnergy<Vec3>>(energies[l]->get_component(i));
+      if ((c != nullptr) && (contact[l] == nullptr)) {
+        contact[l] = c;
+        contact_weight = energies[l]->get_factors()[i];
+      } else other_terms[l]->add_component(energies[l]->get_component(i), energies[l]->get_factors()[i]);
+    }
+    if ((contact[l] == nullptr) != (contact[0] == nullptr))
+      throw std::invalid_argument("Energy functions of replicas advanced in lock-step must have the same terms\n");
+  }
+
+  // --- Tabulate pair parameters; they are the same in every lane except the contact energy
+  row_start.assign(n_residues + 1, 0);
+  if (contact[0] != nullptr) {
+    high_energy = contact[0]->high_energy_level();
+    core::real s2, p2, l2, pe;
+    for (core::index4 i = 0; i < n_residues; ++i) {
+      for (core::index4 j = 0; j < n_residues; ++j) {
+        if ((j + 3 > i) && (i + 3 > j)) continue; // --- the same offset as used by SurpassContactEnergy
+        if (!contact[0]->pair_parameters(i, j, s2, p2, l2, pe)) continue;
+        partner.push_back(j);
+        shortest2.push_back(s2);
+        premium2.push_back(p2);
+        longest2.push_back(l2);
+        for (core::index2 l = 0; l < n_lanes; ++l) {
+          contact[l]->pair_parameters(i, j, s2, p2, l2, pe);
+          premium_energy.push_back(pe);
+        }
+      }
+      row_start[i + 1] = partner.size();
+    }
+  }
+
+  x.resize(n_residues * n_lanes);
+  y.resize(n_residues * n_lanes);
+  z.resize(n_residues * n_lanes);
+  for (core::index4 i = 0; i < n_residues; ++i)
+    for (core::index2 l = 0; l < n_lanes; ++l) {
+      x[i * n_lanes + l] = systems_[l]->coordinates[i].x;
+      y[i * n_lanes + l] = systems_[l]->coordinates[i].y;
+      z[i * n_lanes + l] = systems_[l]->coordinates[i].z;
+    }
+
+  logs << utils::LogLevel::INFO << n_lanes << " replicas advanced in lock-step, " << partner.size()
+       << " residue pairs tabulated for the contact energy\n";
+}
+
+void LockstepReplicaMC::contact_by_residue(const core::index2 which_residue, double *energy) const {
+
+  const core::index4 w = n_lanes;
+  for (core::index4 l = 0; l < w; ++l) energy[l] = 0.0;
+  const core::real *xi = &x[which_residue * w], *yi = &y[which_residue * w], *zi = &z[which_residue * w];
+  for (core::index4 k = row_start[which_residue]; k < row_start[which_residue + 1]; ++k) {
+    const core::index4 j = partner[k] * w;
+    const core::real *xj = &x[j], *yj = &y[j], *zj = &z[j];
+    const core::real *pe = &premium_energy[k * w];
+    const core::real s2 = shortest2[k], p2 = premium2[k], l2 = longest2[k];
+    // --- no branches here: this loop runs over lanes and should be vectorized
+    for (core::index4 l = 0; l < w; ++l) {
+      const core::real dx = xi[l] - xj[l];
+      const core::real dy = yi[l] - yj[l];
+      const core::real dz = zi[l] - zj[l];
+      const core::real r2 = dx * dx + dy * dy + dz * dz;
+      const core::real e = ((r2 < s2) ? high_energy : 0.0) + ((r2 > p2) ? pe[l] : 0.0);
+      energy[l] += (r2 < l2) ? e : 0.0;
+    }
+  }
+}
+
+void LockstepReplicaMC::step() {
+
+  const core::index4 r = rand_residue(*generator_);
+  const core::index4 offset = r * n_lanes;
+
+  contact_by_residue(r, before.data());
+  for (core::index2 l = 0; l < n_lanes; ++l)
+    before[l] = before[l] * contact_weight + other_terms[l]->calculate_by_residue(r);
+
+  for (core::index2 l = 0; l < n_lanes; ++l) {
+    Vec3 &v = systems_[l]->coordinates[r];
+    backup[l].set(v);
+    v.x += rand_coordinate(*generator_);
+    v.y += rand_coordinate(*generator_);
+    v.z += rand_coordinate(*generator_);
+    x[offset + l] = v.x;
+    y[offset + l] = v.y;
+    z[offset + l] = v.z;
+  }
+
+  contact_by_residue(r, after.data());
+  for (core::index2 l = 0; l < n_lanes; ++l)
+    after[l] = after[l] * contact_weight + other_terms[l]->calculate_by_residue(r);
+
+  ++n_attempted;
+  for (core::index2 l = 0; l < n_lanes; ++l) {
+    const double delta = after[l] - before[l];
+    if ((delta <= 0) || (rando(*generator_) <= exp(-delta / temperatures_[l]))) {
+      ++n_accepted[l];
+      continue;
+    }
+    Vec3 &v = systems_[l]->coordinates[r];
+    v.set(backup[l]);
+    x[offset + l] = v.x;
+    y[offset + l] = v.y;
+    z[offset + l] = v.z;
+  }
+}
+
+void LockstepReplicaMC::run() {
+
+  for (core::index4 i = 0; i < n_outer_cycles; i++) {
+    for (core::index4 j = 0; j < n_inner_cycles; j++) {
+      for (core::index4 k = 0; k < n_cycle_size * n_residues; ++k) step();
+      call_inner_cycle_evaluators();
+      call_inner_cycle_observers();
+    }
+    call_outer_cycle_evaluators();
+    call_outer_cycle_observers();
+  }
+  for (core::index2 l = 0; l < n_lanes; ++l)
+    logs << utils::LogLevel::INFO << utils::string_format("lane %d at T=%.3f : acceptance rate %.3f\n", l,
+                                                          temperatures_[l], acceptance_rate(l));
+}
+
+} // ~ sampling
+} // ~ simulations
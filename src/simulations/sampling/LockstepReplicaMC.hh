@@ -0,0 +1,116 @@
+/** @file LockstepReplicaMC.hh
+ * @brief Provides LockstepReplicaMC: Monte Carlo for many replicas of a SURPASS system advanced in lock-step
+ */
+#ifndef SIMULATIONS_SAMPLING_LockstepReplicaMC_HH
+#define SIMULATIONS_SAMPLING_LockstepReplicaMC_HH
+
+#include <random>
+#include <vector>
+#include <memory>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/data/basic/Vec3.hh>
+#include <core/calc/statistics/Random.hh>
+
+#include <utils/Logger.hh>
+
+#include <simulations/systems/surpass/SurpassModel.hh>
+#include <simulations/forcefields/TotalEnergyByResidue.hh>
+#include <simulations/sampling/SamplingProtocolBase.hh>
+
+namespace simulations {
+namespace sampling {
+
+/** @brief Isothermal Monte Carlo of many replicas of the same protein, advanced in lock-step on a single thread.
+ *
+ * A small protein can't keep a CPU core busy when each replica runs its own scalar code on a separate thread.
+ * This sampler keeps coordinates of all the replicas (lanes) interleaved: the position of a residue in every lane is stored
+ * in consecutive elements of an array (replica-minor layout). Every step perturbs the same residue in all the lanes
+ * (each lane gets its own random displacement) and the change of the contact energy, which is the only term whose cost
+ * grows with the size of a protein, is evaluated for all the lanes in a single pass over the list of interacting pairs.
+ * The inner loop of that pass runs over lanes and is branch-free, so the compiler turns it into vector instructions.
+ * Each lane is then accepted or rejected by its own Metropolis test.
+ *
+ * Parameters of the contact energy (SurpassContactEnergy) are tabulated once for every pair of residues.
+ * The remaining energy terms are local and are evaluated for every lane separately by the regular scalar code.
+ * The sampler makes single-residue perturbations only, as PerturbResidue mover does; a sweep comprises as many moves
+ * as there are residues.
+ */
+class LockstepReplicaMC : public SamplingProtocolBase {
+public:
+
+  /** @brief Creates a lock-step sampler.
+   *
+   * @param systems - replicas; all of them must represent the same protein
+   * @param energies - total energy of every replica; the SurpassContactEnergy term (if present) is evaluated in lock-step
+   * @param temperatures - temperature for every replica
+   */
+  LockstepReplicaMC(std::vector<std::shared_ptr<systems::surpass::SurpassModel<core::data::basic::Vec3>>> &systems,
+                    std::vector<std::shared_ptr<forcefields::TotalEnergyByResidue>> &energies,
+                    const std::vector<core::real> &temperatures);
+
+  /// Returns the number of replicas advanced together
+  core::index2 count_lanes() const { return n_lanes; }
+
+  /// Sets the maximum displacement of a residue along each coordinate
+  void max_move_range(const core::real step) { rand_coordinate = std::uniform_real_distribution<core::real>(-step, step); }
+
+  /// Returns the temperature of a given lane
+  core::real temperature(const core::index2 lane) const { return temperatures_[lane]; }
+
+  /// Returns the fraction of accepted moves in a given lane
+  double acceptance_rate(const core::index2 lane) const {
+    return (n_attempted > 0) ? n_accepted[lane] / double(n_attempted) : 0.0;
+  }
+
+  /** @brief Sets the random engine used by this sampler.
+   * @param generator - random engine; must live as long as this sampler is used
+   */
+  void random_generator(core::calc::statistics::Random &generator) { generator_ = &generator; }
+
+  /** @brief Runs the sampling protocol.
+   *
+   * Makes  \f$ N_O \f$ = <code>outer_cycles()</code> of \f$ N_I \f$ = <code>inner_cycles()</code> of Monte Carlo sweeps
+   * in every lane.
+   */
+  void run();
+
+  /** @brief Contact energy of a given residue in every lane.
+   *
+   * @param which_residue - index of a residue
+   * @param energy - array of <code>count_lanes()</code> values, where the results are stored
+   */
+  void contact_by_residue(const core::index2 which_residue, double *energy) const;
+
+private:
+  const core::index2 n_lanes;
+  const core::index4 n_residues;
+  std::vector<std::shared_ptr<systems::surpass::SurpassModel<core::data::basic::Vec3>>> systems_;
+  std::vector<std::shared_ptr<forcefields::TotalEnergyByResidue>> other_terms; ///< terms evaluated lane by lane
+  std::vector<core::real> temperatures_;
+  core::real contact_weight = 0.0;
+  core::real high_energy = 0.0;
+  std::vector<core::real> x, y, z; ///< coordinates of residue i in lane l are stored at [i * n_lanes + l]
+  std::vector<core::index4> row_start; ///< pairs of residue i are stored at [row_start[i], row_start[i+1])
+  std::vector<core::index2> partner;
+  std::vector<core::real> shortest2, premium2, longest2;
+  std::vector<core::real> premium_energy; ///< contact energy for pair k in lane l is stored at [k * n_lanes + l]
+  std::vector<double> before, after;
+  std::vector<core::data::basic::Vec3> backup; ///< position of the moved residue in every lane before a move
+  core::index4 n_attempted = 0;
+  std::vector<core::index4> n_accepted;
+  core::calc::statistics::Random *generator_ = &core::calc::statistics::Random::get();
+  std::uniform_int_distribution<core::index4> rand_residue;
+  std::uniform_real_distribution<core::real> rand_coordinate;
+  std::uniform_real_distribution<core::real> rando;
+  utils::Logger logs;
+
+  /// Perturbs a single residue in all the lanes and accepts or rejects the move lane by lane
+  void step();
+};
+
+} // ~ sampling
+} // ~ simulations
+
+#endif
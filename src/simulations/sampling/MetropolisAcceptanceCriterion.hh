@@ -19,8 +19,11 @@ public:
   /** @brief Creates an acceptance criterion for a given temperature
    *
    * @param temperature - temperature defines the canonical distribution
+   * @param generator - random engine used for the Monte Carlo test
    */
-  MetropolisAcceptanceCriterion(const core::real temperature) : rando(0.0, 1.0) {
+  MetropolisAcceptanceCriterion(const core::real temperature,
+      core::calc::statistics::Random &generator = core::calc::statistics::Random::get()) :
+    generator(generator), rando(0.0, 1.0) {
     this->temperature = temperature;
   }
 
@@ -45,7 +48,7 @@ public:
   }
 
 private:
-  core::calc::statistics::Random &generator = core::calc::statistics::Random::get();
+  core::calc::statistics::Random &generator;
   std::uniform_real_distribution<float> rando;
   core::real temperature = 0;
 };
@@ -0,0 +1,257 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <algorithm>
+
+#include <core/data/basic/Vec3.hh>
+#include <utils/string_utils.hh>
+
+#include <simulations/movers/Mover.hh>
+#include <simulations/sampling/NestedSampling.hh>
+
+namespace simulations {
+namespace sampling {
+
+template<typename C>
+NestedSampling<C>::NestedSampling(std::vector<std::shared_ptr<systems::CartesianAtomsSimple<C>>> &systems,
+                                  std::vector<forcefields::CalculateEnergyBase_SP> &energies,
+                                  std::vector<movers::MoversSet_SP> &movers, const core::index4 n_live) :
+  systems_(systems), energies_(energies), movers_(movers), n_live_(n_live),
+  prior_temperature_(std::numeric_limits<core::real>::infinity()), pool(systems.size()), logs("NestedSampling") {
+
+  if (systems_.empty()) throw std::invalid_argument("Nested sampling requires at least one walker\n");
+  if ((energies_.size() != systems_.size()) || (movers_.size() != systems_.size()))
+    throw std::invalid_argument("Nested sampling requires an energy function and movers for every system\n");
+  if (n_live_ <= systems_.size())
+    throw std::invalid_argument(utils::string_format("The number of live points (%d) must be larger than the number of walkers (%d)\n",
+      int(n_live_), int(systems_.size())));
+
+  // --- Separate random stream for every walker; the last one selects points to be copied
+  core::calc::statistics::Random &global = core::calc::statistics::Random::get();
+  for (core::index2 i = 0; i <= systems_.size(); ++i)
+    streams.emplace_back(new core::calc::statistics::Random(global()));
+  for (core::index2 i = 0; i < systems_.size(); ++i) {
+    movers_[i]->random_generator(*streams[i]);
+    criteria.emplace_back(new EnergyCeilingAcceptanceCriterion(std::numeric_limits<core::real>::infinity(), *streams[i]));
+  }
+  valid_.resize(systems_.size());
+  logs << utils::LogLevel::INFO << int(n_live_) << " live points will be replaced by " << int(systems_.size())
+       << " walkers\n";
+}
+
+template<typename C>
+void NestedSampling<C>::prior_temperature(const core::real temperature) {
+
+  prior_temperature_ = temperature;
+  for (auto &c : criteria) c->prior_temperature(temperature);
+}
+
+template<typename C>
+double NestedSampling<C>::walk(const core::index2 walker, const std::vector<C> &start, const core::real ceiling, const core::index4 n_sweeps) {
+
+  systems::CartesianAtomsSimple<C> &system = *systems_[walker];
+  forcefields::CalculateEnergyBase &energy = *energies_[walker];
+  EnergyCeilingAcceptanceCriterion &criterion = *criteria[walker];
+
+  system.restore(start);
+  criterion.ceiling(ceiling);
+  criterion.energy(energy.calculate()); // --- refreshes data cached by energy terms, e.g. the list of hydrogen bonds
+  double last_valid = std::numeric_limits<double>::quiet_NaN();
+  for (core::index4 i = 0; i < n_sweeps; ++i) {
+    for (movers::MoversIterator m_it = movers_[walker]->begin(); m_it != movers_[walker]->end(); ++m_it)
+      (*m_it)->move(criterion);
+    // --- energy tracked by move increments may differ from the exact one when some terms are not pairwise additive,
+    // --- so a sweep that ended above the ceiling is undone
+    const double en = energy.calculate();
+    if (en < ceiling) {
+      last_valid = en;
+      system.snapshot(valid_[walker]);
+      criterion.energy(en);
+    } else {
+      system.restore(std::isnan(last_valid) ? start : valid_[walker]);
+      criterion.energy(energy.calculate());
+    }
+  }
+  return last_valid;
+}
+
+template<typename C>
+void NestedSampling<C>::run(const core::index4 n_dead) {
+
+  const core::index2 n_walkers = systems_.size();
+  const core::real no_ceiling = std::numeric_limits<core::real>::infinity();
+  for (auto &c : criteria) c->reset_counters();
+  samples_.clear();
+  n_failed_ = 0;
+
+  // --- Live points drawn from the prior: every walker samples a chain of points from its current conformation
+  live_.resize(n_live_);
+  live_energies_.resize(n_live_);
+  pool.parallel_for(0, n_walkers, [&](core::index4 w) {
+    std::vector<C> current;
+    systems_[w]->snapshot(current);
+    for (core::index4 i = w; i < n_live_; i += n_walkers) {
+      live_energies_[i] = walk(w, current, no_ceiling, prior_walk_length_);
+      systems_[w]->snapshot(live_[i]);
+      current = live_[i];
+    }
+  });
+  logs << utils::LogLevel::INFO << utils::string_format("live points drawn from the prior, energy from %.3f to %.3f\n",
+    *std::min_element(live_energies_.begin(), live_energies_.end()),
+    *std::max_element(live_energies_.begin(), live_energies_.end()));
+
+  std::vector<core::index4> order(n_live_);
+  std::vector<core::index4> source(n_walkers);
+  std::vector<char> failed(n_walkers);
+  double log_mass = 0.0;
+  core::index4 n_done = 0, next_report = n_live_;
+  while (n_done < n_dead) {
+    const core::index2 k = std::min(core::index4(n_walkers), n_dead - n_done);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + k, order.end(),
+      [this](const core::index4 a, const core::index4 b) { return live_energies_[a] > live_energies_[b]; });
+
+    // --- the j-th of the k dead points dies among n_live - j points, which shrinks the prior mass accordingly
+    for (core::index2 j = 0; j < k; ++j) {
+      const double next_log_mass = log_mass - 1.0 / (n_live_ - j);
+      samples_.push_back(Sample{live_energies_[order[j]], next_log_mass, log_mass + log1p(-exp(next_log_mass - log_mass))});
+      if (callback_) callback_(live_[order[j]], samples_.back());
+      log_mass = next_log_mass;
+    }
+    const core::real ceiling = live_energies_[order[k - 1]];
+
+    // --- every dead point is replaced by a walk that starts from a random survivor
+    std::uniform_int_distribution<core::index4> random_survivor(k, n_live_ - 1);
+    for (core::index2 j = 0; j < k; ++j) source[j] = order[random_survivor(*streams.back())];
+    pool.parallel_for(0, k, [&](core::index4 j) {
+      const double en = walk(j, live_[source[j]], ceiling, walk_length_);
+      failed[j] = std::isnan(en);
+      if (failed[j]) { // --- the dead point is replaced by an unchanged copy of the survivor
+        live_[order[j]] = live_[source[j]];
+        live_energies_[order[j]] = live_energies_[source[j]];
+      } else {
+        systems_[j]->snapshot(live_[order[j]]);
+        live_energies_[order[j]] = en;
+      }
+    });
+    for (core::index2 j = 0; j < k; ++j) n_failed_ += failed[j];
+    n_done += k;
+
+    if ((n_done >= next_report) && (logs.is_logable(utils::LogLevel::INFO))) {
+      logs << utils::LogLevel::INFO << utils::string_format("%d dead points, ceiling %.3f, log prior mass %.3f, acceptance rate %.3f\n",
+        int(n_done), ceiling, log_mass, acceptance_rate());
+      next_report += n_live_;
+    }
+  }
+
+  // --- the remaining live points share the remaining prior mass equally
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+    [this](const core::index4 a, const core::index4 b) { return live_energies_[a] > live_energies_[b]; });
+  const double log_weight = log_mass - log(double(n_live_));
+  for (core::index4 j = 0; j < n_live_; ++j) {
+    log_mass -= 1.0 / (n_live_ - j);
+    samples_.push_back(Sample{live_energies_[order[j]], log_mass, log_weight});
+  }
+  logs << utils::LogLevel::INFO << utils::string_format("%d dead points, %d walks failed, acceptance rate %.3f\n",
+    int(n_done), int(n_failed_), acceptance_rate());
+}
+
+template<typename C>
+core::real NestedSampling<C>::acceptance_rate() const {
+
+  double n_tests = 0, n_accepted = 0;
+  for (const auto &c : criteria) {
+    n_tests += c->count_tests();
+    n_accepted += c->count_accepted();
+  }
+  return (n_tests > 0) ? n_accepted / n_tests : 0.0;
+}
+
+template<typename C>
+std::vector<double> NestedSampling<C>::log_density_of_states() const {
+
+  const double beta_prior = 1.0 / prior_temperature_;
+  std::vector<double> out;
+  for (const Sample &s : samples_) out.push_back(s.log_weight + s.energy * beta_prior);
+  return out;
+}
+
+template<typename C>
+std::vector<double> NestedSampling<C>::boltzmann_log_weights(const core::real temperature) const {
+
+  const double delta_beta = 1.0 / temperature - 1.0 / prior_temperature_;
+  std::vector<double> out;
+  for (const Sample &s : samples_) out.push_back(s.log_weight - s.energy * delta_beta);
+  const double max_w = *std::max_element(out.begin(), out.end());
+  for (double &w : out) w -= max_w;
+  return out;
+}
+
+template<typename C>
+double NestedSampling<C>::log_partition_function(const core::real temperature) const {
+
+  const double delta_beta = 1.0 / temperature - 1.0 / prior_temperature_;
+  double max_w = -std::numeric_limits<double>::infinity();
+  for (const Sample &s : samples_) max_w = std::max(max_w, s.log_weight - s.energy * delta_beta);
+  double sum = 0.0;
+  for (const Sample &s : samples_) sum += exp(s.log_weight - s.energy * delta_beta - max_w);
+  return max_w + log(sum);
+}
+
+template<typename C>
+double NestedSampling<C>::mean_energy(const core::real temperature) const {
+
+  const std::vector<double> w = boltzmann_log_weights(temperature);
+  double sum = 0.0, sum_e = 0.0;
+  for (core::index4 i = 0; i < samples_.size(); ++i) {
+    sum += exp(w[i]);
+    sum_e += exp(w[i]) * samples_[i].energy;
+  }
+  return sum_e / sum;
+}
+
+template<typename C>
+double NestedSampling<C>::heat_capacity(const core::real temperature) const {
+
+  const std::vector<double> w = boltzmann_log_weights(temperature);
+  double sum = 0.0, sum_e = 0.0, sum_e2 = 0.0;
+  for (core::index4 i = 0; i < samples_.size(); ++i) {
+    const double p = exp(w[i]);
+    sum += p;
+    sum_e += p * samples_[i].energy;
+    sum_e2 += p * samples_[i].energy * samples_[i].energy;
+  }
+  sum_e /= sum;
+  sum_e2 /= sum;
+  return (sum_e2 - sum_e * sum_e) / (temperature * temperature);
+}
+
+template<typename C>
+void NestedSampling<C>::write_samples(const std::string &fname) const {
+
+  const std::vector<double> log_dos = log_density_of_states();
+  std::ofstream out(fname);
+  out << "#    n      energy    log_mass  log_weight     log_dos\n";
+  for (core::index4 i = 0; i < samples_.size(); ++i)
+    out << utils::string_format("%6d %11.3f %11.5f %11.5f %11.5f\n", int(i + 1), samples_[i].energy,
+      samples_[i].log_mass, samples_[i].log_weight, log_dos[i]);
+}
+
+template<typename C>
+void NestedSampling<C>::write_thermodynamics(const std::string &fname, const std::vector<core::real> &temperatures) const {
+
+  std::ofstream out(fname);
+  out << "# temperature       log_Z  mean_energy  heat_capacity\n";
+  for (core::real t : temperatures)
+    out << utils::string_format("%13.4f %11.4f %12.4f %14.4f\n", t, log_partition_function(t), mean_energy(t),
+      heat_capacity(t));
+}
+
+template class NestedSampling<core::data::basic::Vec3>;
+
+}
+}
@@ -0,0 +1,161 @@
+/** @file NestedSampling.hh
+ * @brief Provides NestedSampling: estimates the density of states of a system with parallel nested sampling
+ */
+#ifndef SIMULATIONS_SAMPLING_NestedSampling_HH
+#define SIMULATIONS_SAMPLING_NestedSampling_HH
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/calc/statistics/Random.hh>
+
+#include <utils/Logger.hh>
+#include <utils/ThreadPool.hh>
+
+#include <simulations/systems/CartesianAtomsSimple.hh>
+#include <simulations/forcefields/CalculateEnergyBase.hh>
+#include <simulations/movers/MoversSet.hh>
+#include <simulations/sampling/EnergyCeilingAcceptanceCriterion.hh>
+
+namespace simulations {
+namespace sampling {
+
+/** @brief Nested sampling of the energy landscape of a system.
+ *
+ * The protocol keeps a set of live points: conformations sampled from the prior distribution restricted to energies
+ * below a ceiling. At every iteration the highest-energy live points die: each of them gets the prior mass of the
+ * shell between its energy and the energy of the next one, which is estimated from the number of live points;
+ * the energy of the last dead point becomes the new ceiling. Every dead point is replaced by a copy of a randomly
+ * selected surviving point, which then walks away by Monte Carlo moves constrained by the ceiling
+ * (EnergyCeilingAcceptanceCriterion). Each walker has its own copy of the system, energy function and movers,
+ * and replaces one dead point; all the walkers work concurrently on a thread pool, so as many points die
+ * at every iteration as there are walkers.
+ *
+ * The prior is the canonical distribution at the prior temperature (infinite by default): moves below the ceiling
+ * are then tested with the Metropolis criterion at that temperature. The dead points with their prior masses define
+ * the density of states, the partition function and any thermodynamic average at any temperature.
+ *
+ * Every walker has its own random engine (seeded from the <code>Random::get()</code> singleton), so the results are
+ * repeatable for a given seed and number of walkers.
+ */
+template<typename C>
+class NestedSampling {
+public:
+
+  /// A dead point
+  struct Sample {
+    double energy; ///< energy of the point
+    double log_mass; ///< logarithm of the prior mass of energies below this point
+    double log_weight; ///< logarithm of the prior mass the point represents
+  };
+
+  /** @brief Called for every dead point.
+   *
+   * The arguments are coordinates of the point and the sample describing it
+   */
+  typedef std::function<void(const std::vector<C> &, const Sample &)> DeadPointCallback;
+
+  /** @brief Creates the protocol.
+   *
+   * The three vectors define walkers and must be of the same size, which is also the number of threads used
+   * @param systems - copies of the sampled system, one for each walker
+   * @param energies - energy function of every system
+   * @param movers - movers of every system, bound to its energy function
+   * @param n_live - the number of live points; must be larger than the number of walkers
+   */
+  NestedSampling(std::vector<std::shared_ptr<systems::CartesianAtomsSimple<C>>> &systems,
+                 std::vector<forcefields::CalculateEnergyBase_SP> &energies,
+                 std::vector<movers::MoversSet_SP> &movers, const core::index4 n_live);
+
+  /// Sets the temperature of the prior distribution (infinity by default)
+  void prior_temperature(const core::real temperature);
+
+  /// Returns the temperature of the prior distribution
+  core::real prior_temperature() const { return prior_temperature_; }
+
+  /// Sets the number of Monte Carlo sweeps a walker makes to replace a dead point (10 by default)
+  void walk_length(const core::index4 n_sweeps) { walk_length_ = n_sweeps; }
+
+  /// Sets the number of sweeps between two consecutive live points drawn from the prior (100 by default)
+  void prior_walk_length(const core::index4 n_sweeps) { prior_walk_length_ = n_sweeps; }
+
+  /// Sets a function called for every dead point
+  void dead_point_callback(const DeadPointCallback &callback) { callback_ = callback; }
+
+  /** @brief Runs the protocol.
+   *
+   * Live points are drawn from the prior, starting from the current conformations of the systems, then the given
+   * number of points die. At the end the remaining live points are added to the samples, each with an equal share
+   * of the remaining prior mass.
+   * @param n_dead - the number of dead points
+   */
+  void run(const core::index4 n_dead);
+
+  /// Dead points followed by the live points left at the end of a run, from the highest energy to the lowest
+  const std::vector<Sample> &samples() const { return samples_; }
+
+  /// The number of walks that never ended a sweep below the ceiling, so the dead point was replaced by an unchanged copy
+  core::index4 count_failed_walks() const { return n_failed_; }
+
+  /// The fraction of moves accepted by walkers since the beginning of the most recent run
+  core::real acceptance_rate() const;
+
+  /** @brief Logarithm of the density of states for every sample.
+   *
+   * The values are known up to an additive constant: they are logarithms of the prior masses of samples
+   * divided by the prior distribution
+   */
+  std::vector<double> log_density_of_states() const;
+
+  /// Logarithm of the partition function at the given temperature (up to an additive constant)
+  double log_partition_function(const core::real temperature) const;
+
+  /// The average energy at the given temperature
+  double mean_energy(const core::real temperature) const;
+
+  /// Heat capacity at the given temperature
+  double heat_capacity(const core::real temperature) const;
+
+  /// Writes the samples: energy, log prior mass below the point, log weight and log density of states
+  void write_samples(const std::string &fname) const;
+
+  /// Writes the partition function, the average energy and heat capacity at the given temperatures
+  void write_thermodynamics(const std::string &fname, const std::vector<core::real> &temperatures) const;
+
+private:
+  std::vector<std::shared_ptr<systems::CartesianAtomsSimple<C>>> &systems_;
+  std::vector<forcefields::CalculateEnergyBase_SP> &energies_;
+  std::vector<movers::MoversSet_SP> &movers_;
+  core::index4 n_live_;
+  core::real prior_temperature_;
+  core::index4 walk_length_ = 10;
+  core::index4 prior_walk_length_ = 100;
+  std::vector<std::vector<C>> live_;
+  std::vector<double> live_energies_;
+  std::vector<Sample> samples_;
+  core::index4 n_failed_ = 0;
+  DeadPointCallback callback_ = nullptr;
+  std::vector<std::unique_ptr<core::calc::statistics::Random>> streams;
+  std::vector<std::unique_ptr<EnergyCeilingAcceptanceCriterion>> criteria;
+  std::vector<std::vector<C>> valid_; ///< the most recent conformation of every walker found below the ceiling
+  utils::ThreadPool pool;
+  utils::Logger logs;
+
+  /** @brief The walker copies the given point and makes the given number of sweeps below the ceiling.
+   * The system is checked after every sweep; a sweep that ended above the ceiling is undone.
+   * @return energy of the new point or NaN when no sweep ended below the ceiling; the walker is then set back to the start
+   */
+  double walk(const core::index2 walker, const std::vector<C> &start, const core::real ceiling, const core::index4 n_sweeps);
+
+  /// Log-weights of samples at the given temperature, shifted so the largest one is 0
+  std::vector<double> boltzmann_log_weights(const core::real temperature) const;
+};
+
+}
+}
+
+#endif
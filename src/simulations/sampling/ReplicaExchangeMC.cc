@@ -1,4 +1,6 @@
 #include <thread>
+#include <cmath>
+#include <stdexcept>
 
 #include <simulations/sampling/ReplicaExchangeMC.hh>
 #include <simulations/observers/ToStreamObserver.hh>
@@ -9,6 +11,9 @@ namespace sampling {
 
 static const std::string isothermal_enum_name = "ISOTHERMAL";
 static const std::string isotemporal_enum_name = "ISOTEMPORAL";
+static const std::string demux_enum_name = "DEMUX";
+
+const std::string ReplicaExchangeMC::demux_tag = "#REMC";
 
 const std::string & remc_observation_mode_name(const ReplicaExchangeObservationMode mode) {
 
@@ -16,18 +21,21 @@ const std::string & remc_observation_mode_name(const ReplicaExchangeObservationM
 
   if (mode == ReplicaExchangeObservationMode::ISOTEMPORAL) return isotemporal_enum_name;
   if (mode == ReplicaExchangeObservationMode::ISOTHERMAL) return isothermal_enum_name;
+  if (mode == ReplicaExchangeObservationMode::DEMUX) return demux_enum_name;
   return ret;
 }
 
 ReplicaExchangeObservationMode remc_observation_mode(const std::string & mode_name) {
 
-  if(mode_name=="ISOTHERMAL") return ReplicaExchangeObservationMode::ISOTHERMAL;
+  if((mode_name=="ISOTHERMAL")||(mode_name=="0")) return ReplicaExchangeObservationMode::ISOTHERMAL;
+  if(mode_name=="DEMUX") return ReplicaExchangeObservationMode::DEMUX;
   return ReplicaExchangeObservationMode::ISOTEMPORAL;
 }
 
 void ReplicaExchangeMC::run_replica(core::index2 ireplica) {
 
-  replicas[ireplica]->my_sampler->run();
+  // --- after an exchange the sampler sits at another temperature slot, so its temperature must follow
+  replicas[ireplica]->my_sampler->run(temperatures_[ireplica]);
 }
 
 void ReplicaExchangeMC::run() {
@@ -41,18 +49,70 @@ void ReplicaExchangeMC::run() {
 //    }
 
 /* --------- Concurrent variant --------- */
+    if (observation_mode == ReplicaExchangeObservationMode::DEMUX) tag_streams();
     std::vector<std::thread> ths;
     for (core::index2 ireplica = 0; ireplica < replicas.size(); ireplica++) {
       ths.push_back(std::thread(&ReplicaExchangeMC::run_replica,this,ireplica));
     }
     for (auto& th : ths) th.join();
 
-    core::index2 r = random_replica(generator);
+    core::index2 r = random_replica(*generator_);
     try_exchange(r,r+1);
+    if (load_from_reservoir) try_reservoir_exchange();
+    ++n_exchanges_done;
 
     call_exchange_evaluators();
     call_exchange_observers();
   }
+  if (load_from_reservoir)
+    logs << utils::LogLevel::INFO << utils::string_format("%d of %d reservoir exchanges accepted\n",
+      int(n_reservoir_exchanges), int(n_reservoir_attempts));
+}
+
+void ReplicaExchangeMC::reservoir(const std::vector<double> & energies, const core::real temperature,
+                                  ReservoirLoader load) {
+
+  if (energies.empty()) throw std::invalid_argument("Empty reservoir of conformations\n");
+  reservoir_energies = energies;
+  reservoir_temperature = temperature;
+  load_from_reservoir = load;
+  logs << utils::LogLevel::INFO << utils::string_format("reservoir of %d conformations at T = %.3f\n",
+    int(energies.size()), temperature);
+}
+
+bool ReplicaExchangeMC::try_reservoir_exchange() {
+
+  const core::index2 top = replicas.size() - 1;
+  std::uniform_int_distribution<core::index4> random_conformation(0, reservoir_energies.size() - 1);
+  const core::index4 k = random_conformation(*generator_);
+  const double e_top = replicas[top]->energy->calculate();
+  const double delta = (1.0 / temperatures_[top] - 1.0 / reservoir_temperature) * (e_top - reservoir_energies[k]);
+  ++n_reservoir_attempts;
+  if ((delta < 0) && (rando(*generator_) >= exp(delta))) return false;
+
+  load_from_reservoir(replicas[top]->replica_index_, k);
+  replicas[top]->energy->calculate(); // --- refreshes data cached by energy terms
+  ++n_reservoir_exchanges;
+  if (logs.is_logable(utils::LogLevel::FINE))
+    logs << utils::LogLevel::FINE << utils::string_format("Replica %d at T = %.2f (E = %.2f) replaced by reservoir conformation %d (E = %.2f)\n",
+      int(replicas[top]->replica_index_), temperatures_[top], e_top, int(k), reservoir_energies[k]);
+
+  return true;
+}
+
+void ReplicaExchangeMC::tag_streams() {
+
+  for (core::index2 it = 0; it < replicas.size(); ++it) {
+    const std::string tag = utils::string_format("%s exchange %d replica %d temperature_index %d temperature %.3f\n",
+      demux_tag.c_str(), int(n_exchanges_done), int(replicas[it]->replica_index_), int(it), temperatures_[it]);
+    for (const auto &observed : {replicas[it]->my_sampler->observe_every_inner_cycle,
+                                 replicas[it]->my_sampler->observe_every_outer_cycle}) {
+      for (const auto &o : observed) {
+        auto s = std::dynamic_pointer_cast<observers::ToStreamObserver>(o);
+        if ((s != nullptr) && (s->output_stream() != nullptr)) *(s->output_stream()) << tag;
+      }
+    }
+  }
 }
 
 /** \brief Exchange system between two parameters' sets.
@@ -69,7 +129,7 @@ bool ReplicaExchangeMC::try_exchange(const core::index2 l1, core::index2  l2) {
   core::real delta = (1.0 / temperatures_[l1] - 1.0 / temperatures_[l2]);
   core::real deltaE = (r2->energy->calculate() - r1->energy->calculate());
   delta *= deltaE;
-  if((delta<0)||(rando(generator) < exp(-delta))) {
+  if((delta<0)||(rando(*generator_) < exp(-delta))) {
     if(logs.is_logable(utils::LogLevel::FINE))
       logs<<utils::LogLevel::FINE << utils::string_format("Exchanging replicas %d (%.2f %.2f) with %d (%.2f %.2f)\n"
         ,l1,temperatures_[l1],r1->energy->calculate(),l2,temperatures_[l2],r2->energy->calculate());
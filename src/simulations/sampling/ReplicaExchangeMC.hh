@@ -4,6 +4,7 @@
 #include <random>
 #include <vector>
 #include <memory>
+#include <functional>
 #include <core/real.hh>
 #include <core/calc/statistics/Random.hh>
 
@@ -24,7 +25,8 @@ namespace sampling {
 enum ReplicaExchangeObservationMode {
 
   ISOTHERMAL, ///< Ask for isothermal observations - trajectory is not contiguous in this case
-  ISOTEMPORAL ///< Ask for contiguous trajectory which is not isothermal
+  ISOTEMPORAL, ///< Ask for contiguous trajectory which is not isothermal
+  DEMUX ///< Contiguous trajectory tagged with temperature index, to be split into isothermal files after the run
 };
 
 /** @brief convert from ReplicaExchangeObservationMode to its name
@@ -44,6 +46,14 @@ ReplicaExchangeObservationMode remc_observation_mode(const std::string & mode_na
 /** @brief Replica Exchange Monte Carlo sampler.
  *
  * The sampler uses arbitrary number of IsothermalMC samplers as replicas.
+ *
+ * In ReplicaExchangeObservationMode::ISOTHERMAL mode streams of observers are swapped between replicas
+ * on every successful exchange. In ReplicaExchangeObservationMode::DEMUX mode an exchange only swaps indexes;
+ * instead, before every exchange cycle, a tag line is written to every stream observer of every replica:
+ * @code
+ * #REMC exchange 12 replica 3 temperature_index 1 temperature 1.500
+ * @endcode
+ * so the observations can be assigned to temperatures by a post-processing tool (surpass_demux).
  */
 class ReplicaExchangeMC {
 private:
@@ -69,13 +79,31 @@ private:
 
 public:
 
+  /// Every line starting with this tag marks the beginning of an exchange cycle in DEMUX mode
+  static const std::string demux_tag;
+
   const bool isothermal_observations; ///< True if the sampler was created in ReplicaExchangeObservationMode::ISOTHERMAL mode
+  const ReplicaExchangeObservationMode observation_mode; ///< How observations are assigned to temperatures
 
   ReplicaExchangeMC(std::vector<IsothermalMC_SP> & replica_samplers,
     std::vector<forcefields::CalculateEnergyBase_SP> & total_energy, bool isothermal_observations = true) :
-    isothermal_observations(isothermal_observations), n_successful_exchanges(replica_samplers.size()),
+    ReplicaExchangeMC(replica_samplers, total_energy,
+      (isothermal_observations) ? ReplicaExchangeObservationMode::ISOTHERMAL : ReplicaExchangeObservationMode::ISOTEMPORAL) {}
+
+  /** @brief Creates a REMC sampler.
+   *
+   * @param generator - random engine used to exchange replicas and to seed the engines of all replicas;
+   *    must live as long as this sampler is used. Samplers created concurrently must be given separate engines
+   */
+  ReplicaExchangeMC(std::vector<IsothermalMC_SP> & replica_samplers,
+    std::vector<forcefields::CalculateEnergyBase_SP> & total_energy, const ReplicaExchangeObservationMode mode,
+    core::calc::statistics::Random &generator = core::calc::statistics::Random::get()) :
+    isothermal_observations(mode == ReplicaExchangeObservationMode::ISOTHERMAL), observation_mode(mode),
+    n_successful_exchanges(replica_samplers.size()),
     logs("ReplicaExchangeMC"), random_replica(0,replica_samplers.size() - 2) {
 
+    generator_ = &generator;
+
     if (total_energy.size() != replica_samplers.size()) {
       // throw
     }
@@ -84,6 +112,9 @@ public:
       auto r = std::make_shared<ReplicaTask>(i, replica_samplers[i], total_energy[i]);
       replicas.push_back(r);
       temperatures_.push_back(replica_samplers[i]->temperature());
+      // --- replicas run in separate threads, each of them must draw from its own random engine
+      streams.emplace_back(new core::calc::statistics::Random((*generator_)()));
+      replica_samplers[i]->random_generator(*streams.back());
     }
 
   }
@@ -96,6 +127,9 @@ public:
 
   const std::vector<std::shared_ptr<ReplicaTask>> get_replicas() const { return replicas; }
 
+  /// Returns the number of replica exchange attempts made so far
+  core::index4 count_exchanges_done() const { return n_exchanges_done; }
+
   /** @brief Set the number of replica exchange attempts that will be performed by <code>run()</code> call.
    * Each exchange is attempted every \f$ N_I \times N_O \f$ Monte Carlo sweeps  where  \f$ N_I \f$ and  \f$ N_O \f$
    * is the number of inner and outer cycles, respectively.
@@ -103,6 +137,19 @@ public:
    */
   void replica_exchanges(const core::index4 n_exchange) { n_exchanges = n_exchange; }
 
+  /** @brief Sets the random engine used to exchange replicas and re-seeds the engines of all replicas from it.
+   *
+   * By default the <code>Random::get()</code> singleton is used; concurrent REMC simulations must use separate engines.
+   * @param generator - random engine; must live as long as this sampler is used
+   */
+  void random_generator(core::calc::statistics::Random &generator) {
+    generator_ = &generator;
+    for (core::index2 i = 0; i < replicas.size(); ++i) {
+      streams[i].reset(new core::calc::statistics::Random(generator()));
+      replicas[i]->my_sampler->random_generator(*streams[i]);
+    }
+  }
+
   /** Brief Runs the sampling protocol.
    * For each temperature, the method makes  \f$ N_O \f$ = <code>outer_cycles()</code> of
    * \f$ N_I \f$ = <code>inner_cycles()</code> of Monte Carlo steps.
@@ -130,22 +177,59 @@ public:
 
   const std::vector<core::real> & temperatures() const { return temperatures_; }
 
+  /// Copies a reservoir conformation (second argument) into the system of a replica (first argument)
+  typedef std::function<void(const core::index2, const core::index4)> ReservoirLoader;
+
+  /** @brief Turns on reservoir replica exchange.
+   *
+   * After every exchange between neighbouring temperatures, the replica at the highest temperature \f$ T_{top} \f$
+   * attempts an exchange with a conformation drawn at random from a reservoir sampled at temperature \f$ T_{res} \f$.
+   * The conformation is accepted with probability
+   * \f$ \min\left(1, \exp\left[(1/T_{top} - 1/T_{res})(E_{top} - E_{res})\right]\right) \f$;
+   * when both temperatures are equal every attempt succeeds, so the top of the ladder is equilibrated instantly.
+   * The reservoir must hold conformations from the Boltzmann distribution at its temperature,
+   * e.g. recorded at the highest temperature of a previous run.
+   * @param energies - energy of every reservoir conformation
+   * @param temperature - temperature the reservoir has been sampled at
+   * @param load - copies an accepted conformation into the system of the replica at the top temperature
+   */
+  void reservoir(const std::vector<double> & energies, const core::real temperature, ReservoirLoader load);
+
+  /// The number of reservoir exchanges attempted so far
+  core::index4 count_reservoir_attempts() const { return n_reservoir_attempts; }
+
+  /// The number of conformations taken from the reservoir so far
+  core::index4 count_reservoir_exchanges() const { return n_reservoir_exchanges; }
+
 private:
   std::vector<core::real> temperatures_;
   std::vector<std::shared_ptr<ReplicaTask>> replicas;
   std::vector<core::index4> n_successful_exchanges;
   core::index4 n_exchanges;
+  core::index4 n_exchanges_done = 0;
   utils::Logger logs;
-  core::calc::statistics::Random &generator = core::calc::statistics::Random::get();
+  core::calc::statistics::Random *generator_ = &core::calc::statistics::Random::get();
+  std::vector<std::unique_ptr<core::calc::statistics::Random>> streams;
   std::uniform_real_distribution<core::real> rando;
   std::uniform_int_distribution<core::index2> random_replica;
 
   std::vector<evaluators::Evaluator_SP> evaluate_every_exchange;
   std::vector<observers::ObserverInterface_SP> observe_every_exchange;
+  std::vector<double> reservoir_energies;
+  core::real reservoir_temperature = 0;
+  ReservoirLoader load_from_reservoir = nullptr;
+  core::index4 n_reservoir_attempts = 0;
+  core::index4 n_reservoir_exchanges = 0;
 
   void run_replica(core::index2 ireplica);
 
   bool try_exchange(const core::index2 l1, core::index2 l2);
+
+  /// Attempts an exchange between the highest temperature replica and the reservoir
+  bool try_reservoir_exchange();
+
+  /// Writes DEMUX tags to streams of all observers of all replicas
+  void tag_streams();
 };
 
 
@@ -2,8 +2,11 @@
 #define SIMULATIONS_GENERIC_SAMPLING_SamplingProtocolBase_HH
 
 #include <vector>
+#include <memory>
 
 #include <core/index.hh>
+#include <utils/string_utils.hh>
+#include <utils/PerfCounters.hh>
 
 #include <simulations/evaluators/Evaluator.hh>
 #include <simulations/observers/ObserverInterface.hh>
@@ -85,12 +88,34 @@ public:
   void call_inner_cycle_evaluators() { for (const auto &e : evaluate_every_inner_cycle) e->evaluate(); }
 
   /// Call all outer cycle observers
-  void call_outer_cycle_observers() { for (const auto &e : observe_every_outer_cycle) e->observe();  }
+  void call_outer_cycle_observers() {
+    if (profiler) call_profiled(observe_every_outer_cycle, outer_sections, "outer");
+    else for (const auto &e : observe_every_outer_cycle) e->observe();
+  }
 
   /// Call all inner cycle observers
-  void call_inner_cycle_observers() { for (const auto &e : observe_every_inner_cycle) e->observe(); }
+  void call_inner_cycle_observers() {
+    if (profiler) call_profiled(observe_every_inner_cycle, inner_sections, "inner");
+    else for (const auto &e : observe_every_inner_cycle) e->observe();
+  }
+
+  /** @brief Measures time and hardware events spent by observers of this protocol.
+   *
+   * Observers are identified by their position in the list, e.g. <code>observer:outer:0</code> is the first
+   * outer cycle observer. Derived protocols also measure their movers.
+   * @param counters - counters used for the measurements; <code>nullptr</code> turns the measurements off
+   */
+  virtual void profile(std::shared_ptr<utils::PerfCounters> counters) {
+    profiler = counters;
+    outer_sections.clear();
+    inner_sections.clear();
+  }
+
+  /// Virtual destructor
+  virtual ~SamplingProtocolBase() {}
 
 protected:
+  std::shared_ptr<utils::PerfCounters> profiler = nullptr; ///< when set, observers (and movers) are measured
   core::index4 n_outer_cycles;
   core::index4 n_inner_cycles;
   core::index4 n_cycle_size;
@@ -99,6 +124,20 @@ protected:
   std::vector<observers::ObserverInterface_SP> observe_every_inner_cycle;
   std::vector<observers::ObserverInterface_SP> observe_every_outer_cycle;
 private:
+  std::vector<core::index2> outer_sections;
+  std::vector<core::index2> inner_sections;
+
+  void call_profiled(const std::vector<observers::ObserverInterface_SP> &observers, std::vector<core::index2> &sections,
+                     const std::string &kind) {
+    while (sections.size() < observers.size())
+      sections.push_back(profiler->section(utils::string_format("observer:%s:%d", kind.c_str(), int(sections.size()))));
+    for (core::index2 i = 0; i < observers.size(); ++i) {
+      profiler->start(sections[i]);
+      observers[i]->observe();
+      profiler->stop(sections[i]);
+    }
+  }
+
   friend class ReplicaExchangeMC; // This is necessary so REMC can exchange also observers (thus observations are isothermal)
 };
 
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <simulations/movers/Mover.hh>
 #include <simulations/sampling/SimulatedAnnealing.hh>
 #include <simulations/sampling/MetropolisAcceptanceCriterion.hh>
@@ -5,12 +7,18 @@
 namespace simulations {
 namespace sampling {
 
-void SimulatedAnnealing::run() {
+void SimulatedAnnealing::run() { run(0, temperatures.size()); }
+
+void SimulatedAnnealing::run(const core::index2 first_temperature, const core::index2 last_temperature) {
 
-  for (core::index2 itemp = 0; itemp < temperatures.size(); itemp++) {
+  const core::index2 last = std::min(last_temperature, core::index2(temperatures.size()));
+  const core::index4 n_outer = n_outer_cycles;
+  for (core::index2 itemp = first_temperature; itemp < last; itemp++) {
     logger << utils::LogLevel::INFO << "Temperature set to " << temperatures[itemp] << "\n";
+    if (!dwell.empty()) n_outer_cycles = dwell[itemp];
     IsothermalMC::run(temperatures[itemp]);
   }
+  n_outer_cycles = n_outer;
 }
 
 }
@@ -1,6 +1,8 @@
 #ifndef SIMULATIONS_GENERIC_SAMPLING_SimulatedAnnealing_HH
 #define SIMULATIONS_GENERIC_SAMPLING_SimulatedAnnealing_HH
 
+#include <stdexcept>
+
 #include <core/real.hh>
 
 #include <utils/Logger.hh>
@@ -26,6 +28,21 @@ public:
   SimulatedAnnealing(movers::MoversSet_SP ms, const std::vector<core::real> &temperatures)
     : IsothermalMC(ms), logger("SimulatedAnnealing"), temperatures(temperatures) { }
 
+  /** @brief Creates a protocol that spends a different number of outer cycles at every temperature.
+   *
+   * This allows one to replay a schedule found by AdaptiveAnnealing.
+   * @param ms - set of movers used for sampling
+   * @param temperatures - the annealing schedule
+   * @param outer_cycles - the number of outer cycles for every temperature; overrides <code>outer_cycles()</code>
+   */
+  SimulatedAnnealing(movers::MoversSet_SP ms, const std::vector<core::real> &temperatures,
+                     const std::vector<core::index4> &outer_cycles)
+    : IsothermalMC(ms), logger("SimulatedAnnealing"), temperatures(temperatures), dwell(outer_cycles) {
+
+    if (dwell.size() != temperatures.size())
+      throw std::invalid_argument("The number of outer cycles must be given for every temperature\n");
+  }
+
   /// Virtual destructor
   ~SimulatedAnnealing() {}
 
@@ -36,12 +53,26 @@ public:
    */
   void run();
 
+  /** @brief Runs only a part of the annealing schedule.
+   *
+   * Temperatures with indexes from <code>first_temperature</code> up to <code>last_temperature - 1</code> are simulated.
+   * Calling this method for consecutive ranges is equivalent to a single <code>run()</code> call, which allows
+   * a caller to inspect the system between the stages of a protocol.
+   * @param first_temperature - index of the first temperature to be simulated
+   * @param last_temperature - index of the first temperature that will <strong>not</strong> be simulated
+   */
+  void run(const core::index2 first_temperature, const core::index2 last_temperature);
+
+  /// Returns the number of temperatures of the annealing schedule
+  core::index2 count_temperatures() const { return temperatures.size(); }
+
   /// Returns current simulation temperature
   core::real temperature() const { return temperature_; }
 
 private:
   utils::Logger logger;
   const std::vector<core::real> temperatures;
+  const std::vector<core::index4> dwell; ///< outer cycles for every temperature; empty when all temperatures are equal
 };
 
 } // ~ sampling
@@ -0,0 +1,298 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <algorithm>
+
+#include <core/calc/structural/angles.hh>
+#include <core/calc/structural/transformations/Crmsd.hh>
+#include <core/data/structural/Chain.hh>
+#include <core/data/structural/Residue.hh>
+#include <core/data/structural/PdbAtom.hh>
+#include <core/data/structural/structure_selectors.hh>
+#include <utils/string_utils.hh>
+
+#include <simulations/forcefields/surpass/surpass_force_field_factory.hh>
+#include <simulations/sampling/SurpassChainGrowth.hh>
+
+namespace simulations {
+namespace sampling {
+
+using core::data::basic::Vec3;
+
+/// Energy above which a trial position is considered a clash
+static const double clash_energy = 1.0e10;
+
+SurpassChainGrowth::SurpassChainGrowth(core::data::structural::Structure_SP surpass_structure,
+                                       core::data::sequence::SecondaryStructure_SP ss2_aa,
+                                       const std::string &scoring_config, const core::index2 n_threads) :
+  structure_(surpass_structure), ss2_aa_(ss2_aa), scoring_config_(scoring_config), pool(n_threads),
+  logs("SurpassChainGrowth") {
+
+  n_atoms_ = std::distance(structure_->first_const_atom(), structure_->last_const_atom());
+  if (n_atoms_ < 2) throw std::invalid_argument("Chain growth requires a chain of at least two beads\n");
+
+  // --- Every thread gets its own copy of the system and its own energy function
+  for (core::index2 i = 0; i < pool.size(); ++i) {
+    workers_.emplace_back(new Worker());
+    create_worker(*workers_.back());
+    idle_workers_.push_back(workers_.back().get());
+  }
+  logs << utils::LogLevel::INFO << "chains of " << int(n_atoms_) << " beads will be grown on " << pool.size()
+       << " threads\n";
+}
+
+void SurpassChainGrowth::growth_terms(const std::vector<std::string> &term_names) {
+
+  growth_terms_ = term_names;
+  for (auto &w : workers_) create_worker(*w);
+}
+
+void SurpassChainGrowth::create_worker(Worker &w) const {
+
+  using namespace simulations::forcefields;
+
+  if (w.system == nullptr) {
+    if (workers_.empty() || (workers_[0]->system == nullptr))
+      w.system = std::make_shared<systems::surpass::SurpassModel<Vec3>>(*structure_);
+    else w.system = std::make_shared<systems::surpass::SurpassModel<Vec3>>(*workers_[0]->system);
+    w.energy = surpass::create_surpass_energy<Vec3>(*w.system, ss2_aa_, scoring_config_);
+  }
+  for (auto &t : w.distance_terms) t.clear();
+  w.angle_terms.clear();
+  w.long_range_terms.clear();
+
+  const std::vector<core::real> &factors = w.energy->get_factors();
+  for (core::index2 i = 0; i < w.energy->count_components(); ++i) {
+    ByResidueEnergy *term = w.energy->get_component(i).get();
+    const std::string &name = term->name();
+    mf::ShortRangeMFBase<Vec3> *local = dynamic_cast<mf::ShortRangeMFBase<Vec3> *>(term);
+    if ((local != nullptr) && (name.size() == 10) && (name.compare(0, 8, "SurpassR") == 0) && (name[8] == '1')
+        && (name[9] >= '2') && (name[9] <= '5'))
+      w.distance_terms[name[9] - '2'].emplace_back(local, factors[i]);
+    else if ((local != nullptr) && (name == "SurpassA13")) w.angle_terms.emplace_back(local, factors[i]);
+    else if (std::find(growth_terms_.begin(), growth_terms_.end(), name) != growth_terms_.end())
+      w.long_range_terms.emplace_back(term, factors[i]);
+  }
+}
+
+void SurpassChainGrowth::park(Worker &w, const core::index4 n) {
+
+  w.system->coordinates[n].set(0.0, 0.0, 1.0e5 + 10.0 * n);
+}
+
+double SurpassChainGrowth::growth_energy(Worker &w, const core::index4 n) const {
+
+  const std::unique_ptr<Vec3[]> &xyz = w.system->coordinates;
+  double en = 0.0;
+  for (core::index4 k = 1; k <= 4; ++k) {
+    if (n < k) break;
+    if (w.distance_terms[k - 1].empty()) continue;
+    const core::real d = xyz[n].distance_to(xyz[n - k]);
+    for (const auto &t : w.distance_terms[k - 1]) en += t.second * t.first->score_property(n - k, d);
+  }
+  if ((n >= 2) && (!w.angle_terms.empty())) {
+    const core::real a = core::calc::structural::evaluate_planar_angle(xyz[n], xyz[n - 1], xyz[n - 2]);
+    for (const auto &t : w.angle_terms) en += t.second * t.first->score_property(n - 2, a);
+  }
+  for (const auto &t : w.long_range_terms) {
+    const double e = t.first->calculate_by_residue(n);
+    if (e >= clash_energy) return std::numeric_limits<double>::max();
+    en += t.second * e;
+  }
+  return en;
+}
+
+core::index4 SurpassChainGrowth::tour(Worker &w, core::calc::statistics::Random &generator,
+                                      std::vector<GrownChain> &completed) const {
+
+  static const double log_enrich = log(3.0);
+  static const double log_prune = -log(3.0);
+  const core::index4 max_stack = 4 * n_atoms_;
+
+  std::uniform_real_distribution<core::real> rand_unit(0.0, 1.0);
+  std::uniform_real_distribution<core::real> rand_bond(min_bond_, max_bond_);
+  std::normal_distribution<core::real> rand_normal(0.0, 1.0);
+
+  // --- running sums of weights of chains of every length, used to decide on pruning and enrichment
+  std::vector<double> log_weight_sum(n_atoms_ + 1, -std::numeric_limits<double>::infinity());
+  std::vector<core::index4> n_weights(n_atoms_ + 1, 0);
+
+  std::vector<Vec3> trials(n_trials_);
+  std::vector<double> energies(n_trials_);
+  std::vector<double> boltzmann(n_trials_);
+  core::index4 n_dead = 0, n_done = 0, n_started = 0;
+
+  std::vector<PartialChain> stack;
+  while (n_done < max_chains_per_tour_) {
+    if (stack.empty()) { // --- a new chain starts from the first bead; weights of the previous ones remain as the reference
+      if (n_started == max_chains_per_tour_) break;
+      ++n_started;
+      stack.push_back(PartialChain{1, 0.0, std::vector<Vec3>{Vec3(0.0, 0.0, 0.0)}});
+    }
+    PartialChain c = std::move(stack.back());
+    stack.pop_back();
+    for (core::index4 i = 0; i < c.length; ++i) w.system->coordinates[i].set(c.coordinates[i]);
+    for (core::index4 i = c.length; i < n_atoms_; ++i) park(w, i);
+
+    while (true) {
+      const core::index4 n = c.length;
+      if (n == n_atoms_) { // --- the chain is complete
+        completed.push_back(GrownChain{w.energy->calculate(), c.log_weight, std::move(c.coordinates)});
+        ++n_done;
+        break;
+      }
+
+      // --- trial positions for bead n
+      double e_min = std::numeric_limits<double>::max();
+      const Vec3 &prev = w.system->coordinates[n - 1];
+      for (core::index2 j = 0; j < n_trials_; ++j) {
+        Vec3 v(rand_normal(generator), rand_normal(generator), rand_normal(generator));
+        v.norm(rand_bond(generator));
+        v += prev;
+        trials[j].set(v);
+        w.system->coordinates[n].set(v);
+        energies[j] = growth_energy(w, n);
+        e_min = std::min(e_min, energies[j]);
+      }
+      if (e_min >= clash_energy) { // --- every trial clashes: the chain can't grow any longer
+        ++n_dead;
+        break;
+      }
+      double sum = 0.0;
+      for (core::index2 j = 0; j < n_trials_; ++j) {
+        boltzmann[j] = (energies[j] >= clash_energy) ? 0.0 : exp(-(energies[j] - e_min) / temperature_);
+        sum += boltzmann[j];
+      }
+      c.log_weight += log(sum / n_trials_) - e_min / temperature_;
+
+      // --- select a trial position with probability proportional to its Boltzmann factor
+      double r = rand_unit(generator) * sum;
+      core::index2 selected = 0;
+      while ((selected < n_trials_ - 1) && (r >= boltzmann[selected])) r -= boltzmann[selected++];
+
+      // --- compare the weight with the average weight of chains of that length
+      double &log_sum = log_weight_sum[n + 1];
+      log_sum = (log_sum > c.log_weight) ? log_sum + log1p(exp(c.log_weight - log_sum))
+                                          : c.log_weight + log1p(exp(log_sum - c.log_weight));
+      ++n_weights[n + 1];
+      const double log_ratio = c.log_weight - (log_sum - log(double(n_weights[n + 1])));
+
+      if ((log_ratio > log_enrich) && (stack.size() < max_stack) && (sum > boltzmann[selected])) {
+        // --- enrichment: a copy of the chain continues from another trial position; the weight is split between them
+        double r2 = rand_unit(generator) * (sum - boltzmann[selected]);
+        core::index2 other = (selected == 0) ? 1 : 0;
+        for (core::index2 j = other; j < n_trials_; ++j) {
+          if (j == selected) continue;
+          other = j;
+          if (r2 < boltzmann[j]) break;
+          r2 -= boltzmann[j];
+        }
+        c.log_weight -= log(2.0);
+        stack.push_back(PartialChain{n + 1, c.log_weight, c.coordinates});
+        stack.back().coordinates.push_back(trials[other]);
+      } else if (log_ratio < log_prune) {
+        // --- pruning: the chain survives with probability 1/2 and its weight is doubled
+        if (rand_unit(generator) < 0.5) break;
+        c.log_weight += log(2.0);
+      }
+      w.system->coordinates[n].set(trials[selected]);
+      c.coordinates.push_back(trials[selected]);
+      ++c.length;
+    }
+  }
+
+  return n_dead;
+}
+
+const std::vector<SurpassChainGrowth::GrownChain> &SurpassChainGrowth::run(const core::index4 n_tours,
+                                                                           const core::index4 n_best) {
+
+  // --- Separate random stream for every tour; seeds come from the global engine so the results are repeatable
+  core::calc::statistics::Random &global = core::calc::statistics::Random::get();
+  std::vector<core::calc::statistics::Random::result_type> seeds(n_tours);
+  for (auto &s : seeds) s = global();
+
+  std::vector<std::vector<GrownChain>> per_tour(n_tours);
+  std::vector<core::index4> dead_ends(n_tours, 0);
+  pool.parallel_for(0, n_tours, [&](core::index4 t) {
+    Worker *w;
+    {
+      std::lock_guard<std::mutex> lock(workers_mutex_);
+      w = idle_workers_.back();
+      idle_workers_.pop_back();
+    }
+    core::calc::statistics::Random generator(seeds[t]);
+    dead_ends[t] = tour(*w, generator, per_tour[t]);
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    idle_workers_.push_back(w);
+  });
+
+  std::vector<GrownChain> all;
+  n_completed_ = 0;
+  n_dead_ends_ = 0;
+  for (core::index4 t = 0; t < n_tours; ++t) {
+    n_dead_ends_ += dead_ends[t];
+    n_completed_ += per_tour[t].size();
+    for (GrownChain &c : per_tour[t]) all.push_back(std::move(c));
+  }
+  std::stable_sort(all.begin(), all.end(), [](const GrownChain &a, const GrownChain &b) { return a.energy < b.energy; });
+
+  // --- the lowest-energy chains, no two of them closer than the crmsd cutoff
+  core::calc::structural::transformations::Crmsd<std::vector<Vec3>, std::vector<Vec3>> rms;
+  best_.clear();
+  for (GrownChain &c : all) {
+    if (best_.size() >= n_best) break;
+    bool unique = true;
+    for (const GrownChain &b : best_)
+      if (rms.crmsd(c.coordinates, b.coordinates, n_atoms_) < crmsd_cutoff_) {
+        unique = false;
+        break;
+      }
+    if (unique) best_.push_back(std::move(c));
+  }
+
+  logs << utils::LogLevel::INFO << utils::string_format("%d tours completed %d chains, %d dead ends; %d unique chains kept",
+    int(n_tours), int(n_completed_), int(n_dead_ends_), int(best_.size()));
+  if (!best_.empty())
+    logs << utils::string_format(", energy from %.3f to %.3f", best_.front().energy, best_.back().energy);
+  logs << "\n";
+
+  return best_;
+}
+
+std::vector<core::data::structural::Structure_SP> SurpassChainGrowth::structures() const {
+
+  std::vector<core::data::structural::Structure_SP> out;
+  for (const GrownChain &c : best_) {
+    core::data::structural::Structure_SP s = structure_->clone(core::data::structural::SelectEverything());
+    core::index4 i = 0;
+    for (auto atom_it = s->first_atom(); atom_it != s->last_atom(); ++atom_it) (*atom_it)->set(c.coordinates[i++]);
+    out.push_back(s);
+  }
+  return out;
+}
+
+void SurpassChainGrowth::write_pdb(const std::string &fname) const {
+
+  std::ofstream out(fname);
+  core::index4 model_id = 0;
+  for (const GrownChain &c : best_) {
+    out << utils::string_format("MODEL    %7d\n", ++model_id);
+    out << utils::string_format("REMARK   1 ENERGY %12.3f\n", c.energy);
+    core::index4 i = 0;
+    for (auto atom_it = structure_->first_const_atom(); atom_it != structure_->last_const_atom(); ++atom_it, ++i) {
+      const core::data::structural::PdbAtom &a = **atom_it;
+      const core::data::structural::Residue &r = *(a.owner());
+      out << utils::string_format("ATOM  %5d %s %s %c%4d    %8.3f%8.3f%8.3f  1.00 99.99\n", a.id(),
+        a.atom_name().c_str(), r.residue_type().code3.c_str(), r.owner()->id(), r.id(), c.coordinates[i].x,
+        c.coordinates[i].y, c.coordinates[i].z);
+    }
+    out << "ENDMDL\n";
+  }
+}
+
+}
+}
@@ -0,0 +1,175 @@
+/** @file SurpassChainGrowth.hh
+ * @brief Provides SurpassChainGrowth: a chain-growth (PERM) sampler that generates low-energy SURPASS models
+ */
+#ifndef SIMULATIONS_SAMPLING_SurpassChainGrowth_HH
+#define SIMULATIONS_SAMPLING_SurpassChainGrowth_HH
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/data/basic/Vec3.hh>
+#include <core/data/sequence/SecondaryStructure.hh>
+#include <core/data/structural/Structure.hh>
+#include <core/calc/statistics/Random.hh>
+
+#include <utils/Logger.hh>
+#include <utils/ThreadPool.hh>
+
+#include <simulations/systems/surpass/SurpassModel.hh>
+#include <simulations/forcefields/TotalEnergyByResidue.hh>
+#include <simulations/forcefields/mf/ShortRangeMFBase.hh>
+
+namespace simulations {
+namespace sampling {
+
+/** @brief Grows SURPASS chains bead by bead with the pruned-enriched Rosenbluth method (PERM).
+ *
+ * A chain is grown from its N-terminal bead. For every new bead <code>count_trials()</code> positions are drawn
+ * around the previous bead, at a distance from <code>bond_range()</code>. Every trial position is scored by the
+ * local terms that involve the new bead and the beads already placed (SurpassR12 - SurpassR15 and SurpassA13, those
+ * present in the force field) and by the long-range terms selected with <code>growth_terms()</code>, evaluated
+ * for the new bead only; beads not placed yet are parked far away from the chain, so they do not interact.
+ * One trial is selected with a probability given by its Boltzmann factor at the growth temperature and the Rosenbluth
+ * weight of the chain is multiplied by the sum of these factors. A partial chain whose weight is much higher than
+ * the average weight of chains of the same length is copied (enrichment), one with a much lower weight is discarded
+ * with probability 1/2 (pruning). All the descendants of a single chain make a tour; tours are independent and
+ * run concurrently on a thread pool, each with its own random engine, so the results are repeatable for a given seed
+ * regardless of the number of threads.
+ *
+ * Completed chains are scored with the full force field; the lowest-energy ones, at least <code>crmsd_cutoff()</code>
+ * apart from each other, are kept. They are meant as a diverse set of starting models for Monte Carlo simulations.
+ */
+class SurpassChainGrowth {
+public:
+
+  /// A completed chain
+  struct GrownChain {
+    double energy; ///< total energy of the chain, as given by the full force field
+    double log_weight; ///< logarithm of the Rosenbluth weight of the chain
+    std::vector<core::data::basic::Vec3> coordinates; ///< positions of beads
+  };
+
+  /** @brief Creates a sampler.
+   *
+   * @param surpass_structure - a structure in the SURPASS representation that defines the chain to be grown;
+   *    its coordinates are not used
+   * @param ss2_aa - secondary structure of the full-atom chain, used to create the force field
+   * @param scoring_config - force field configuration
+   * @param n_threads - the number of threads; 0 means all hardware threads
+   */
+  SurpassChainGrowth(core::data::structural::Structure_SP surpass_structure,
+                     core::data::sequence::SecondaryStructure_SP ss2_aa, const std::string &scoring_config,
+                     const core::index2 n_threads = 0);
+
+  /// Sets the temperature used to compute Boltzmann factors of trial positions (1.0 by default)
+  void temperature(const core::real t) { temperature_ = t; }
+
+  /// Returns the temperature used to compute Boltzmann factors of trial positions
+  core::real temperature() const { return temperature_; }
+
+  /// Sets the number of trial positions drawn for every bead (16 by default)
+  void count_trials(const core::index2 n) { n_trials_ = n; }
+
+  /// Returns the number of trial positions drawn for every bead
+  core::index2 count_trials() const { return n_trials_; }
+
+  /// Sets the range of distances between consecutive beads of trial positions ([1.2, 3.8] by default)
+  void bond_range(const core::real min_distance, const core::real max_distance) {
+    min_bond_ = min_distance;
+    max_bond_ = max_distance;
+  }
+
+  /// Sets the maximum number of chains completed in a single tour (100 by default)
+  void max_chains_per_tour(const core::index4 n) { max_chains_per_tour_ = n; }
+
+  /// Sets the minimum crmsd between two chains returned by <code>run()</code> (3.0 by default)
+  void crmsd_cutoff(const core::real cutoff) { crmsd_cutoff_ = cutoff; }
+
+  /** @brief Selects long-range energy terms evaluated during the growth.
+   *
+   * The terms must be pairwise ones, like SurpassContactEnergy or SurpassLocalRepulsionEnergy (the default):
+   * a term that depends on the whole chain (e.g. SurpassCentrosymetricEnergy) would see the parked beads.
+   * @param term_names - names of energy terms, as returned by their <code>name()</code> methods
+   */
+  void growth_terms(const std::vector<std::string> &term_names);
+
+  /** @brief Runs the given number of tours.
+   *
+   * @param n_tours - the number of tours
+   * @param n_best - the maximum number of chains returned
+   * @return unique completed chains sorted by their energy
+   */
+  const std::vector<GrownChain> &run(const core::index4 n_tours, const core::index4 n_best);
+
+  /// Chains returned by the most recent <code>run()</code> call
+  const std::vector<GrownChain> &chains() const { return best_; }
+
+  /// The chains returned by the most recent <code>run()</code> call as copies of the SURPASS structure given to the constructor
+  std::vector<core::data::structural::Structure_SP> structures() const;
+
+  /// Writes the chains returned by the most recent <code>run()</code> call as PDB models
+  void write_pdb(const std::string &fname) const;
+
+  /// The number of chains completed by the most recent <code>run()</code> call
+  core::index4 count_completed() const { return n_completed_; }
+
+  /// The number of partial chains abandoned because every trial position clashed with the chain
+  core::index4 count_dead_ends() const { return n_dead_ends_; }
+
+private:
+  /// Everything a single thread needs to grow chains
+  struct Worker {
+    std::shared_ptr<systems::surpass::SurpassModel<core::data::basic::Vec3>> system;
+    std::shared_ptr<forcefields::TotalEnergyByResidue> energy;
+    std::vector<std::pair<forcefields::mf::ShortRangeMFBase<core::data::basic::Vec3> *, core::real>> distance_terms[4]; ///< R12 - R15 with their weights
+    std::vector<std::pair<forcefields::mf::ShortRangeMFBase<core::data::basic::Vec3> *, core::real>> angle_terms; ///< A13 with its weight
+    std::vector<std::pair<forcefields::ByResidueEnergy *, core::real>> long_range_terms;
+  };
+
+  /// A partial chain waiting on the stack of a tour
+  struct PartialChain {
+    core::index4 length;
+    double log_weight;
+    std::vector<core::data::basic::Vec3> coordinates;
+  };
+
+  core::data::structural::Structure_SP structure_;
+  core::data::sequence::SecondaryStructure_SP ss2_aa_;
+  std::string scoring_config_;
+  core::index4 n_atoms_;
+  core::real temperature_ = 1.0;
+  core::index2 n_trials_ = 16;
+  core::real min_bond_ = 1.2;
+  core::real max_bond_ = 3.8;
+  core::index4 max_chains_per_tour_ = 100;
+  core::real crmsd_cutoff_ = 3.0;
+  std::vector<std::string> growth_terms_{"SurpassContactEnergy", "SurpassLocalRepulsionEnergy"};
+  core::index4 n_completed_ = 0;
+  core::index4 n_dead_ends_ = 0;
+  std::vector<GrownChain> best_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<Worker *> idle_workers_;
+  std::mutex workers_mutex_;
+  utils::ThreadPool pool;
+  utils::Logger logs;
+
+  void create_worker(Worker &w) const;
+
+  /// Places bead <code>n</code> far away from the chain and from other parked beads
+  static void park(Worker &w, const core::index4 n);
+
+  /// Energy of bead <code>n</code> with respect to beads <code>0 .. n-1</code>
+  double growth_energy(Worker &w, const core::index4 n) const;
+
+  /// Runs a single tour; returns the number of dead ends
+  core::index4 tour(Worker &w, core::calc::statistics::Random &generator, std::vector<GrownChain> &completed) const;
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,122 @@
+#include <cmath>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include <utils/string_utils.hh>
+
+#include <simulations/observers/ObserverInterface.hh>
+#include <simulations/sampling/UmbrellaSampling.hh>
+
+namespace simulations {
+namespace sampling {
+
+/// Records the CV value of a replica into the histogram of the window the replica currently belongs to
+class UmbrellaSampling::WindowRecorder : public observers::ObserverInterface {
+public:
+  WindowRecorder(UmbrellaSampling &owner, const core::index2 replica) : owner(owner), replica(replica) {}
+
+  virtual bool observe() {
+    owner.samples_[owner.window_for_replica_[replica]].push_back(owner.biases[replica]->cv()->evaluate());
+    return true;
+  }
+
+  virtual void finalize() {}
+
+private:
+  UmbrellaSampling &owner;
+  const core::index2 replica;
+};
+
+UmbrellaSampling::UmbrellaSampling(std::vector<IsothermalMC_SP> &window_samplers,
+                                   std::vector<forcefields::CVBiasEnergy_SP> &window_biases,
+                                   const core::index2 n_threads) :
+  samplers(window_samplers), biases(window_biases), samples_(window_samplers.size()),
+  n_attempts(window_samplers.size(), 0), n_successes(window_samplers.size(), 0),
+  pool((n_threads == 0) ? 0 : std::min(n_threads, core::index2(window_samplers.size()))), logs("UmbrellaSampling") {
+
+  if (samplers.size() != biases.size())
+    throw std::invalid_argument(utils::string_format("%d window samplers given for %d bias terms\n",
+                                                     int(samplers.size()), int(biases.size())));
+
+  for (core::index2 i = 0; i < samplers.size(); ++i) {
+    window_for_replica_.push_back(i);
+    replica_for_window_.push_back(i);
+    samplers[i]->inner_cycle_observer(std::make_shared<WindowRecorder>(*this, i));
+    streams.emplace_back(new core::calc::statistics::Random(generator()));
+    samplers[i]->random_generator(*streams.back());
+  }
+  logs << utils::LogLevel::INFO << samplers.size() << " umbrella windows will be run on " << pool.size()
+       << " threads\n";
+}
+
+void UmbrellaSampling::run(const core::index4 n_rounds) {
+
+  for (core::index4 iround = 0; iround < n_rounds; ++iround) {
+    std::vector<std::future<void>> jobs;
+    for (auto &s : samplers) jobs.push_back(pool.submit([s]() { s->run(); }));
+    for (auto &j : jobs) j.get();
+
+    if (exchanges_) {
+      // --- alternate even and odd pairs, so every pair of neighbors is tried every other round
+      for (core::index4 w = n_rounds_done % 2; w + 1 < samplers.size(); w += 2) try_exchange(w, w + 1);
+    }
+    ++n_rounds_done;
+  }
+
+  if (exchanges_)
+    for (core::index4 w = 0; w + 1 < samplers.size(); ++w)
+      logs << utils::LogLevel::INFO << utils::string_format("exchange rate %d <-> %d : %.3f\n", w, w + 1,
+                                                               (n_attempts[w] > 0) ? n_successes[w] /
+                                                                                     double(n_attempts[w]) : 0.0);
+}
+
+bool UmbrellaSampling::try_exchange(const core::index2 w1, const core::index2 w2) {
+
+  const core::index2 r1 = replica_for_window_[w1];
+  const core::index2 r2 = replica_for_window_[w2];
+  const double x1 = biases[r1]->cv()->evaluate();
+  const double x2 = biases[r2]->cv()->evaluate();
+  const double beta = 1.0 / samplers[r1]->temperature();
+  const double delta = beta * (biases[r1]->bias(x2) + biases[r2]->bias(x1) - biases[r1]->bias(x1) -
+                               biases[r2]->bias(x2));
+  ++n_attempts[w1];
+  if ((delta > 0) && (rando(generator) >= exp(-delta))) return false;
+
+  biases[r1]->swap_parameters(*biases[r2]);
+  std::swap(replica_for_window_[w1], replica_for_window_[w2]);
+  window_for_replica_[r1] = w2;
+  window_for_replica_[r2] = w1;
+  ++n_successes[w1];
+  if (logs.is_logable(utils::LogLevel::FINE))
+    logs << utils::LogLevel::FINE << utils::string_format("windows %d and %d exchanged replicas %d and %d\n",
+                                                         w1, w2, r1, r2);
+
+  return true;
+}
+
+core::calc::statistics::Wham UmbrellaSampling::wham(const core::index2 n_bins) {
+
+  core::real x_min = std::numeric_limits<core::real>::max();
+  core::real x_max = -std::numeric_limits<core::real>::max();
+  for (const auto &s : samples_)
+    for (core::real x : s) {
+      x_min = std::min(x_min, x);
+      x_max = std::max(x_max, x);
+    }
+  // --- make the last value fall into the last bin
+  x_max += (x_max - x_min) * 1.0e-4 + 1.0e-6;
+
+  core::calc::statistics::Wham w(x_min, x_max, n_bins, samplers[0]->temperature());
+  for (core::index2 iw = 0; iw < samples_.size(); ++iw) {
+    forcefields::CVBiasEnergy_SP b = biases[replica_for_window_[iw]];
+    w.add_window(samples_[iw], [b](double x) { return b->bias(x); });
+  }
+  w.solve(&pool);
+
+  return w;
+}
+
+} // ~ sampling
+} // ~ simulations
@@ -0,0 +1,102 @@
+/** @file UmbrellaSampling.hh
+ * @brief Provides UmbrellaSampling protocol: concurrent biased windows with optional window exchanges
+ */
+#ifndef SIMULATIONS_SAMPLING_UmbrellaSampling_HH
+#define SIMULATIONS_SAMPLING_UmbrellaSampling_HH
+
+#include <random>
+#include <vector>
+#include <memory>
+
+#include <core/real.hh>
+#include <core/index.hh>
+#include <core/calc/statistics/Random.hh>
+#include <core/calc/statistics/Wham.hh>
+
+#include <utils/Logger.hh>
+#include <utils/ThreadPool.hh>
+
+#include <simulations/forcefields/CVBiasEnergy.hh>
+#include <simulations/sampling/IsothermalMC.hh>
+
+namespace simulations {
+namespace sampling {
+
+/** @brief Umbrella sampling along a collective variable.
+ *
+ * Every window is sampled by its own IsothermalMC instance (a replica), whose total energy includes a CVBiasEnergy term.
+ * Windows are run concurrently on a thread pool; after each round neighboring windows may attempt to exchange their
+ * replicas (Hamiltonian replica exchange). An exchange is a pure index swap: the two systems stay where they are,
+ * their bias terms swap umbrella parameters. Values of the CV are recorded after every inner MC cycle, separately
+ * for each window. Finally the recorded histograms are combined by WHAM.
+ *
+ * All replicas must be simulated at the same temperature, so an exchange depends only on the bias energies.
+ * Every window sampler draws from its own random engine, seeded from the <code>Random::get()</code> singleton,
+ * so the results are repeatable for a given seed regardless of the number of threads.
+ */
+class UmbrellaSampling {
+public:
+
+  /** @brief Creates umbrella sampling protocol.
+   *
+   * @param window_samplers - a sampler for every window; the i-th sampler must use the i-th bias term in its energy function
+   * @param window_biases - bias for every window
+   * @param n_threads - the number of threads used to run the windows; 0 means all hardware threads
+   */
+  UmbrellaSampling(std::vector<IsothermalMC_SP> &window_samplers,
+                   std::vector<forcefields::CVBiasEnergy_SP> &window_biases, const core::index2 n_threads = 0);
+
+  /// Returns the number of umbrella windows
+  core::index2 count_windows() const { return samplers.size(); }
+
+  /** @brief Enables or disables exchanges between neighboring windows.
+   *
+   * Windows should be sorted by the umbrella center for exchanges to be efficient.
+   */
+  void window_exchanges(const bool flag) { exchanges_ = flag; }
+
+  /** @brief Runs the protocol.
+   *
+   * @param n_rounds - how many times each window sampler is run; exchanges (if enabled) are attempted after every round
+   */
+  void run(const core::index4 n_rounds);
+
+  /// Values of the CV recorded in a given window
+  const std::vector<core::real> &samples(const core::index2 which_window) const { return samples_[which_window]; }
+
+  /// Returns the index of a replica currently sampling a given window
+  core::index2 replica_for_window(const core::index2 which_window) const { return replica_for_window_[which_window]; }
+
+  /** @brief Combines the recorded samples by WHAM.
+   *
+   * The histogram range is from the smallest to the largest recorded value.
+   * @param n_bins - the number of histogram bins
+   * @return solved WHAM object
+   */
+  core::calc::statistics::Wham wham(const core::index2 n_bins);
+
+private:
+  class WindowRecorder;
+
+  std::vector<IsothermalMC_SP> samplers;
+  std::vector<forcefields::CVBiasEnergy_SP> biases;
+  std::vector<std::vector<core::real>> samples_; ///< CV values for every window
+  std::vector<core::index2> window_for_replica_;
+  std::vector<core::index2> replica_for_window_;
+  std::vector<core::index4> n_attempts;
+  std::vector<core::index4> n_successes;
+  bool exchanges_ = true;
+  core::index4 n_rounds_done = 0;
+  utils::ThreadPool pool;
+  utils::Logger logs;
+  core::calc::statistics::Random &generator = core::calc::statistics::Random::get();
+  std::vector<std::unique_ptr<core::calc::statistics::Random>> streams; ///< a separate random engine for every window sampler
+  std::uniform_real_distribution<core::real> rando;
+
+  bool try_exchange(const core::index2 w1, const core::index2 w2);
+};
+
+} // ~ sampling
+} // ~ simulations
+
+#endif
@@ -5,6 +5,9 @@
 #include <fstream>
 #include <memory>
 #include <random>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
 
 #include <core/real.hh>
 #include <core/calc/statistics/Random.hh>
@@ -56,16 +59,42 @@ public:
    * @param source - a system to be duplicated
    */
   CartesianAtomsSimple(const CartesianAtomsSimple& source) :
-    atom_typing(source.atom_typing), n_atoms(source.n_atoms), coordinates(new C[n_atoms]) {
-
-    for (core::index4 i = 0; i < n_atoms; ++i) {
-      coordinates[i].set(source.coordinates[i]);
-      coordinates[i].chain_id = source.coordinates[i].chain_id;
-      coordinates[i].atom_type = source.coordinates[i].atom_type;
-      coordinates[i].residue_type = source.coordinates[i].residue_type;
-      coordinates[i].residue_index = source.coordinates[i].residue_index;
-      coordinates[i].register_ = source.coordinates[i].register_;
-    }
+    atom_typing(source.atom_typing), n_atoms(source.n_atoms), coordinates(new C[n_atoms]) { copy_state(source); }
+
+  /** @brief Copies the state (i.e. all the atoms) of another system of the same size into this system.
+   *
+   * Atoms are plain data, so the whole copy is a single memory block transfer.
+   * @param source - a system whose atoms are copied
+   */
+  void copy_state(const CartesianAtomsSimple<C> & source) {
+
+    if (source.n_atoms != n_atoms)
+      throw std::invalid_argument(utils::string_format("Can't copy a system of %d atoms into a system of %d atoms\n",
+        int(source.n_atoms), int(n_atoms)));
+    std::copy(source.coordinates.get(), source.coordinates.get() + n_atoms, coordinates.get());
+  }
+
+  /** @brief Stores the state of this system, which can be brought back later by <code>restore()</code>
+   *
+   * A snapshot buffer may be reused many times; it is resized only when necessary.
+   * @param destination - where the atoms are copied
+   */
+  void snapshot(std::vector<C> & destination) const {
+    destination.assign(coordinates.get(), coordinates.get() + n_atoms);
+  }
+
+  /** @brief Brings back the state of this system stored by <code>snapshot()</code>
+   *
+   * Note, that data cached by energy terms (e.g. a list of hydrogen bonds) is not restored;
+   * calling <code>calculate()</code> on the total energy refreshes it.
+   * @param source - a snapshot of this system (or of a copy of it)
+   */
+  void restore(const std::vector<C> & source) {
+
+    if (source.size() != n_atoms)
+      throw std::invalid_argument(utils::string_format("Can't restore a system of %d atoms from a snapshot of %d atoms\n",
+        int(n_atoms), int(source.size())));
+    std::copy(source.begin(), source.end(), coordinates.get());
   }
 
   /// Necessary virtual destructor
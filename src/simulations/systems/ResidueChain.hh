@@ -91,6 +91,13 @@ public:
   ResidueChain(const AtomTypingInterface_SP typing, const std::vector<core::index2> & n_atoms_in_chains,
                const std::string atom_name = " CA ");
 
+  /** @brief Copying constructor.
+   *
+   * Coordinates are copied while PDB atom names are shared with the source system
+   * @param source - a system to be duplicated
+   */
+  ResidueChain(const ResidueChain<C> & source);
+
   /// Necessary virtual destructor
   virtual ~ResidueChain() {}
 
@@ -170,13 +177,13 @@ public:
    * @param atom_index - which atom?
    * @return PDB-style name of the atom; always four characters, e.g. " CA "
    */
-  const std::string & pdb_atom_name(const core::index4 atom_index) const { return pdb_atom_names_[atom_index]; }
+  const std::string & pdb_atom_name(const core::index4 atom_index) const { return (*pdb_atom_names_)[atom_index]; }
 
   /** @brief Exposes the vector of all PDB-style atom names.
    *
    * @return a const-reference to the vector of atom names
    */
-  const std::vector<std::string> & pdb_atom_names() const { return pdb_atom_names_; }
+  const std::vector<std::string> & pdb_atom_names() const { return *pdb_atom_names_; }
 
   /** @brief Returns the type of the residue the given atom belongs to.
    *
@@ -275,7 +282,7 @@ public:
 protected:
   std::vector<AtomRange<C>> atoms_for_residue_;
   std::vector<AtomRange<C>> atoms_for_chain_;
-  std::vector<std::string> pdb_atom_names_;
+  std::shared_ptr<std::vector<std::string>> pdb_atom_names_; ///< shared by copies of this system
 private:
   core::index2 system_id_;
   utils::Logger logger;
@@ -283,15 +290,25 @@ private:
 
 template<class C>
 ResidueChain<C>::ResidueChain(const AtomTypingInterface_SP typing, const core::index4 n_atoms,
-    const std::string atom_name) : CartesianAtomsSimple<C>(typing, n_atoms), system_id_(0), logger("ResidueChain")  {
+    const std::string atom_name) : CartesianAtomsSimple<C>(typing, n_atoms),
+    pdb_atom_names_(std::make_shared<std::vector<std::string>>()), system_id_(0), logger("ResidueChain")  {
 
   for (residue_index i = 0; i < CartesianAtomsSimple<C>::n_atoms; i++) {
     atoms_for_residue_.emplace_back(*this, i, i);
-    pdb_atom_names_.push_back(atom_name);
+    pdb_atom_names_->push_back(atom_name);
   }
   atoms_for_chain_.emplace_back(*this, 0, CartesianAtomsSimple<C>::n_atoms - 1);
 }
 
+template<class C>
+ResidueChain<C>::ResidueChain(const ResidueChain<C> & source) : CartesianAtomsSimple<C>(source),
+    pdb_atom_names_(source.pdb_atom_names_), system_id_(source.system_id_), logger("ResidueChain") {
+
+  // --- ranges refer to the system they were created for, so they can't be shared
+  for (const AtomRange<C> & r : source.atoms_for_residue_) atoms_for_residue_.emplace_back(*this, r.first_atom, r.last_atom);
+  for (const AtomRange<C> & r : source.atoms_for_chain_) atoms_for_chain_.emplace_back(*this, r.first_atom, r.last_atom);
+}
+
 template<class C>
 ResidueChain<C>::ResidueChain(const AtomTypingInterface_SP typing, const core::data::structural::Structure & s) :
     ResidueChain<C>(typing, s.count_atoms()) {
@@ -302,7 +319,7 @@ ResidueChain<C>::ResidueChain(const AtomTypingInterface_SP typing, const core::d
   core::index2 i_resid = 0;
   atoms_for_chain_.clear();
   atoms_for_residue_.clear();
-  pdb_atom_names_.clear();
+  pdb_atom_names_->clear();
 
   for(const auto & cp : s) {
     logger << utils::LogLevel::FINE << "processing chain " << (*cp).id() << "\n";
@@ -311,7 +328,7 @@ ResidueChain<C>::ResidueChain(const AtomTypingInterface_SP typing, const core::d
         C & a = CartesianAtomsSimple<C>::coordinates[i_atom];
         a.set(*ap);
         a.chain_id = cp->id();
-        pdb_atom_names_.push_back(ap->atom_name());
+        pdb_atom_names_->push_back(ap->atom_name());
         try {
           a.atom_type = typing->atom_type(*ap);
         } catch (std::out_of_range &e) {
@@ -8,6 +8,7 @@
 
 #include <simulations/representations/surpass_utils.hh>
 #include <simulations/systems/surpass/SurpassAtomTyping.hh>
+#include <simulations/systems/surpass/SurpassTopology.hh>
 #include <simulations/systems/ResidueChain.hh>
 
 #include <utils/Logger.hh>
@@ -30,9 +31,21 @@ public:
    */
   SurpassModel(core::data::structural::Structure &s);
 
+  /** @brief Creates a copy of a system.
+   *
+   * Coordinates are copied while the topology (secondary structure elements, atom typing and PDB atom names) is shared
+   * with the source system. Therefore a copy is cheap to make, e.g. for a new replica or a cloned walker.
+   * @param source - a system to be duplicated
+   */
+  SurpassModel(const SurpassModel<C> &source) : ResidueChain<C>(source), logger("SurpassModel"),
+                                                topology_(source.topology_) {}
+
   /// Necessary virtual destructor
   virtual ~SurpassModel() {}
 
+  /// Returns the immutable topology of this system, shared with all its copies
+  const SurpassTopology_SP topology() const { return topology_; }
+
   /** @brief Returns secondary structure element assignment for each surpass atom.
    *
    * The returned vector provides, for each surpass atom, the index of secondary structure element it belongs to,
@@ -41,28 +54,28 @@ public:
    * since 0 denotes a loop (which is not a surpass secondary structure element) and all 'true' SS elements are indexed from 1
    *  (size() = N_resids = n_atoms)
    */
-  const std::vector<core::index2> &ss_element_for_atoms() const { return ss_element_for_atoms_; }
+  const std::vector<core::index2> &ss_element_for_atoms() const { return topology_->ss_element_for_atoms; }
 
   /** @brief Returns beta strand index given atom from beta (size() = N_beta)
    * The returned index refers to <code>elements_beta_</code> vector, e.g. for 2GB1:
    *
    * 000001111122223333
    */
-  const std::vector<core::index2> &beta_index_for_atoms() const { return beta_index_for_atoms_; }
+  const std::vector<core::index2> &beta_index_for_atoms() const { return topology_->beta_index_for_atoms; }
 
   /** @brief Returns a list of all atoms of type S i.e. surpass beads that are beta-strands
    *
    * for example for 2GB1 this vector has size 18 since there are 18 residues in beta strands in that protein (size() = N_beta)
    * [0,1,2,3,4,12,13,14,15,16,40,41,42,43,49,50,51,52]
    */
-  const std::vector<core::index2> &atoms_in_beta() const { return atoms_in_beta_; }
+  const std::vector<core::index2> &atoms_in_beta() const { return topology_->atoms_in_beta; }
 
   /** @brief Returns a list of all atoms of type H i.e. surpass beads that are helical
    *
    * for example for 2GB1 this vector has size 14 since there are 14 residues in a helix in that protein  (size() = N_alpha)
    * [20,21,22,23,24,25,26,27,28,29,30,31,32,33]
    */
-  const std::vector<core::index2> &atoms_in_alfa() const { return atoms_in_alfa_; }
+  const std::vector<core::index2> &atoms_in_alfa() const { return topology_->atoms_in_alfa; }
 
   /** @brief List of these SS element indexes which are beta
    *
@@ -70,7 +83,7 @@ public:
    *
    * @return list of beta SSE indexes
    */
-  const std::vector<core::index2> &elements_beta() const { return elements_beta_; }
+  const std::vector<core::index2> &elements_beta() const { return topology_->elements_beta; }
 
   /** @brief List of these SS element indexes which are alpha
    *
@@ -78,26 +91,17 @@ public:
    *
    * @return list of alpha SSE indexes
    */
-  const std::vector<core::index2> &elements_alfa() const { return elements_alfa_; }
+  const std::vector<core::index2> &elements_alfa() const { return topology_->elements_alfa; }
 
   /** @brief Provide index of the first and last index for each helix (packed into a single vector)
    *
    * @return
    */
-  const std::vector<core::index2> &alfa_ranges() const { return alfa_ranges_; }
+  const std::vector<core::index2> &alfa_ranges() const { return topology_->alfa_ranges; }
 
 private:
   utils::Logger logger;
-
-  std::vector<core::index2> ss_element_for_atoms_;
-  std::vector<core::index2> beta_index_for_atoms_;
-  std::vector<core::index2> atoms_in_beta_;
-  std::vector<core::index2> atoms_in_alfa_;
-  std::vector<core::index2> elements_beta_;
-  std::vector<core::index2> elements_alfa_;
-  std::vector<core::index2> alfa_ranges_;
-
-  void assign_ss_elements(void);
+  SurpassTopology_SP topology_;
 };
 
 template<class C>
@@ -106,68 +110,9 @@ SurpassModel<C>::SurpassModel(core::data::structural::Structure &s) :
     (representations::is_surpass_model(s)) ? representations::fix_surpass_ss_assignment(s)
                                            : *representations::surpass_representation(s)), logger("SurpassModel") {
 
-  assign_ss_elements();
-}
-
-template<typename C>
-void SurpassModel<C>::assign_ss_elements(void) {
-
-  core::index2 last_h = 0, index_E = 0, index_H = 0;
-  ss_element_for_atoms_.resize(ResidueChain<C>::n_atoms);
-  if (ResidueChain<C>::coordinates[0].atom_type != 2) {
-    ++last_h;
-    ss_element_for_atoms_[0] = last_h;
-    if (ResidueChain<C>::coordinates[0].atom_type == 1) {
-      atoms_in_beta_.push_back(0);
-      elements_beta_.push_back(last_h);
-      beta_index_for_atoms_.push_back(index_E);
-    } else {
-      atoms_in_alfa_.push_back(0);
-      alfa_ranges_.push_back(0);//
-      elements_alfa_.push_back(last_h);
-      beta_index_for_atoms_.push_back(index_H);
-    }
-  } else {
-    ss_element_for_atoms_[0] = last_h;
-    beta_index_for_atoms_.push_back(ResidueChain<C>::n_atoms);
-  }
-  for (atom_index i = 1; i < ResidueChain<C>::n_atoms; ++i) {
-    if (ResidueChain<C>::coordinates[i].atom_type == 2) {
-      ss_element_for_atoms_[i] = 0;
-      beta_index_for_atoms_.push_back(ResidueChain<C>::n_atoms);
-    } else {
-      if (ResidueChain<C>::coordinates[i - 1].atom_type != ResidueChain<C>::coordinates[i].atom_type)
-        ++last_h;
-      ss_element_for_atoms_[i] = last_h;
-      if (ResidueChain<C>::coordinates[i].atom_type == 1) {
-        atoms_in_beta_.push_back(i);
-        if (elements_beta_.size() == 0) {
-          elements_beta_.push_back(last_h);
-          beta_index_for_atoms_.push_back(index_E);
-        } else if (elements_beta_.back() != last_h) {
-          elements_beta_.push_back(last_h);
-          ++index_E;
-          beta_index_for_atoms_.push_back(index_E);
-        } else beta_index_for_atoms_.push_back(index_E);
-      } else {
-        atoms_in_alfa_.push_back(i);
-        if ((ResidueChain<C>::coordinates[i + 1].atom_type != ResidueChain<C>::coordinates[i].atom_type) ||
-            (i == ResidueChain<C>::n_atoms - 1))
-          alfa_ranges_.push_back(i);//
-        if (elements_alfa_.size() == 0) {
-          alfa_ranges_.push_back(i);//
-          elements_alfa_.push_back(last_h);
-          beta_index_for_atoms_.push_back(index_H);
-        } else if (elements_alfa_.back() != last_h) {
-          elements_alfa_.push_back(last_h);
-          alfa_ranges_.push_back(i);//
-          ++index_H;
-          beta_index_for_atoms_.push_back(index_H);
-        } else beta_index_for_atoms_.push_back(index_H);
-      }
-      continue;
-    }
-  }
+  std::vector<core::index2> atom_types(ResidueChain<C>::n_atoms);
+  for (atom_index i = 0; i < ResidueChain<C>::n_atoms; ++i) atom_types[i] = ResidueChain<C>::coordinates[i].atom_type;
+  topology_ = std::make_shared<const SurpassTopology>(atom_types);
 }
 
 }
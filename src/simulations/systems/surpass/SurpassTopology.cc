@@ -0,0 +1,67 @@
+#include <simulations/systems/surpass/SurpassTopology.hh>
+
+namespace simulations {
+namespace systems {
+namespace surpass {
+
+SurpassTopology::SurpassTopology(const std::vector<core::index2> &atom_types) {
+
+  const core::index4 n_atoms = atom_types.size();
+  core::index2 last_h = 0, index_E = 0, index_H = 0;
+  ss_element_for_atoms.resize(n_atoms);
+  if (atom_types[0] != 2) {
+    ++last_h;
+    ss_element_for_atoms[0] = last_h;
+    if (atom_types[0] == 1) {
+      atoms_in_beta.push_back(0);
+      elements_beta.push_back(last_h);
+      beta_index_for_atoms.push_back(index_E);
+    } else {
+      atoms_in_alfa.push_back(0);
+      alfa_ranges.push_back(0);//
+      elements_alfa.push_back(last_h);
+      beta_index_for_atoms.push_back(index_H);
+    }
+  } else {
+    ss_element_for_atoms[0] = last_h;
+    beta_index_for_atoms.push_back(n_atoms);
+  }
+  for (core::index4 i = 1; i < n_atoms; ++i) {
+    if (atom_types[i] == 2) {
+      ss_element_for_atoms[i] = 0;
+      beta_index_for_atoms.push_back(n_atoms);
+    } else {
+      if (atom_types[i - 1] != atom_types[i]) ++last_h;
+      ss_element_for_atoms[i] = last_h;
+      if (atom_types[i] == 1) {
+        atoms_in_beta.push_back(i);
+        if (elements_beta.size() == 0) {
+          elements_beta.push_back(last_h);
+          beta_index_for_atoms.push_back(index_E);
+        } else if (elements_beta.back() != last_h) {
+          elements_beta.push_back(last_h);
+          ++index_E;
+          beta_index_for_atoms.push_back(index_E);
+        } else beta_index_for_atoms.push_back(index_E);
+      } else {
+        atoms_in_alfa.push_back(i);
+        if ((i == n_atoms - 1) || (atom_types[i + 1] != atom_types[i]))
+          alfa_ranges.push_back(i);//
+        if (elements_alfa.size() == 0) {
+          alfa_ranges.push_back(i);//
+          elements_alfa.push_back(last_h);
+          beta_index_for_atoms.push_back(index_H);
+        } else if (elements_alfa.back() != last_h) {
+          elements_alfa.push_back(last_h);
+          alfa_ranges.push_back(i);//
+          ++index_H;
+          beta_index_for_atoms.push_back(index_H);
+        } else beta_index_for_atoms.push_back(index_H);
+      }
+    }
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,43 @@
+#ifndef SIMULATIONS_CARTESIAN_SurpassTopology_HH
+#define SIMULATIONS_CARTESIAN_SurpassTopology_HH
+
+#include <vector>
+#include <memory>
+
+#include <core/index.hh>
+
+namespace simulations {
+namespace systems {
+namespace surpass {
+
+/** @brief Secondary structure elements of a SURPASS system.
+ *
+ * This data depends only on the secondary structure type of every bead, therefore it never changes during a simulation.
+ * A single SurpassTopology object is shared by a SurpassModel and all its copies (e.g. replicas or cloned walkers),
+ * see SurpassModel for the meaning of every vector.
+ */
+class SurpassTopology {
+public:
+
+  /** @brief Assigns secondary structure elements to beads of a SURPASS chain
+   * @param atom_types - SURPASS atom type of every bead: 0 for helix, 1 for strand and 2 for loop
+   */
+  SurpassTopology(const std::vector<core::index2> &atom_types);
+
+  std::vector<core::index2> ss_element_for_atoms;
+  std::vector<core::index2> beta_index_for_atoms;
+  std::vector<core::index2> atoms_in_beta;
+  std::vector<core::index2> atoms_in_alfa;
+  std::vector<core::index2> elements_beta;
+  std::vector<core::index2> elements_alfa;
+  std::vector<core::index2> alfa_ranges;
+};
+
+/// Immutable topology shared by SURPASS systems
+typedef std::shared_ptr<const SurpassTopology> SurpassTopology_SP;
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,131 @@
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include <utils/Logger.hh>
+#include <utils/string_utils.hh>
+#include <utils/PerfCounters.hh>
+
+namespace utils {
+
+static utils::Logger logs("PerfCounters");
+
+static const char *event_names[] = {"cycles", "instructions", "LLC_misses", "branch_misses"};
+
+PerfCounters::PerfCounters() {
+  for (core::index1 e = 0; e < n_events; ++e) {
+    fd[e] = -1;
+    is_counted[e] = false;
+  }
+}
+
+PerfCounters::~PerfCounters() { close(); }
+
+core::index2 PerfCounters::section(const std::string &name) {
+
+  for (core::index2 i = 0; i < names.size(); ++i)
+    if (names[i] == name) return i;
+  names.push_back(name);
+  started.emplace_back();
+  calls.push_back(0);
+  seconds.push_back(0.0);
+  totals.resize(totals.size() + n_events, 0);
+  return names.size() - 1;
+}
+
+void PerfCounters::stop(const core::index2 which_section) {
+
+  read(now);
+  const Reading &s = started[which_section];
+  ++calls[which_section];
+  seconds[which_section] += std::chrono::duration<double>(now.time - s.time).count();
+  std::uint64_t *t = &totals[which_section * n_events];
+  for (core::index1 e = 0; e < n_events; ++e) t[e] += now.events[e] - s.events[e];
+}
+
+void PerfCounters::open() {
+
+  close();
+  owner = std::this_thread::get_id();
+#ifdef __linux__
+  static const std::uint64_t configs[] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                          PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+  for (core::index1 e = 0; e < n_events; ++e) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = configs[e];
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // --- pid = 0, cpu = -1 : the calling thread on any CPU
+    fd[e] = syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+    is_counted[e] = (fd[e] >= 0);
+    if ((group_fd < 0) && is_counted[e]) group_fd = fd[e];
+  }
+#endif
+  static std::once_flag is_reported;
+  std::call_once(is_reported, [this]() {
+    if (group_fd < 0)
+      logs << utils::LogLevel::WARNING << "hardware performance counters not available; only time will be measured\n";
+    else {
+      logs << utils::LogLevel::INFO << "hardware performance counters:";
+      for (core::index1 e = 0; e < n_events; ++e) logs << ' ' << event_names[e] << (is_counted[e] ? "" : "(n/a)");
+      logs << "\n";
+    }
+  });
+}
+
+void PerfCounters::close() {
+
+#ifdef __linux__
+  for (core::index1 e = 0; e < n_events; ++e)
+    if (fd[e] >= 0) ::close(fd[e]);
+#endif
+  for (core::index1 e = 0; e < n_events; ++e) fd[e] = -1;
+  group_fd = -1;
+}
+
+void PerfCounters::read(Reading &r) const {
+
+  r.time = std::chrono::steady_clock::now();
+  for (core::index1 e = 0; e < n_events; ++e) r.events[e] = 0;
+#ifdef __linux__
+  if (group_fd < 0) return;
+  // --- PERF_FORMAT_GROUP layout: the number of events followed by their values, in the order they were opened
+  std::uint64_t buffer[n_events + 1];
+  if (::read(group_fd, buffer, sizeof(buffer)) <= 0) return;
+  core::index1 k = 1;
+  for (core::index1 e = 0; e < n_events; ++e)
+    if (is_counted[e]) r.events[e] = buffer[k++];
+#endif
+}
+
+void PerfCounters::write(std::ostream &out) const {
+
+  core::index2 w = 8;
+  for (const std::string &n : names) w = std::max(w, core::index2(n.size()));
+  out << utils::string_format("#%*s %10s %10s %15s %15s %6s %12s %13s\n", w - 1, "section", "calls", "time[s]",
+                              event_names[0], event_names[1], "IPC", event_names[2], event_names[3]);
+  for (core::index2 i = 0; i < names.size(); ++i) {
+    const std::uint64_t *t = &totals[i * n_events];
+    out << utils::string_format("%*s %10d %10.4f", w, names[i].c_str(), int(calls[i]), seconds[i]);
+    for (core::index1 e = 0; e < 2; ++e)
+      out << ((is_counted[e]) ? utils::string_format(" %15llu", (unsigned long long) t[e]) : utils::string_format(" %15s", "n/a"));
+    out << ((is_counted[0] && is_counted[1] && (t[0] > 0)) ? utils::string_format(" %6.3f", double(t[1]) / t[0])
+                                                              : utils::string_format(" %6s", "n/a"));
+    out << ((is_counted[2]) ? utils::string_format(" %12llu", (unsigned long long) t[2]) : utils::string_format(" %12s", "n/a"));
+    out << ((is_counted[3]) ? utils::string_format(" %13llu", (unsigned long long) t[3]) : utils::string_format(" %13s", "n/a"));
+    out << "\n";
+  }
+}
+
+} // ~ utils
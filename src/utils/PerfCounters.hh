@@ -0,0 +1,105 @@
+/** \file PerfCounters.hh
+ * @brief Provides PerfCounters: time and hardware performance counters accumulated for named code sections
+ */
+#ifndef UTILS_PerfCounters_HH
+#define UTILS_PerfCounters_HH
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cstdint>
+#include <ostream>
+
+#include <core/index.hh>
+
+namespace utils {
+
+/** @brief Measures time and hardware events spent in named sections of code.
+ *
+ * Four hardware events are counted: CPU cycles, instructions, last level cache misses and branch mispredictions.
+ * They are read from a Linux <code>perf_event_open()</code> counter group; when such counters are not available
+ * (a non-Linux system, a virtual machine without a PMU, <code>perf_event_paranoid</code> too restrictive)
+ * only wall time is measured and the hardware columns are reported as <code>n/a</code>.
+ *
+ * Counters measure the thread that uses them. Since samplers may be run by a different thread at every
+ * replica exchange, the counter group is re-opened whenever <code>start()</code> is called from a new thread.
+ * Therefore a single PerfCounters object must not be used by two threads at the same time; create one object
+ * per replica. Sections may be nested (e.g. an energy term inside a mover); the values are inclusive.
+ *
+ * Every measurement costs a system call, so the numbers are meant for comparing terms with each other
+ * rather than for absolute timing:
+ * @code
+ * utils::PerfCounters perf;
+ * core::index2 s = perf.section("SurpassContactEnergy");
+ * perf.start(s);
+ * en->calculate_by_residue(i);
+ * perf.stop(s);
+ * perf.write(std::cout);
+ * @endcode
+ */
+class PerfCounters {
+public:
+
+  static const core::index1 n_events = 4; ///< cycles, instructions, LLC misses, branch misses
+
+  /// Creates counters; the hardware counter group is opened at the first <code>start()</code> call
+  PerfCounters();
+
+  /// Closes the counter group
+  ~PerfCounters();
+
+  /** @brief Registers a new section or finds an existing one by its name
+   * @param name - name of the section, reported by <code>write()</code>
+   * @return section index, to be used by <code>start()</code> and <code>stop()</code>
+   */
+  core::index2 section(const std::string &name);
+
+  /// Returns the number of registered sections
+  core::index2 count_sections() const { return names.size(); }
+
+  /// Starts measuring a given section
+  inline void start(const core::index2 which_section) {
+    if (std::this_thread::get_id() != owner) open();
+    read(started[which_section]);
+  }
+
+  /// Stops measuring a given section and adds the measured values to its totals
+  void stop(const core::index2 which_section);
+
+  /// Returns true if hardware counters were successfully opened
+  bool hardware_available() const { return group_fd >= 0; }
+
+  /** @brief Writes a table with the totals of all the sections
+   *
+   * The columns are: section name, number of calls, time [s], cycles, instructions, instructions per cycle,
+   * LLC misses and branch misses.
+   */
+  void write(std::ostream &out) const;
+
+private:
+  struct Reading {
+    std::chrono::steady_clock::time_point time;
+    std::uint64_t events[n_events];
+  };
+
+  std::thread::id owner;
+  int group_fd = -1;
+  int fd[n_events];
+  bool is_counted[n_events]; ///< true for the events that have been successfully opened
+  std::vector<std::string> names;
+  std::vector<Reading> started;
+  std::vector<core::index4> calls;
+  std::vector<double> seconds;
+  std::vector<std::uint64_t> totals; ///< n_events values per section
+  Reading now;
+
+  void open();
+  void close();
+  void read(Reading &r) const;
+};
+
+} // ~ utils
+
+#endif
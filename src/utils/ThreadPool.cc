@@ -0,0 +1,54 @@
+#include <algorithm>
+
+#include <utils/ThreadPool.hh>
+
+namespace utils {
+
+ThreadPool::ThreadPool(const core::index2 n_threads) : stop_(false) {
+
+  core::index2 n = n_threads;
+  if (n == 0) n = std::max(1u, std::thread::hardware_concurrency());
+  for (core::index2 i = 0; i < n; ++i) workers.push_back(std::thread(&ThreadPool::worker_loop, this));
+}
+
+ThreadPool::~ThreadPool() {
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stop_ = true;
+  }
+  condition.notify_all();
+  for (auto &w : workers) w.join();
+}
+
+void ThreadPool::worker_loop() {
+
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      condition.wait(lock, [this] { return stop_ || !tasks.empty(); });
+      if (stop_ && tasks.empty()) return;
+      task = std::move(tasks.front());
+      tasks.pop();
+    }
+    task();
+  }
+}
+
+void ThreadPool::parallel_for(const core::index4 first, const core::index4 last,
+                              const std::function<void(core::index4)> &f) {
+
+  if (last <= first) return;
+  const core::index4 n = last - first;
+  const core::index4 n_blocks = std::min(n, core::index4(workers.size()));
+  const core::index4 block = (n + n_blocks - 1) / n_blocks;
+  std::vector<std::future<void>> jobs;
+  for (core::index4 from = first; from < last; from += block) {
+    const core::index4 to = std::min(last, from + block);
+    jobs.push_back(submit([from, to, &f]() { for (core::index4 i = from; i < to; ++i) f(i); }));
+  }
+  for (auto &j : jobs) j.get();
+}
+
+} // ~ utils
@@ -0,0 +1,85 @@
+/** \file ThreadPool.hh
+ * @brief Provides a simple fixed-size pool of worker threads
+ */
+#ifndef UTILS_ThreadPool_HH
+#define UTILS_ThreadPool_HH
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <memory>
+
+#include <core/index.hh>
+
+namespace utils {
+
+/** @brief A fixed number of worker threads that execute submitted tasks.
+ *
+ * The threads are started by the constructor and joined by the destructor, so the pool may be reused
+ * for many batches of tasks (e.g. one batch per replica exchange) without the cost of thread creation.
+ * The example below runs a sampler for every window and waits until all of them are done:
+ * @code
+ * utils::ThreadPool pool(4);
+ * std::vector<std::future<void>> jobs;
+ * for (auto & sampler : samplers) jobs.push_back(pool.submit([sampler]() { sampler->run(); }));
+ * for (auto & j : jobs) j.get();
+ * @endcode
+ */
+class ThreadPool {
+public:
+
+  /** @brief Starts worker threads.
+   * @param n_threads - the number of worker threads; when 0, the number of hardware threads is used
+   */
+  ThreadPool(const core::index2 n_threads = 0);
+
+  /// Finishes all pending tasks and joins the worker threads
+  ~ThreadPool();
+
+  /// Returns the number of worker threads of this pool
+  core::index2 size() const { return workers.size(); }
+
+  /** @brief Schedules a task for execution.
+   *
+   * @param task - any callable object that takes no arguments and returns nothing
+   * @return future object that becomes ready when the task is done; any exception thrown by the task is rethrown by <code>get()</code>
+   */
+  template<typename F>
+  std::future<void> submit(F task) {
+
+    auto job = std::make_shared<std::packaged_task<void()>>(task);
+    std::future<void> result = job->get_future();
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      tasks.push([job]() { (*job)(); });
+    }
+    condition.notify_one();
+    return result;
+  }
+
+  /** @brief Calls <code>f(i)</code> for every <code>i</code> from the range <code>[first, last)</code> and waits until all the calls are done.
+   *
+   * The range is split into contiguous blocks, one per worker thread.
+   * @param first - the first index
+   * @param last - pass-the-end index
+   * @param f - function to be called
+   */
+  void parallel_for(const core::index4 first, const core::index4 last, const std::function<void(core::index4)> &f);
+
+private:
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> tasks;
+  std::mutex queue_mutex;
+  std::condition_variable condition;
+  bool stop_;
+
+  void worker_loop();
+};
+
+} // ~ utils
+
+#endif
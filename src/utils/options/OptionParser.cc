@@ -157,7 +157,6 @@ bool OptionParser::parse_cmdline(const core::index2 argc, const char *args[],boo
     } else {
       if (tokens.size() > 2)
         logger << utils::LogLevel::SEVERE << "Can't parse give value (too many '=') : " << tokens[1] << "\n";
-      logger << utils::LogLevel::SEVERE << "Can't parse give value (too many '=') : " << tokens[1] << "\n";
 
       if(value_mandatory[option_index]) {
         std::string msg = utils::string_format("Option %s must provided a value (e.g. %s=some_value)\n",tokens[0].c_str(),tokens[0].c_str());
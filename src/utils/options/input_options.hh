@@ -27,13 +27,20 @@ static Option input_txt_monomers("-in:monomers:txt", "-in::monomers::txt", "load
 static Option input_fasta("-if", "-in:fasta", "provide an input file in FASTA format");
 static Option input_pir("-in::pir", "-in:pir", "provide an input file in PIR format");
 static Option input_ss2("-in::ss2", "-in:ss2", "provide an input secondary structure in PsiPred's SS2 format");
+static Option input_ss2_list("-in::ss2::listfile", "-in:ss2:listfile", "read all SS2 files listed in the given listfile (as a single column with file names)");
 static Option input_clustalw("-iw", "-in:clustalw", "provide an input file in ClustalW format");
 static Option input_native_fasta("-ifn", "-in:fasta:native", "provide the native (or reference) sequence (or alignment) in FASTA format");
 static Option input_chk("-ib", "-in:profile:chk", "provide an input sequence profile in the binary CHK format (legacy blastpgp output)");
 static Option input_asn1("-ia", "-in:profile:asn1", "provide an input sequence profile in the ASN.1 format (blast+ output)");
 
+static Option input_restraints("-in:restraints", "-in:restraints", "provide distance restraints (e.g. predicted contacts) as lines: residue_i residue_j [d_min [d_max [weight]]]");
+
 static Option input_n_atoms("-n", "-in:n_atoms", "the number of atoms in the input structure(s)");
 
+static Option input_cache("-in:cache", "-in:cache", "keep starting structures converted to SURPASS representation in this directory and reuse them in later runs");
+
+static Option input_socket("-in:socket", "-in:socket", "listen for jobs at this Unix domain socket");
+
 /********** Load file(s) in PDB format **********/
 static Option input_pdb_path("-ippath", "-in:pdb:path", "search for pdb files in this directory");
 static Option input_pdb("-ip", "-in:pdb", "provide an input protein structure(s) in PDB format");
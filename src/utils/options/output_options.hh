@@ -12,6 +12,7 @@ namespace utils {
 namespace options {
 
 static Option output_file("-o", "-out:file", "provide an output file");
+static Option output_perf("-out:perf", "-out:perf", "measure time, cycles, instructions, LLC misses and branch misses spent in every energy term, mover and observer; tables are written to perf.dat (perf-r<replica>.dat in REMC) at the end of a run");
 static Option output_name_prefix("-out::prefix", "-out::prefix", "a string attached in front of the name of any output file produced by a program");
 
 // ------------- sequence stuff ----------
@@ -28,6 +29,9 @@ static Option output_pdb("-op", "-out:pdb", "provide an output file to write str
 static Option output_pdb_min("-out:pdb:min_en", "-out:pdb:min_en", "provide an output file to write low-energy structures in PDB format");
 static Option output_pdb_min_value("-out:pdb:min_en::value", "-out:pdb:min_en::value", "the highest energy value for a structure to be recorded with -out:pdb:min_en option");
 static Option output_pdb_min_fraction("-out:pdb:min_en::fraction", "-out:pdb:min_en::fraction", "say 0.15 to record structures worse by 15% of energy than the currently lowest ");
+static Option output_pymol("-pymol", "-out:pymol", "stream conformations to a PyMOL UDP server listening at a given address[:port] (the default port is 65000)");
+static Option output_pymol_fps("-pymol_fps", "-out:pymol:fps", "the maximum number of frames per second sent to PyMOL (10 by default)");
+static Option output_pdb_min_archive("-out:pdb:min_en::archive", "-out:pdb:min_en::archive", "with -out:pdb:min_en, keep only unique low-energy structures: a structure closer than this crmsd (e.g. 2.0) to an archived one replaces it when lower in energy; the archive is written at the end");
 static Option output_trax("-ox", "-out:trax", "provide a file name to write output trajectory in TRAX format");
 static Option output_pdb_header("-out:pdb:header", "-out:pdb:header", "write a header when writing a PDB file");
 static Option out_sse("-sse","-out:sse",  "prints a list of secondary structure elements");
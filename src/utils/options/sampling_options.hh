@@ -20,10 +20,45 @@ static Option replica_exchanges("-exchanges", "-sample:exchanges", "the number o
 static Option begin_temperature("-t_start", "-sample:t_start", "initial temperature of the simulation");
 static Option end_temperature("-t_end", "-sample:t_end", "final temperature of the simulation");
 static Option temp_steps("-t_steps", "-sample:t_steps", "the number of isothermal steps to make");
+static Option annealing_adaptive("-adaptive", "-sample:annealing:adaptive", "anneal from -sample:t_start to -sample:t_end at a given thermodynamic speed (e.g. 0.5): temperature steps and dwell times follow the measured heat capacity; the realized schedule is written to annealing_schedule.dat");
+static Option annealing_schedule("-schedule", "-sample:annealing:schedule", "anneal along a schedule file written by an adaptive run: temperature and the number of outer cycles in the first two columns");
 
 static Option replicas("-replicas", "-sample:replicas", "temperatures for replicas in REMC simulation (the number of temperature values defines the number of replicas)");
+static Option replica_lockstep("-lockstep", "-sample:replicas:lockstep", "advance all replicas in lock-step on a single thread, evaluating their contact energy in one vectorized pass; replicas are not exchanged");
 static Option replica_observation_mode("-observation_mode", "-sample:replicas:observation_mode",
-  "observation mode: ISOTHERMAL - same temperature (default); ISOTEMPORAL - contiguous time trajectory");
+  "observation mode: ISOTHERMAL - same temperature (default); ISOTEMPORAL - contiguous time trajectory; DEMUX - contiguous trajectory of every replica tagged with temperature index, split into isothermal files by surpass_demux");
+
+static Option umbrella_cv("-umbrella", "-sample:umbrella:cv", "run umbrella sampling along a collective variable: rg (radius of gyration), crmsd (to the native or the starting structure) or q (fraction of native contacts)");
+static Option umbrella_centers("-umbrella_centers", "-sample:umbrella:centers", "centers of umbrella windows (the number of values defines the number of windows)");
+static Option umbrella_k("-umbrella_k", "-sample:umbrella:k", "force constant of umbrella potentials");
+static Option umbrella_flat("-umbrella_flat", "-sample:umbrella:flat", "half-width of a flat bottom of umbrella potentials; harmonic potentials are used by default");
+static Option umbrella_no_exchange("-umbrella_noex", "-sample:umbrella:no_exchange", "do not exchange replicas between neighboring umbrella windows");
+static Option umbrella_bins("-umbrella_bins", "-sample:umbrella:bins", "the number of histogram bins used by WHAM");
+
+static Option metad_cv("-metad", "-sample:metad:cv", "run well-tempered metadynamics along one or two collective variables: rg, hb (the number of hydrogen bonds), q (fraction of native contacts) or a pair of them, e.g. rg,hb");
+static Option metad_grid("-metad_grid", "-sample:metad:grid", "bias grid: min,max,n_points given for every collective variable");
+static Option metad_sigma("-metad_sigma", "-sample:metad:sigma", "width of Gaussian hills for every collective variable");
+static Option metad_height("-metad_height", "-sample:metad:height", "initial height of Gaussian hills");
+static Option metad_bias_factor("-metad_gamma", "-sample:metad:bias_factor", "well-tempered bias factor; 1.0 means standard metadynamics");
+static Option metad_stride("-metad_stride", "-sample:metad:stride", "deposit a hill every N inner MC cycles");
+static Option metad_restart("-metad_restart", "-sample:metad:restart", "continue metadynamics from a bias state file");
+
+static Option portfolio_runs("-portfolio", "-sample:portfolio:runs", "run a portfolio of N simulated annealing runs pruned by successive halving");
+static Option portfolio_keep("-portfolio_keep", "-sample:portfolio:keep", "fraction of runs that survive each checkpoint of a portfolio");
+static Option portfolio_stages("-portfolio_stages", "-sample:portfolio:stages", "the number of stages the annealing schedule is split into");
+static Option portfolio_score("-portfolio_score", "-sample:portfolio:score", "score used to rank portfolio runs: energy (the default) or crmsd (to the native or the starting structure)");
+static Option portfolio_clone("-portfolio_clone", "-sample:portfolio:clone", "replace pruned runs with copies of the best ones rather than stopping them");
+
+static Option adaptive_movers("-adaptive_movers", "-sample:movers:adaptive", "adapt the number of moves of every mover to its measured efficiency (displacement per CPU-second) during the first N outer cycles, then freeze the mix");
+static Option reservoir_in("-reservoir", "-sample:reservoir", "reservoir REMC: the highest temperature replica also exchanges with conformations from a reservoir file");
+static Option reservoir_out("-reservoir_out", "-sample:reservoir:save", "record conformations of the highest temperature replica after every exchange into a reservoir file");
+static Option nested_live("-nested", "-sample:nested:live", "run nested sampling with N live points; samples, the density of states and thermodynamics between -sample:t_start and -sample:t_end are written to nested_samples.dat and nested_thermo.dat");
+static Option nested_dead("-nested_dead", "-sample:nested:dead", "the number of dead points of nested sampling");
+static Option nested_walk("-nested_walk", "-sample:nested:walk", "the number of MC sweeps a walker makes to replace a dead point of nested sampling");
+static Option nested_prior_t("-nested_t0", "-sample:nested:prior_temperature", "temperature of the canonical prior distribution of nested sampling");
+static Option perm_tours("-perm", "-sample:perm:tours", "grow starting models with the chain-growth (PERM) sampler in N tours rather than reading them from -in:pdb; the models are also written to perm_models.pdb");
+static Option perm_temperature("-perm_t", "-sample:perm:temperature", "temperature of Boltzmann factors used by the chain-growth sampler (1.0 by default)");
+static Option surrogate_terms("-surrogate", "-sample:surrogate", "delayed-acceptance MC: names of energy terms (e.g. SurpassLocalRepulsionEnergy,SurpassR12) that screen every move before the remaining terms are evaluated");
 
 static Option n_atoms("-n_atoms", "-sample:n_atoms", "the number of atoms in the sampled system");
 
@@ -17,6 +17,9 @@ static Option cabs_bb_go("-cabs_bb_go", "-scfx:cabs_bb_go", "use default CABS-bb
 static Option cabs_bb("-cabs_bb", "-scfx:cabs_bb", "use default CABS-bb (CABS with explicit backbone) energy for scoring");
 static Option cabs("-cabs", "-scfx:cabs_bb", "use default CABS energy for scoring");
 static Option surpass("-surpass", "-scfx:surpass", "use default SURPASS energy for scoring");
+static Option restraints_weight("-scfx:restraints:weight", "-scfx:restraints:weight", "weight of the distance restraints energy term", "1.0");
+static Option restraints_shape("-scfx:restraints:shape", "-scfx:restraints:shape", "functional form of distance restraints: flat (flat-bottom harmonic) or lorentz", "flat");
+static Option restraints_constant("-scfx:restraints:k", "-scfx:restraints:k", "force constant of flat-bottom restraints or width of Lorentzian restraints", "1.0");
 ///@}
 
 }